@@ -0,0 +1,57 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstdint>
+
+// Global operator new is replaced to count heap allocations per thread, so the count costs one thread-local increment.
+// Building with ALLOCATION_TRACKING (make ALLOCATION_TRACKING=1) also attributes every allocation to the subsystem
+// whose scope is active on the allocating thread and follows its bytes until they are freed; without it a scope is an
+// empty object and compiles away.
+namespace memory
+{
+	enum class Subsystem : std::uint8_t
+	{
+		OTHER, TICK, SHIPS, ASTEROIDS, BULLETS, SPAWNS, COLLISION, HUD, RENDER, COUNT
+	};
+
+	// Allocations made by the calling thread since it started.
+	std::uint64_t ThreadAllocations();
+
+#if defined(ALLOCATION_TRACKING)
+	inline constexpr bool tracking = true;
+
+	// Tags the calling thread's allocations with a subsystem until it goes out of scope. Scopes nest, and memory is
+	// charged to the scope that allocated it wherever it is freed.
+	class Scope
+	{
+	private:
+		Subsystem previous_;
+
+	public:
+		explicit Scope(Subsystem subsystem);
+
+		~Scope();
+
+		Scope(const Scope&) = delete;
+
+		Scope& operator=(const Scope&) = delete;
+	};
+#else
+	inline constexpr bool tracking = false;
+
+	class Scope
+	{
+	public:
+		explicit Scope(Subsystem) {}
+	};
+#endif
+
+	// Prints each subsystem's allocations and bytes per unit since the previous report, spread over units, with its
+	// live bytes and the peak they reached in between. Does nothing unless tracking is built in.
+	void ReportSubsystems(double units, const char* unit);
+
+	// Starts the next report's interval now without printing.
+	void ResetSubsystemReport();
+} // namespace memory
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef ASSET_BUNDLE_HPP
+#define ASSET_BUNDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+enum class AssetType : std::uint32_t
+{
+	PCM_S16 = 1, FONT = 2
+};
+
+// Packed, pre-decoded assets, memory-mapped read-only and handed out without copying.
+class AssetBundle
+{
+private:
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t entry_count;
+	};
+
+	struct Entry
+	{
+		char name[48];
+		AssetType type;
+		std::uint32_t sample_rate;
+		std::uint64_t offset;
+		std::uint64_t size;
+	};
+
+	void* mapping_;
+	std::size_t mapping_size_;
+	const Entry* entries_;
+	std::uint32_t entry_count_;
+
+public:
+	AssetBundle();
+
+	~AssetBundle();
+
+	static bool Build(const char* path);
+
+	bool Open(const char* path);
+
+	void Close();
+
+	const void* Find(const char* name, AssetType type, std::size_t* size) const;
+
+	bool IsOpen() const;
+};
+
+#endif
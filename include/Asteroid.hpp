@@ -3,6 +3,8 @@
 
 #include "LinePolygon.hpp"
 
+#include <cstdint>
+
 enum class AsteroidType
 {
 	LARGE, MEDIUM, SMALL
@@ -12,6 +14,8 @@ class Asteroid : public LinePolygon
 {
 public:	
 	AsteroidType type_;
+	bool broadphase_tracked_;
+	std::uint32_t id_;
 	
 	Asteroid(Game* game, enum AsteroidType type, double x, double y, double vx, double vy);
 	
@@ -0,0 +1,104 @@
+#ifndef AUDIO_MIXER_HPP
+#define AUDIO_MIXER_HPP
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Software mixer running in the SDL audio callback. The game thread only talks to it through a lock-free queue.
+class AudioMixer
+{
+private:
+	static constexpr int voice_count = 16;
+	static constexpr std::size_t queue_capacity = 64;
+
+	// Samples point either into storage or into memory owned by someone else, such as a mapped asset bundle.
+	struct Clip
+	{
+		const std::int16_t* samples;
+		std::size_t sample_count;
+		std::vector<std::int16_t> storage;
+		int priority;
+	};
+
+	struct Voice
+	{
+		const Clip* clip;
+		std::size_t position;
+		float gain;
+		int priority;
+	};
+
+	struct Command
+	{
+		int clip;
+		float gain;
+	};
+
+	SDL_AudioDeviceID device_;
+	SDL_AudioSpec spec_;
+	std::vector<Clip> clips_;
+
+	// Single producer (the game thread), single consumer (the audio callback).
+	std::array<Command, queue_capacity> commands_;
+	std::atomic<std::size_t> head_;
+	std::atomic<std::size_t> tail_;
+
+	// Triggers collected during the current tick, one counter per clip.
+	std::vector<int> pending_;
+
+	// Owned by the audio callback.
+	std::array<Voice, voice_count> voices_;
+	std::vector<std::int32_t> accumulator_;
+	std::uint64_t last_callback_counter_;
+
+	static void Callback(void* userdata, Uint8* stream, int length);
+
+	void Mix(std::int16_t* out, int frames);
+
+	void StartVoice(const Command& command);
+
+public:
+	static constexpr int frequency = 44100;
+	static constexpr int channels = 2;
+
+	std::atomic<std::uint64_t> callbacks_;
+	std::atomic<std::uint64_t> late_callbacks_;
+	std::atomic<std::uint64_t> callback_ns_total_;
+	std::atomic<std::uint64_t> callback_ns_max_;
+	std::atomic<std::uint64_t> voices_stolen_;
+	std::atomic<std::uint64_t> triggers_dropped_;
+	std::size_t triggers_coalesced_;
+	std::size_t queue_full_;
+
+	AudioMixer();
+
+	~AudioMixer();
+
+	// Opens the device paused; clips are loaded next and Start begins mixing.
+	bool Open(int buffer_frames);
+
+	void Start();
+
+	void Close();
+
+	static bool Decode(const char* path, std::vector<std::int16_t>* samples);
+
+	int Load(const char* path, int priority);
+
+	int LoadPcm(const std::int16_t* samples, std::size_t sample_count, int priority);
+
+	void Play(int clip);
+
+	void Flush();
+
+	void PrintStats() const;
+
+	bool IsOpen() const;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef BATCH_ENVIRONMENT_HPP
+#define BATCH_ENVIRONMENT_HPP
+
+#include "Options.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Game;
+class Asteroid;
+
+// Observation layout. Every array holds one row per instance, instance-major, in one contiguous buffer.
+namespace batch
+{
+	inline constexpr std::size_t observed_asteroids = 16;
+
+	// x, y, vx, vy, angle in degrees, alive (1 or 0).
+	inline constexpr std::size_t ship_features = 6;
+
+	// Offset from the ship across the world seam, velocity and radius; nearest first, zero rows past the count.
+	inline constexpr std::size_t asteroid_features = 5;
+} // namespace batch
+
+// Steps many headless games in lockstep, one input::Button mask per game per step. Instances are split into
+// contiguous shards, one per thread; the calling thread runs the first shard itself.
+class BatchEnvironment
+{
+private:
+	struct Shard
+	{
+		std::size_t begin;
+		std::size_t end;
+		std::vector<std::pair<float, const Asteroid*>> nearest;
+	};
+
+	std::vector<std::unique_ptr<Game>> games_;
+	std::vector<Shard> shards_;
+	std::vector<std::thread> workers_;
+	std::uint64_t seed_;
+
+	std::mutex mutex_;
+	std::condition_variable start_;
+	std::condition_variable finished_;
+	std::uint64_t generation_;
+	std::size_t pending_;
+	bool stopping_;
+	const std::uint8_t* actions_;
+
+	std::vector<float> ships_;
+	std::vector<float> asteroids_;
+	std::vector<float> rewards_;
+	std::vector<std::int32_t> asteroid_counts_;
+	std::vector<std::int32_t> scores_;
+	std::vector<std::int32_t> lives_;
+	std::vector<std::uint8_t> done_;
+
+	void WorkerLoop(std::size_t shard);
+
+	void StepShard(Shard* shard);
+
+	void Observe(std::size_t instance, Shard* shard);
+
+public:
+	std::uint64_t steps_;
+
+	BatchEnvironment(const Options& options, std::size_t instances, std::size_t threads);
+
+	~BatchEnvironment();
+
+	BatchEnvironment(const BatchEnvironment&) = delete;
+
+	BatchEnvironment& operator=(const BatchEnvironment&) = delete;
+
+	// Starts every instance over from its seed.
+	void Reset();
+
+	// Applies actions[i] to instance i and ticks every instance once. Instances that were done after the previous
+	// step start a new episode first.
+	void Step(const std::uint8_t* actions);
+
+	std::size_t Size() const;
+
+	std::size_t Threads() const;
+
+	const float* Ships() const;
+
+	const float* Asteroids() const;
+
+	const std::int32_t* AsteroidCounts() const;
+
+	// Score gained during the last step.
+	const float* Rewards() const;
+
+	const std::int32_t* Scores() const;
+
+	const std::int32_t* Lives() const;
+
+	const std::uint8_t* Done() const;
+};
+
+#endif
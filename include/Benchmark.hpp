@@ -0,0 +1,27 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include "Options.hpp"
+
+namespace benchmark
+{
+	int Run(const Options& options);
+
+	int RunBroadphase(const Options& options);
+
+	int RunParticles(const Options& options);
+
+	int RunSnapshot(const Options& options);
+
+	int RunRollback(const Options& options);
+
+	int RunBatch(const Options& options);
+
+	int RunTickRate(const Options& options);
+
+	int RunReplay(const Options& options);
+
+	int RunRender(const Options& options);
+} // namespace benchmark
+
+#endif
@@ -12,6 +12,7 @@ private:
 
 public:
 	bool removed_;
+	// Ticks left, bullet_lifetime seconds at the game's tick rate when fired.
 	int lifetime_;
 
 	SDL_FRect geometry_;
@@ -21,7 +22,7 @@ public:
 
 	void Tick();
 
-	void Render();
+	void Render(float offset_x = 0.0f, float offset_y = 0.0f) const;
 
 	void HandleCollision();
 };
@@ -0,0 +1,70 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Framebuffer;
+
+class FrameCapture
+{
+private:
+	enum class Format
+	{
+		Y4M, PPM
+	};
+
+	std::FILE* file_;
+	Format format_;
+	int width_;
+	int height_;
+
+	// Single producer (the game thread), single consumer (the encoder); slots are allocated once in Start.
+	std::vector<std::vector<std::uint32_t>> slots_;
+	std::atomic<std::size_t> head_;
+	std::atomic<std::size_t> tail_;
+
+	std::thread encoder_;
+	std::atomic<bool> stopping_;
+	std::mutex wake_mutex_;
+	std::condition_variable wake_;
+
+	std::vector<std::uint8_t> encode_buffer_;
+	std::uint64_t start_counter_;
+	std::uint64_t stop_counter_;
+	std::uint64_t encode_counter_;
+
+	void EncoderLoop();
+
+	void EncodeFrame(const std::vector<std::uint32_t>& pixels);
+
+public:
+	std::size_t submitted_;
+	std::size_t dropped_;
+	std::atomic<std::size_t> encoded_;
+
+	FrameCapture();
+
+	~FrameCapture();
+
+	bool Start(const std::string& path, int width, int height, int frames_per_second, std::size_t queue_depth);
+
+	bool Submit(const Framebuffer& frame);
+
+	void Stop();
+
+	bool Active() const;
+
+	double FramesPerSecond() const;
+
+	double EncodeFramesPerSecond() const;
+};
+
+#endif
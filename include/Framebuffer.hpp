@@ -0,0 +1,37 @@
+#ifndef FRAMEBUFFER_HPP
+#define FRAMEBUFFER_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Framebuffer
+{
+private:
+	int width_;
+	int height_;
+	std::vector<std::uint32_t> pixels_;
+
+public:
+	Framebuffer(int width, int height);
+
+	void Clear(std::uint32_t color);
+
+	void DrawLine(float x0, float y0, float x1, float y1, std::uint32_t color);
+
+	void FillRect(const SDL_FRect& rect, std::uint32_t color);
+
+	void DrawPoints(const SDL_FPoint* points, std::size_t count, std::uint32_t color);
+
+	void BlendSurface(const SDL_Surface* surface, int x, int y);
+
+	int Width() const;
+
+	int Height() const;
+
+	const std::uint32_t* Pixels() const;
+};
+
+#endif
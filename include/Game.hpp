@@ -5,14 +5,41 @@
 #include "Texture.hpp"
 #include "Player.hpp"
 #include "Asteroid.hpp"
+#include "SweepAndPrune.hpp"
+#include "SpawnScheduler.hpp"
+#include "PerformanceGovernor.hpp"
+#include "SpriteCache.hpp"
+#include "Options.hpp"
+#include "SoftwareRenderer.hpp"
+#include "FrameCapture.hpp"
+#include "SpatialGrid.hpp"
+#include "ParticleSystem.hpp"
+#include "AudioMixer.hpp"
+#include "AssetBundle.hpp"
+#include "StateHash.hpp"
+#include "SpectatorChannel.hpp"
+#include "PerfOverlay.hpp"
+#include "HudLayer.hpp"
+#include "Scenario.hpp"
+#include "Replay.hpp"
+#include "Utils/Constants.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
-#include <SDL2/SDL_mixer.h>
 
 #include <memory>
 #include <random>
 #include <list>
+#include <vector>
+
+// One step of Game::Initialize, in milliseconds since the game was constructed.
+struct StartupPhase
+{
+	const char* name;
+	const char* thread;
+	double start_ms;
+	double end_ms;
+};
 
 class Game
 {
@@ -22,59 +49,203 @@ public:
 	int score_;
 	int number_of_asteroids_;
 	bool info_toggled_;
+	bool perf_overlay_toggled_;
 	bool game_over_;
 	bool reset_game_;
+	bool asteroid_collisions_;
+	bool headless_;
+	RenderPath render_path_;
+	std::uint64_t ticks_;
+	// Simulation steps per second; everything that moves is scaled by tick_seconds_.
+	int tick_rate_;
+	double tick_seconds_;
+	bool local_player_;
+	bool resimulating_;
+	std::uint32_t next_entity_id_;
+	double world_width_;
+	double world_height_;
 
 	std::mt19937_64 mt_;
-	std::uniform_int_distribution<double> random_x_;
-  	std::uniform_int_distribution<double> random_y_;
+	std::uniform_real_distribution<double> random_x_;
+  	std::uniform_real_distribution<double> random_y_;
 
 private:
+	Options options_;
+
 	std::unique_ptr<Texture> score_info_;
 	std::unique_ptr<Texture> lives_info_;
 	std::unique_ptr<Texture> toggle_info_;
 	std::unique_ptr<Texture> info_;
 	std::unique_ptr<Texture> game_over_info_;
+	std::unique_ptr<PerfOverlay> perf_overlay_;
+	std::unique_ptr<HudLayer> hud_;
 
 	std::unique_ptr<Player> player_;
+	std::vector<std::unique_ptr<Player>> remote_players_;
 	std::list<std::unique_ptr<Asteroid>> asteroids_;
 	std::list<std::unique_ptr<Bullet>> bullets_;
+	SweepAndPrune broadphase_;
+	SpawnScheduler spawn_scheduler_;
+	PerformanceGovernor governor_;
+	int splits_this_tick_;
+	bool score_text_dirty_;
+	std::uint64_t score_text_tick_;
+	std::unique_ptr<SpriteCache> sprite_cache_;
+	std::unique_ptr<SoftwareRenderer> software_renderer_;
+	std::unique_ptr<FrameCapture> frame_capture_;
+	std::unique_ptr<StateHash> state_hash_;
+	std::unique_ptr<spectator::Publisher> spectator_;
+	std::unique_ptr<ParticleSystem> particles_;
+	std::unique_ptr<ScenarioDriver> scenario_;
+	std::unique_ptr<ReplayWriter> replay_writer_;
+	std::unique_ptr<ReplayReader> replay_reader_;
+
+	SDL_FPoint camera_;
+	SpatialGrid<Asteroid> asteroid_grid_;
+	SpatialGrid<Bullet> bullet_grid_;
 
 	TTF_Font* font_;
-	Mix_Chunk* shoot_sfx_;
-	Mix_Chunk* asteroid_explosion_sfx_;
+	TTF_Font* overlay_font_;
+	std::unique_ptr<AssetBundle> bundle_;
+	std::unique_ptr<AudioMixer> audio_;
+	int shoot_sfx_;
+	int asteroid_explosion_sfx_;
 
 	SDL_Window* window_;
 	SDL_Renderer* renderer_;
 
+	std::uint64_t startup_counter_;
+	std::vector<StartupPhase> startup_phases_;
+
+	// Filled in by Render for the performance overlay.
+	int draw_calls_;
+	double present_ms_;
+
+	StartupPhase TimePhase(const char* name, const char* thread, std::uint64_t start) const;
+
+	bool CreateWindowAndRenderer(std::vector<StartupPhase>* phases);
+
+	bool InitAudio(std::vector<StartupPhase>* phases);
+
+	bool LoadFont(std::vector<StartupPhase>* phases);
+
+	void ConfigureWorld(double world_width, double world_height);
+
+	void QueueWave(int amount);
+
+	// Draws the score, lives and help text; returns the draw calls it issued.
+	int ComposeHud();
+
 public:
-	Game();
+	// Batch instances that are never drawn pass a particle capacity of zero.
+	explicit Game(std::size_t particle_capacity = constants::particle_capacity);
 	
 	~Game();
 
+	void ApplyOptions(const Options& options);
+
+	void Seed(std::uint64_t seed);
+
+	void SetTickRate(int tick_rate);
+
+	// Replaces the world, seed and run length with a scenario's, which then drives spawning every tick.
+	bool LoadScenario(const std::string& name_or_path);
+
+	void SetWorldSize(double world_width, double world_height);
+
+	void SaveSnapshot(std::vector<std::uint8_t>* buffer) const;
+
+	bool RestoreSnapshot(const std::uint8_t* data, std::size_t size);
+
 	bool Initialize();
 	
 	void Finalize();
 
 	bool InitResources();
 
+	int LoadSound(const char* path, int priority);
+
 	void UpdateScoreText();
 
 	void UpdateLivesText();
 	
 	void Run();
 
+	void RunHeadless();
+
+	bool StartCapture();
+
+	void CaptureFrame();
+
+	bool StartStateHash();
+
+	bool StartBroadcast();
+
+	bool StartGovernor();
+
+	// Opens the replay being recorded or played back, if any; playback starts at the requested offset.
+	bool StartReplay();
+
+	// Moves playback by a number of seconds, forward or back.
+	void SeekReplay(double seconds);
+
 	void Reset();
 
 	void HandleEvents();
 
+	// Drives the local ship with an input::Button mask instead of keyboard events.
+	void ApplyInput(std::uint8_t buttons);
+
 	void Tick();
 
+	// One tick of the game, or of the replay being played back.
+	void Step();
+
+	void HandleAsteroidCollisions();
+
 	void Render();
 
+	// Returns the draw calls it issued.
+	int RenderPolygon(const LinePolygon& polygon, float offset_x, float offset_y);
+
+	void UpdateCamera();
+
+	bool CameraEnabled() const;
+
+	const SDL_FPoint& Camera() const;
+
+	template <typename Visitor>
+	void ForEachVisibleAsteroid(Visitor visit) const;
+
+	template <typename Visitor>
+	void ForEachVisibleBullet(Visitor visit) const;
+
 	SDL_Renderer* Renderer() const;
 
-	const std::list<std::unique_ptr<Asteroid>>& Asteroids();
+	// Draw calls issued and time spent in SDL_RenderPresent by the last Render.
+	int DrawCalls() const;
+
+	double PresentMs() const;
+
+	const std::list<std::unique_ptr<Asteroid>>& Asteroids() const;
+
+	const std::list<std::unique_ptr<Bullet>>& Bullets() const;
+
+	const Player& GetPlayer() const;
+
+	const std::vector<std::unique_ptr<Player>>& RemotePlayers() const;
+
+	Player* AddRemotePlayer();
+
+	void RemoveRemotePlayer(const Player* player);
+
+	const SweepAndPrune& Broadphase() const;
+
+	const SpawnScheduler& Spawner() const;
+
+	const std::vector<StartupPhase>& StartupPhases() const;
+
+	ParticleSystem* Particles() const;
 
 	void PlayShootSound() const;
 	
@@ -82,9 +253,60 @@ public:
 	
 	void AddBullet(double x, double y, double vx, double vy);
 
+	void AddExplosion(const Asteroid& asteroid);
+
+	void AddThrust(const SDL_FPoint& position, const SDL_FPoint& direction);
+
+	// Builds the wave at once; the wave Tick starts itself is spread over ticks by the spawn scheduler.
 	void SpawnAsteroids(int amount);
+
+	void QueueAsteroid(AsteroidType type, double x, double y, double vx, double vy);
+
+	// False once the governor's split cap for this tick is used up; the asteroid is then destroyed without fragments.
+	bool AllowSplit();
 	
 	void AddAsteroid(std::unique_ptr<Asteroid> asteroid);
+
+	void ClearAsteroids();
 };
 
+// Visits what the camera sees with the offset that maps world to screen coordinates, or everything when the world fits the screen.
+template <typename Visitor>
+void Game::ForEachVisibleAsteroid(Visitor visit) const
+{
+	if (!CameraEnabled())
+	{
+		for (const std::unique_ptr<Asteroid>& asteroid : asteroids_)
+		{
+			visit(*asteroid, 0.0f, 0.0f);
+		}
+
+		return;
+	}
+
+	asteroid_grid_.Query(camera_.x - constants::cull_margin, camera_.y - constants::cull_margin, constants::screen_width + 2.0 * constants::cull_margin, constants::screen_height + 2.0 * constants::cull_margin, [this, &visit](const Asteroid& asteroid, float shift_x, float shift_y)
+	{
+		visit(asteroid, shift_x - camera_.x, shift_y - camera_.y);
+	});
+}
+
+template <typename Visitor>
+void Game::ForEachVisibleBullet(Visitor visit) const
+{
+	if (!CameraEnabled())
+	{
+		for (const std::unique_ptr<Bullet>& bullet : bullets_)
+		{
+			visit(*bullet, 0.0f, 0.0f);
+		}
+
+		return;
+	}
+
+	bullet_grid_.Query(camera_.x, camera_.y, constants::screen_width, constants::screen_height, [this, &visit](const Bullet& bullet, float shift_x, float shift_y)
+	{
+		visit(bullet, shift_x - camera_.x, shift_y - camera_.y);
+	});
+}
+
 #endif
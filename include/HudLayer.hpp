@@ -0,0 +1,75 @@
+#ifndef HUD_LAYER_HPP
+#define HUD_LAYER_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// The HUD composed into one screen-sized texture and drawn with a single copy. It is only composed again after
+// Invalidate or when the state passed to Render changes, which is a few times a game rather than every frame.
+class HudLayer
+{
+private:
+	SDL_Texture* target_;
+	bool dirty_;
+	std::uint32_t state_;
+
+public:
+	std::size_t compositions_;
+	std::size_t frames_;
+
+	HudLayer();
+
+	~HudLayer();
+
+	// Without target texture support the HUD is composed straight onto the screen every frame instead.
+	bool Create(SDL_Renderer* renderer, int width, int height);
+
+	void Free();
+
+	// Called after a texture on the layer changed, or when the renderer lost its targets.
+	void Invalidate();
+
+	// compose draws the HUD and returns its draw calls; Render returns the draw calls it issued this frame.
+	template <typename Compose>
+	int Render(SDL_Renderer* renderer, std::uint32_t state, Compose compose);
+
+	void PrintStats() const;
+};
+
+template <typename Compose>
+int HudLayer::Render(SDL_Renderer* renderer, std::uint32_t state, Compose compose)
+{
+	++frames_;
+
+	if (target_ == nullptr)
+	{
+		++compositions_;
+		return compose();
+	}
+
+	int draw_calls = 1;
+
+	if (dirty_ || state != state_)
+	{
+		SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+		SDL_SetRenderTarget(renderer, target_);
+		SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
+		SDL_RenderClear(renderer);
+
+		draw_calls += compose() + 1;
+
+		SDL_SetRenderTarget(renderer, previous_target);
+
+		dirty_ = false;
+		state_ = state;
+		++compositions_;
+	}
+
+	SDL_RenderCopy(renderer, target_, nullptr, nullptr);
+
+	return draw_calls;
+}
+
+#endif
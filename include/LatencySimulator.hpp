@@ -0,0 +1,56 @@
+#ifndef LATENCY_SIMULATOR_HPP
+#define LATENCY_SIMULATOR_HPP
+
+#include "NetProtocol.hpp"
+#include "UdpSocket.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace net
+{
+	struct LinkConditions
+	{
+		double latency_ms = 0.0;
+		double jitter_ms = 0.0;
+		double loss = 0.0;
+	};
+
+	// Holds outgoing datagrams back by latency plus or minus jitter and drops a fraction of them, so bad links can be
+	// reproduced on loopback. Time is whatever clock the caller passes in, in seconds.
+	class LatencySimulator
+	{
+	private:
+		struct Packet
+		{
+			double release;
+			sockaddr_in address;
+			std::size_t size;
+			std::array<std::uint8_t, max_packet_size> data;
+		};
+
+		UdpSocket* socket_;
+		LinkConditions conditions_;
+		std::mt19937 mt_;
+		std::vector<Packet> queue_;
+		std::size_t queued_;
+
+	public:
+		std::size_t sent_;
+		std::size_t lost_;
+
+		explicit LatencySimulator(UdpSocket* socket);
+
+		void Configure(const LinkConditions& conditions, std::uint32_t seed);
+
+		void Send(const sockaddr_in& address, const std::uint8_t* data, std::size_t size, double now);
+
+		// Sends everything whose delay has passed.
+		void Flush(double now);
+	};
+} // namespace net
+
+#endif
@@ -16,6 +16,8 @@ protected:
 public:
 	double furthest_distance_squared_;
 	bool removed_;
+	int mesh_id_;
+	double angle_;
 
 	SDL_FPoint center_;
 	SDL_FPoint acceleration_vector_;
@@ -31,17 +33,19 @@ public:
 
 	virtual void MoveGeometry(double ax, double ay) = 0; 
 
-	void Render();
+	void Render(float offset_x = 0.0f, float offset_y = 0.0f) const;
 
-	const std::vector<SDL_FPoint>& Geometry();
+	const std::vector<SDL_FPoint>& Geometry() const;
 
 	void AddPoint(double x, double y);
 
+	void SetGeometry(const SDL_FPoint* points, std::size_t count);
+
 	void TranslateGeometry(double x, double y);
 
-	void RotateGeometry(int degrees);
+	void RotateGeometry(double degrees);
 	
-	SDL_FPoint RotatePoint(const SDL_FPoint& point, const SDL_FPoint& pivot, int degrees);
+	SDL_FPoint RotatePoint(const SDL_FPoint& point, const SDL_FPoint& pivot, double degrees);
 	
 	void Scale(double scale_factor);
 
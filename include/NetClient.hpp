@@ -0,0 +1,88 @@
+#ifndef NET_CLIENT_HPP
+#define NET_CLIENT_HPP
+
+#include "NetProtocol.hpp"
+#include "UdpSocket.hpp"
+#include "Options.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace net
+{
+	struct ClientStats
+	{
+		std::size_t bytes_received = 0;
+		std::size_t bytes_sent = 0;
+		std::size_t snapshots = 0;
+		std::size_t full_snapshots = 0;
+		std::size_t stale_snapshots = 0;
+		std::size_t decode_errors = 0;
+		double decode_us_total = 0.0;
+	};
+
+	class Client
+	{
+	private:
+		struct History
+		{
+			std::uint32_t tick = 0;
+			std::vector<EntityState> entities;
+		};
+
+		UdpSocket socket_;
+		sockaddr_in server_;
+		bool connected_;
+		std::uint8_t slot_;
+		std::uint32_t sequence_;
+		std::uint32_t latest_tick_;
+
+		// Decoded snapshots by tick, so the server may pick any recently acknowledged one as the baseline.
+		std::array<History, history_size> history_;
+		std::vector<EntityState> decoded_;
+		std::vector<BulletPosition> bullets_;
+
+		void Send(const ByteWriter& writer, const std::uint8_t* data);
+
+		void HandleSnapshot(ByteReader* reader);
+
+	public:
+		double world_width_;
+		double world_height_;
+		int score_;
+		int lives_;
+		ClientStats stats_;
+
+		Client();
+
+		bool Open(const char* host, std::uint16_t port);
+
+		void SendHello();
+
+		void SendInput(std::uint8_t buttons);
+
+		void SendBye();
+
+		// Reads every waiting packet.
+		void Receive();
+
+		bool Connected() const;
+
+		std::uint32_t ShipId() const;
+
+		std::uint32_t LatestTick() const;
+
+		const std::vector<EntityState>& Entities() const;
+
+		const std::vector<BulletPosition>& Bullets() const;
+	};
+
+	int RunClient(const Options& options);
+
+	// Connects options.load_test_clients bots that press random buttons, and reports what they receive.
+	int RunLoadTest(const Options& options);
+} // namespace net
+
+#endif
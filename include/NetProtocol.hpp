@@ -0,0 +1,118 @@
+#ifndef NET_PROTOCOL_HPP
+#define NET_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Wire format shared by the server and clients. Multi-byte values are little-endian; positions are quantized to
+// 16 bits of the world, so differences wrap around the world seam for free.
+namespace net
+{
+	inline constexpr std::uint16_t default_port = 27015;
+	inline constexpr std::size_t max_packet_size = 1200;
+	inline constexpr std::size_t max_clients = 32;
+	inline constexpr std::size_t history_size = 32;
+	inline constexpr std::size_t max_snapshot_entities = 160;
+	inline constexpr std::size_t max_snapshot_bullets = 64;
+	inline constexpr std::uint32_t ship_id_base = 0x80000000u;
+	inline constexpr double interest_radius = 1100.0;
+	inline constexpr double client_timeout_seconds = 5.0;
+
+	enum class PacketType : std::uint8_t
+	{
+		HELLO = 1, WELCOME, INPUT, SNAPSHOT, BYE, ROLLBACK_INPUT
+	};
+
+	// Asteroid kinds use the AsteroidType values.
+	inline constexpr std::uint8_t ship_kind = 3;
+
+	struct EntityState
+	{
+		std::uint32_t id;
+		std::uint16_t x;
+		std::uint16_t y;
+		std::int16_t vx;
+		std::int16_t vy;
+		std::uint8_t angle;
+		std::uint8_t kind;
+	};
+
+	struct BulletPosition
+	{
+		std::uint16_t x;
+		std::uint16_t y;
+	};
+
+	class ByteWriter
+	{
+	private:
+		std::uint8_t* data_;
+		std::size_t capacity_;
+		std::size_t size_;
+		bool overflow_;
+
+	public:
+		ByteWriter(std::uint8_t* data, std::size_t capacity);
+
+		void U8(std::uint8_t value);
+
+		void U16(std::uint16_t value);
+
+		void U32(std::uint32_t value);
+
+		void VarUint(std::uint32_t value);
+
+		void VarInt(std::int32_t value);
+
+		void PatchU16(std::size_t offset, std::uint16_t value);
+
+		std::size_t Size() const;
+
+		bool Overflow() const;
+	};
+
+	class ByteReader
+	{
+	private:
+		const std::uint8_t* data_;
+		std::size_t size_;
+		std::size_t position_;
+		bool error_;
+
+	public:
+		ByteReader(const std::uint8_t* data, std::size_t size);
+
+		std::uint8_t U8();
+
+		std::uint16_t U16();
+
+		std::uint32_t U32();
+
+		std::uint32_t VarUint();
+
+		std::int32_t VarInt();
+
+		bool Error() const;
+	};
+
+	std::uint16_t QuantizePosition(double value, double extent);
+
+	double DequantizePosition(std::uint16_t value, double extent);
+
+	// Pixels per second in steps of 1/8, enough for a bullet either way.
+	std::int16_t QuantizeVelocity(double value);
+
+	double DequantizeVelocity(std::int16_t value);
+
+	std::uint8_t QuantizeAngle(double degrees);
+
+	double DequantizeAngle(std::uint8_t value);
+
+	// Both lists are sorted by id. Only entities that appeared, disappeared or changed are written.
+	void EncodeDelta(const std::vector<EntityState>& baseline, const std::vector<EntityState>& current, ByteWriter* writer);
+
+	bool DecodeDelta(const std::vector<EntityState>& baseline, ByteReader* reader, std::vector<EntityState>* current);
+} // namespace net
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef NET_SERVER_HPP
+#define NET_SERVER_HPP
+
+#include "NetProtocol.hpp"
+#include "UdpSocket.hpp"
+#include "Options.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Game;
+class Player;
+
+namespace net
+{
+	// Totals since the last report; the server prints and clears them once per second.
+	struct ServerMetrics
+	{
+		std::size_t ticks = 0;
+		double tick_ms_total = 0.0;
+		double tick_ms_max = 0.0;
+		std::size_t snapshots = 0;
+		double encode_us_total = 0.0;
+		std::size_t bytes_sent = 0;
+		std::size_t full_snapshots = 0;
+		std::size_t truncated_snapshots = 0;
+	};
+
+	class Server
+	{
+	private:
+		struct History
+		{
+			std::uint32_t tick = 0;
+			std::vector<EntityState> entities;
+		};
+
+		struct Client
+		{
+			bool active = false;
+			sockaddr_in address{};
+			Player* player = nullptr;
+			std::uint8_t buttons = 0;
+			std::uint32_t last_sequence = 0;
+			std::uint32_t acked_tick = 0;
+			double last_heard = 0.0;
+			std::array<History, history_size> history;
+		};
+
+		Game* game_;
+		UdpSocket socket_;
+		std::array<Client, max_clients> clients_;
+
+		std::vector<EntityState> world_;
+		std::vector<BulletPosition> bullets_;
+		std::vector<EntityState> selected_;
+		std::vector<std::uint8_t> packet_;
+
+		Client* FindClient(const sockaddr_in& address);
+
+		void HandlePacket(const sockaddr_in& from, const std::uint8_t* data, std::size_t size, double now);
+
+		void SendWelcome(const Client& client, std::size_t slot);
+
+		void QuantizeWorld();
+
+		void SendSnapshot(Client* client);
+
+	public:
+		ServerMetrics metrics_;
+
+		explicit Server(Game* game);
+
+		bool Open(std::uint16_t port);
+
+		// Reads every waiting packet, applies the newest input of each client, steps the game and sends snapshots.
+		void Tick(double now);
+
+		std::size_t ClientCount() const;
+
+		std::size_t EntityCount() const;
+	};
+
+	int RunServer(const Options& options);
+} // namespace net
+
+#endif
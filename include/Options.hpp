@@ -0,0 +1,74 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include "Utils/Constants.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+enum class RenderPath
+{
+	LINES, SPRITES
+};
+
+struct Options
+{
+	bool asteroid_collisions = false;
+	RenderPath render_path = RenderPath::LINES;
+	int sprite_angle_steps = 120;
+	std::size_t sprite_cache_bytes = 32 * 1024 * 1024;
+	double world_scale = 1.0;
+	int initial_asteroids = 4;
+	bool headless = false;
+	int ticks = 3600;
+	int tick_rate = constants::ticks_per_second;
+	std::optional<std::uint64_t> seed;
+	std::string capture_path;
+	std::size_t capture_queue_depth = 8;
+	int audio_buffer_frames = 256;
+	bool audio_stats = false;
+	std::string bundle_path = constants::bundle_path;
+	std::string build_bundle_path;
+	bool startup_report = false;
+	std::string hash_path;
+	std::string hash_compare_first;
+	std::string hash_compare_second;
+	std::string benchmark;
+	bool server = false;
+	bool client = false;
+	std::uint16_t port = 27015;
+	std::string connect_host = "127.0.0.1";
+	int load_test_clients = 0;
+	int rollback_player = -1;
+	std::string peer_host = "127.0.0.1";
+	int rollback_window = 8;
+	double net_latency_ms = 0.0;
+	double net_jitter_ms = 0.0;
+	double net_loss = 0.0;
+	bool broadcast = false;
+	bool spectate = false;
+	std::string spectator_channel = "/asteroids-spectator";
+	int batch_size = 1024;
+	int threads = 0;
+	std::string trace_path;
+	double soak_hours = 0.0;
+	std::string soak_baseline_path;
+	std::string soak_save_path;
+	std::string scenario;
+	int spawn_budget = constants::spawns_per_tick;
+	double spawn_budget_us = 0.0;
+	std::string governor;
+	std::string governor_log_path;
+	std::string record_path;
+	std::string replay_path;
+	double seek_seconds = 0.0;
+	double keyframe_seconds = constants::replay_keyframe_seconds;
+};
+
+bool ParseOptions(int argc, char* argv[], Options* options);
+
+void PrintUsage(const char* program);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PARTICLE_SYSTEM_HPP
+#define PARTICLE_SYSTEM_HPP
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Framebuffer;
+
+// Fixed-capacity particle pool in struct-of-arrays layout; nothing is allocated after construction.
+class ParticleSystem
+{
+private:
+	static constexpr int brightness_levels = 4;
+
+	std::size_t capacity_;
+	std::size_t count_;
+
+	std::vector<float> x_;
+	std::vector<float> y_;
+	std::vector<float> vx_;
+	std::vector<float> vy_;
+	std::vector<float> life_;
+
+	std::array<std::vector<SDL_FPoint>, brightness_levels> points_;
+
+	float world_width_;
+	float world_height_;
+	std::uint32_t random_state_;
+
+	float Random();
+
+	void UpdateScalar(float dt, std::size_t begin);
+
+	void UpdateSimd(float dt);
+
+	void Cull();
+
+	void BuildPoints(float camera_x, float camera_y, float view_width, float view_height);
+
+public:
+	bool use_simd_;
+	std::size_t dropped_;
+
+	ParticleSystem(std::size_t capacity, float world_width, float world_height);
+
+	void SetWorldSize(float world_width, float world_height);
+
+	void Clear();
+
+	void Emit(float x, float y, float base_vx, float base_vy, int count, float speed, float lifetime);
+
+	void EmitCone(float x, float y, float direction_x, float direction_y, int count, float speed, float spread, float lifetime);
+
+	void Update(float dt);
+
+	int Render(SDL_Renderer* renderer, float camera_x, float camera_y);
+
+	void Render(Framebuffer* framebuffer, float camera_x, float camera_y);
+
+	std::size_t Count() const;
+
+	std::size_t Capacity() const;
+};
+
+#endif
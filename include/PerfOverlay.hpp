@@ -0,0 +1,70 @@
+#ifndef PERF_OVERLAY_HPP
+#define PERF_OVERLAY_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// What Game::Run measured for one rendered frame.
+struct FrameSample
+{
+	double frame_ms;
+	double events_ms;
+	double tick_ms;
+	double render_ms;
+	double present_ms;
+	int ticks;
+	int draw_calls;
+	std::uint64_t allocations;
+};
+
+// Live frame statistics drawn over the game. Text is laid out from a glyph atlas rendered once at load, so drawing
+// the overlay creates no textures; the numbers are averaged over a second so they stay readable.
+class PerfOverlay
+{
+private:
+	static constexpr int first_glyph = 32;
+	static constexpr int glyph_count = 127 - first_glyph;
+	static constexpr int history = 120;
+
+	SDL_Texture* atlas_;
+	std::array<int, glyph_count + 1> glyph_x_;
+	int glyph_height_;
+
+	std::array<float, history> frame_ms_;
+	std::size_t frames_recorded_;
+
+	FrameSample sum_;
+	int window_frames_;
+	int window_max_ticks_;
+	std::uint64_t window_start_;
+
+	FrameSample average_;
+	double frames_per_second_;
+	double ticks_per_second_;
+	double ticks_per_frame_;
+	int max_ticks_per_frame_;
+	double allocations_per_tick_;
+	int draw_calls_;
+
+	int DrawText(SDL_Renderer* renderer, int x, int y, const char* text) const;
+
+public:
+	PerfOverlay();
+
+	~PerfOverlay();
+
+	bool Load(SDL_Renderer* renderer, TTF_Font* font);
+
+	void Free();
+
+	void AddFrame(const FrameSample& sample);
+
+	// Returns the draw calls it issued.
+	int Render(SDL_Renderer* renderer, std::size_t asteroids, std::size_t bullets, std::size_t particles) const;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef PERFORMANCE_GOVERNOR_HPP
+#define PERFORMANCE_GOVERNOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+enum class GovernorPolicy
+{
+	CAP_SPLITS, CAP_BULLETS, CHEAP_RENDER, SLOW_HUD
+};
+
+// Watches the time each frame (or headless tick) spends working against its budget and degrades the game one
+// policy at a time while it stays over, then lifts them in reverse order once there is headroom again. Changing what
+// is simulated depends on the machine, so it is off unless asked for and never used by networked or rollback games.
+class PerformanceGovernor
+{
+private:
+	std::vector<GovernorPolicy> policies_;
+	std::size_t level_;
+	double budget_ms_;
+	double tick_seconds_;
+	double average_ms_;
+	int over_samples_;
+	int under_samples_;
+	std::FILE* log_;
+
+	void Log(std::uint64_t tick, const char* action, GovernorPolicy policy);
+
+public:
+	static constexpr double escalate_ratio = 0.9;
+	static constexpr double recover_ratio = 0.6;
+	static constexpr int escalate_samples = 30;
+	static constexpr int recover_samples = 120;
+
+	// Fewer splits and bullets while the matching policies apply, and how often the HUD text may be rebuilt.
+	static constexpr int splits_per_tick = 4;
+	static constexpr std::size_t bullet_cap = 128;
+	static constexpr std::uint64_t hud_interval_ticks = 30;
+
+	std::size_t decisions_;
+
+	PerformanceGovernor();
+
+	~PerformanceGovernor();
+
+	// policies is a comma separated list of splits, bullets, render and hud, applied in the order given, or "all".
+	// budget_ms is what one sample may take: a displayed frame when sampling frames, one tick when sampling ticks.
+	// tick_rate only converts the ticks in the log to seconds.
+	bool Configure(const char* policies, const char* log_path, double budget_ms, int tick_rate);
+
+	bool Enabled() const;
+
+	void AddSample(double work_ms, std::uint64_t tick);
+
+	bool Active(GovernorPolicy policy) const;
+
+	std::size_t Level() const;
+
+	static const char* Name(GovernorPolicy policy);
+};
+
+#endif
@@ -3,21 +3,38 @@
 
 #include "LinePolygon.hpp"
 
+#include <cstdint>
+
 class Game;
 
+// Buttons a ship responds to, as a bit mask, so local keys and remote input drive it the same way.
+namespace input
+{
+	enum Button : std::uint8_t
+	{
+		LEFT = 1, RIGHT = 2, THRUST = 4, FIRE = 8
+	};
+} // namespace input
+
 class Player : public LinePolygon
 {
 public:
 	bool moving_;
+	// Turn rate in degrees per second, positive clockwise.
 	int rotating_degrees_;
 	SDL_FPoint direction_vector_;
 	int lives_;
+	std::uint8_t buttons_;
+	bool local_;
+	SDL_FPoint spawn_offset_;
 
 	Player(Game* game, int lives);
 
 	void CreatePlayerGeometry();
 
 	void HandleEvent(SDL_Event* e) override;
+
+	void ApplyInput(std::uint8_t buttons);
 	
 	void Tick() override;
 
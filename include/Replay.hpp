@@ -0,0 +1,145 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class Game;
+
+// Replay container: a header, then one segment per keyframe interval and an index of the segments at the end.
+// A segment is a full snapshot taken at the start of its first tick, after that tick's input, followed by one
+// record per tick. A record is a byte of flags holding the number of input changes, then the new button masks. The
+// first record's input is already in the keyframe; it is only applied when playback runs on from the segment before.
+namespace replay
+{
+	inline constexpr char magic[8] = { 'A', 'S', 'T', 'R', 'P', 'L', 'Y', '\0' };
+	inline constexpr std::uint32_t version = 1;
+
+	inline constexpr std::uint8_t input_count_mask = 0x0F;
+	// An input count of input_count_mask is followed by a byte with the actual count.
+	inline constexpr std::uint8_t long_input_count = input_count_mask;
+	inline constexpr std::uint8_t reset_game_flag = 0x10;
+	inline constexpr std::uint8_t asteroid_collisions_flag = 0x20;
+
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t snapshot_version;
+		std::uint32_t tick_rate;
+		std::uint32_t keyframe_ticks;
+		// Not part of a snapshot, but a reset after game over depends on them.
+		std::uint32_t initial_asteroids;
+		std::uint32_t spawn_budget;
+	};
+
+	struct SegmentHeader
+	{
+		std::uint64_t tick;
+		std::uint64_t snapshot_size;
+	};
+
+	struct IndexEntry
+	{
+		std::uint64_t tick;
+		std::uint64_t offset;
+		std::uint64_t snapshot_size;
+		std::uint64_t input_size;
+		std::uint64_t ticks;
+	};
+
+	struct Footer
+	{
+		std::uint64_t index_offset;
+		std::uint64_t segment_count;
+		std::uint64_t total_ticks;
+		char magic[8];
+	};
+} // namespace replay
+
+// Streams a game to a replay file as it is played. Input changes are queued as they happen and written with the
+// next tick's record.
+class ReplayWriter
+{
+private:
+	std::FILE* file_;
+	std::string path_;
+	std::uint32_t keyframe_ticks_;
+	std::uint64_t position_;
+	std::uint64_t ticks_;
+	std::uint64_t input_bytes_;
+	std::vector<std::uint8_t> pending_inputs_;
+	std::vector<std::uint8_t> snapshot_;
+	std::vector<replay::IndexEntry> index_;
+
+	void Write(const void* data, std::size_t size);
+
+public:
+	ReplayWriter();
+
+	~ReplayWriter();
+
+	bool Open(const char* path, const Game& game, std::uint32_t keyframe_ticks, int initial_asteroids, int spawn_budget);
+
+	void AddInput(std::uint8_t buttons);
+
+	// Called at the start of every tick, after its input.
+	void Record(const Game& game);
+
+	// Writes the index; the file cannot be played back without it.
+	bool Close();
+};
+
+// Plays a replay file from a read-only mapping. Seeking restores the nearest keyframe at or before the target and
+// fast-forwards from there without drawing; segments left behind are dropped from memory.
+class ReplayReader
+{
+private:
+	void* mapping_;
+	std::size_t mapping_size_;
+	replay::Header header_;
+	const replay::IndexEntry* index_;
+	std::size_t segment_count_;
+	std::uint64_t end_tick_;
+
+	std::size_t segment_;
+	const std::uint8_t* record_;
+	std::uint64_t tick_;
+	// The current record's input is already on the ship, as it is right after a keyframe or a seek.
+	bool applied_;
+
+	const std::uint8_t* Data(std::uint64_t offset) const;
+
+	void EnterSegment(std::size_t segment);
+
+	void ApplyRecord(Game* game);
+
+public:
+	ReplayReader();
+
+	~ReplayReader();
+
+	bool Open(const char* path);
+
+	void Close();
+
+	const replay::Header& Info() const;
+
+	std::uint64_t FirstTick() const;
+
+	std::uint64_t EndTick() const;
+
+	// The tick the next Step plays.
+	std::uint64_t Tick() const;
+
+	// Plays one tick; false at the end of the replay.
+	bool Step(Game* game);
+
+	// Leaves the game at the start of tick, with that tick's input applied.
+	bool Seek(Game* game, std::uint64_t tick);
+};
+
+#endif
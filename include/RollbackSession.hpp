@@ -0,0 +1,91 @@
+#ifndef ROLLBACK_SESSION_HPP
+#define ROLLBACK_SESSION_HPP
+
+#include "LatencySimulator.hpp"
+#include "UdpSocket.hpp"
+#include "Options.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Game;
+
+namespace net
+{
+	inline constexpr std::size_t rollback_ring_size = 64;
+	inline constexpr int max_rollback_window = 30;
+
+	struct RollbackStats
+	{
+		std::size_t frames = 0;
+		std::size_t stalls = 0;
+		std::size_t mispredictions = 0;
+		std::size_t rollbacks = 0;
+		std::size_t resimulated_ticks = 0;
+		std::size_t max_depth = 0;
+		double resimulate_ms_total = 0.0;
+		double resimulate_ms_max = 0.0;
+	};
+
+	// Two-player session where each peer simulates both ships. The remote ship runs on predicted input (its last known
+	// buttons); when the real input turns out different, the game is restored to that tick and simulated forward again.
+	class RollbackSession
+	{
+	private:
+		struct Frame
+		{
+			std::uint8_t local = 0;
+			std::uint8_t remote = 0;
+			std::vector<std::uint8_t> state;
+		};
+
+		Game* game_;
+		int local_index_;
+		std::uint32_t window_;
+		UdpSocket socket_;
+		sockaddr_in peer_;
+		LatencySimulator link_;
+
+		std::array<Frame, rollback_ring_size> frames_;
+		std::array<std::uint8_t, rollback_ring_size> remote_inputs_;
+		std::uint32_t frame_;
+		std::uint32_t remote_frames_;
+		std::uint32_t remote_ack_;
+		std::uint32_t rollback_to_;
+
+		std::uint8_t PredictRemote(std::uint32_t frame) const;
+
+		void Simulate(std::uint32_t frame, bool save);
+
+		void ReceiveInputs();
+
+		void Resimulate();
+
+		void SendInputs(double now);
+
+	public:
+		RollbackStats stats_;
+
+		RollbackSession(Game* game, int local_index, int window);
+
+		bool Open(std::uint16_t port, const char* peer_host, std::uint16_t peer_port, const LinkConditions& conditions, std::uint32_t seed);
+
+		// Simulates the next tick with the given local buttons, unless the peer is too far behind to predict.
+		bool AdvanceFrame(std::uint8_t local_buttons, double now);
+
+		// Takes in remote input and corrects the simulation without advancing it.
+		void Poll(double now);
+
+		std::uint32_t CurrentFrame() const;
+
+		// Ticks for which the remote input is known rather than predicted.
+		std::uint32_t ConfirmedFrames() const;
+	};
+
+	// Windowed play as ship options.rollback_player against a peer on options.peer_host.
+	int RunRollback(const Options& options);
+} // namespace net
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+class Game;
+
+// A reproducible load profile. Scenario files hold one "key value" pair per line, with '#' starting a comment:
+//
+//   name split-cascade
+//   seed 7
+//   duration 60          # simulated seconds
+//   world_scale 3
+//   asteroid_collisions 0
+//   large 1500           # initial asteroids by AsteroidType
+//   medium 0
+//   small 0
+//   spawn_large 0        # asteroids added per second
+//   spawn_medium 0
+//   spawn_small 0
+//   max_asteroids 20000  # spawning pauses above this many
+//   bullets 1200         # fired per second from random points in random directions
+struct Scenario
+{
+	std::string name;
+	std::uint64_t seed = 1;
+	double duration_seconds = 30.0;
+	double world_scale = 1.0;
+	bool asteroid_collisions = false;
+	std::array<int, 3> initial = {};
+	std::array<double, 3> spawn_per_second = {};
+	int max_asteroids = 100000;
+	double bullets_per_second = 0.0;
+};
+
+namespace scenario
+{
+	bool Parse(const char* text, const char* source, Scenario* scenario);
+
+	bool Load(const char* path, Scenario* scenario);
+
+	// A built-in profile by name, otherwise a scenario file.
+	bool Resolve(const std::string& name_or_path, Scenario* scenario);
+
+	void PrintProfiles();
+} // namespace scenario
+
+// Feeds a scenario into a game through SpawnAsteroids, AddAsteroid and AddBullet, and times the ticks it drives.
+class ScenarioDriver
+{
+private:
+	Scenario scenario_;
+	int tick_rate_;
+	std::mt19937_64 rng_;
+	std::array<double, 3> spawn_credit_;
+	double bullet_credit_;
+	bool started_;
+
+	std::uint64_t tick_start_;
+	std::vector<float> tick_ms_;
+	std::vector<float> frame_ms_;
+	std::size_t peak_asteroids_;
+	std::size_t peak_bullets_;
+
+public:
+	ScenarioDriver(const Scenario& scenario, int tick_rate);
+
+	const Scenario& Definition() const;
+
+	std::uint64_t Ticks() const;
+
+	void BeforeTick(Game* game);
+
+	void AfterTick(const Game& game);
+
+	void RecordFrame(double frame_ms);
+
+	void Report() const;
+};
+
+#endif
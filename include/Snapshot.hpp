@@ -0,0 +1,123 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+class LinePolygon;
+class Player;
+class Bullet;
+
+// Flat game-state snapshot: a header followed by fixed-size records. It holds offsets instead of pointers, so a
+// buffer can be copied, stored or sent anywhere and restored as long as the version matches.
+namespace snapshot
+{
+	inline constexpr char magic[4] = { 'A', 'S', 'N', 'P' };
+	inline constexpr std::uint32_t version = 4;
+	inline constexpr std::size_t max_polygon_points = 8;
+
+	static_assert(std::is_trivially_copyable_v<std::mt19937_64>, "the random engine is saved byte for byte");
+
+	struct PolygonState
+	{
+		SDL_FPoint center;
+		SDL_FPoint acceleration;
+		SDL_FPoint velocity;
+		SDL_FPoint points[max_polygon_points];
+		double furthest_distance_squared;
+		double angle;
+		std::int32_t mesh_id;
+		std::uint8_t point_count;
+		std::uint8_t removed;
+	};
+
+	struct PlayerState
+	{
+		PolygonState polygon;
+		SDL_FPoint direction;
+		SDL_FPoint spawn_offset;
+		std::int32_t rotating_degrees;
+		std::int32_t lives;
+		std::uint8_t moving;
+		std::uint8_t buttons;
+	};
+
+	struct AsteroidState
+	{
+		PolygonState polygon;
+		std::uint32_t id;
+		std::int32_t type;
+	};
+
+	struct BulletState
+	{
+		SDL_FRect geometry;
+		SDL_FPoint velocity;
+		std::int32_t lifetime;
+		std::uint8_t removed;
+	};
+
+	struct PendingSpawnState
+	{
+		double x;
+		double y;
+		double vx;
+		double vy;
+		std::int32_t type;
+		// Ticks the spawn has already waited past the one it was due on.
+		std::int32_t missed;
+	};
+
+	struct GameState
+	{
+		double world_width;
+		double world_height;
+		std::int32_t score;
+		std::int32_t number_of_asteroids;
+		std::uint32_t next_entity_id;
+		std::uint8_t local_player;
+		std::uint8_t game_over;
+		std::uint8_t reset_game;
+		std::uint8_t asteroid_collisions;
+		// Velocities are per second, but bullet lifetimes and pending spawn delays are counted in ticks at this rate.
+		std::int32_t tick_rate;
+		std::uint8_t random_engine[sizeof(std::mt19937_64)];
+		PlayerState player;
+	};
+
+	struct Header
+	{
+		char magic[4];
+		std::uint32_t version;
+		std::uint64_t size;
+		std::uint32_t asteroid_count;
+		std::uint32_t bullet_count;
+		std::uint32_t remote_player_count;
+		std::uint32_t pending_spawn_count;
+	};
+
+	// Records follow the header in this order: one GameState, remote_player_count PlayerStates,
+	// asteroid_count AsteroidStates, bullet_count BulletStates, pending_spawn_count PendingSpawnStates.
+	inline constexpr std::size_t RecordsSize(std::size_t asteroid_count, std::size_t bullet_count, std::size_t remote_player_count, std::size_t pending_spawn_count)
+	{
+		return sizeof(Header) + sizeof(GameState) + remote_player_count * sizeof(PlayerState) + asteroid_count * sizeof(AsteroidState) + bullet_count * sizeof(BulletState) + pending_spawn_count * sizeof(PendingSpawnState);
+	}
+
+	void Store(const LinePolygon& polygon, PolygonState* state);
+
+	bool Load(const PolygonState& state, LinePolygon* polygon);
+
+	void Store(const Player& player, PlayerState* state);
+
+	bool Load(const PlayerState& state, Player* player);
+
+	void Store(const Bullet& bullet, BulletState* state);
+
+	void Load(const BulletState& state, Bullet* bullet);
+} // namespace snapshot
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef SOAK_HPP
+#define SOAK_HPP
+
+#include "Options.hpp"
+
+// Headless long-run test: an autopilot plays for hours of simulated time, restarting on game over, while tick-time
+// percentiles and memory are sampled per interval and the totals are compared against a stored baseline.
+namespace soak
+{
+	inline constexpr double interval_minutes = 10.0;
+
+	// A metric regresses when it exceeds the baseline by this fraction.
+	inline constexpr double tolerance = 0.10;
+
+	int Run(const Options& options);
+} // namespace soak
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SOFTWARE_RENDERER_HPP
+#define SOFTWARE_RENDERER_HPP
+
+#include "Framebuffer.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <string>
+
+class Game;
+class LinePolygon;
+
+class SoftwareRenderer
+{
+private:
+	enum HudSlot
+	{
+		SCORE, LIVES, TOGGLE_INFO, INFO, GAME_OVER, HUD_SLOTS
+	};
+
+	struct TextSurface
+	{
+		std::string text;
+		SDL_Surface* surface;
+	};
+
+	Framebuffer framebuffer_;
+	TTF_Font* font_;
+	TextSurface text_surfaces_[HUD_SLOTS];
+
+	const SDL_Surface* Text(HudSlot slot, const char* text, int wrap_length = -1);
+
+	void DrawPolygon(const LinePolygon& polygon, float offset_x, float offset_y);
+
+public:
+	SoftwareRenderer(int width, int height, TTF_Font* font);
+
+	~SoftwareRenderer();
+
+	void Render(const Game& game);
+
+	const Framebuffer& Frame() const;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+// Uniform grid over a toroidal world, rebuilt with a counting sort so queries touch only the cells they cover.
+template <typename T>
+class SpatialGrid
+{
+private:
+	struct Item
+	{
+		T* object;
+		float wrap_x;
+		float wrap_y;
+	};
+
+	double world_width_;
+	double world_height_;
+	int columns_;
+	int rows_;
+	double cell_width_;
+	double cell_height_;
+
+	std::vector<std::uint32_t> cell_start_;
+	std::vector<std::uint32_t> item_cell_;
+	std::vector<Item> items_;
+	std::vector<Item> scratch_;
+
+public:
+	SpatialGrid() : world_width_(1.0), world_height_(1.0), columns_(1), rows_(1), cell_width_(1.0), cell_height_(1.0), cell_start_(2, 0)
+	{
+	}
+
+	void Configure(double world_width, double world_height, double cell_size)
+	{
+		world_width_ = world_width;
+		world_height_ = world_height;
+		columns_ = std::max(1, static_cast<int>(std::ceil(world_width / cell_size)));
+		rows_ = std::max(1, static_cast<int>(std::ceil(world_height / cell_size)));
+		cell_width_ = world_width / columns_;
+		cell_height_ = world_height / rows_;
+		Clear();
+	}
+
+	void Clear()
+	{
+		cell_start_.assign(static_cast<std::size_t>(columns_) * rows_ + 1, 0);
+		items_.clear();
+	}
+
+	template <typename Position>
+	void Rebuild(const std::list<std::unique_ptr<T>>& objects, Position position)
+	{
+		const std::size_t cells = static_cast<std::size_t>(columns_) * rows_;
+
+		cell_start_.assign(cells + 1, 0);
+		scratch_.clear();
+		item_cell_.clear();
+
+		for (const std::unique_ptr<T>& object : objects)
+		{
+			const SDL_FPoint point = position(*object);
+			const double x = point.x - world_width_ * std::floor(point.x / world_width_);
+			const double y = point.y - world_height_ * std::floor(point.y / world_height_);
+			const int column = std::min(static_cast<int>(x / cell_width_), columns_ - 1);
+			const int row = std::min(static_cast<int>(y / cell_height_), rows_ - 1);
+			const std::uint32_t cell = static_cast<std::uint32_t>(row * columns_ + column);
+
+			scratch_.push_back({ object.get(), static_cast<float>(x - point.x), static_cast<float>(y - point.y) });
+			item_cell_.push_back(cell);
+			++cell_start_[cell + 1];
+		}
+
+		for (std::size_t cell = 0; cell < cells; ++cell)
+		{
+			cell_start_[cell + 1] += cell_start_[cell];
+		}
+
+		items_.resize(scratch_.size());
+
+		for (std::size_t i = 0; i < scratch_.size(); ++i)
+		{
+			items_[cell_start_[item_cell_[i]]++] = scratch_[i];
+		}
+
+		// The scatter above advanced every start to the next cell's start; shift them back.
+		for (std::size_t cell = cells; cell > 0; --cell)
+		{
+			cell_start_[cell] = cell_start_[cell - 1];
+		}
+
+		cell_start_[0] = 0;
+	}
+
+	// Calls visit(object, shift_x, shift_y) for everything in the rectangle. Adding the shift to the object's coordinates
+	// gives the copy of it that lies in the rectangle, which differs from the object itself across the world seam.
+	template <typename Visitor>
+	void Query(double left, double top, double width, double height, Visitor visit) const
+	{
+		const int first_column = static_cast<int>(std::floor(left / cell_width_));
+		const int first_row = static_cast<int>(std::floor(top / cell_height_));
+		const int last_column = std::min(static_cast<int>(std::floor((left + width) / cell_width_)), first_column + columns_ - 1);
+		const int last_row = std::min(static_cast<int>(std::floor((top + height) / cell_height_)), first_row + rows_ - 1);
+
+		for (int row = first_row; row <= last_row; ++row)
+		{
+			const int wrapped_row = ((row % rows_) + rows_) % rows_;
+			const double shift_y = world_height_ * ((row - wrapped_row) / rows_);
+
+			for (int column = first_column; column <= last_column; ++column)
+			{
+				const int wrapped_column = ((column % columns_) + columns_) % columns_;
+				const double shift_x = world_width_ * ((column - wrapped_column) / columns_);
+				const std::size_t cell = static_cast<std::size_t>(wrapped_row) * columns_ + wrapped_column;
+
+				for (std::uint32_t i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i)
+				{
+					const Item& item = items_[i];
+					visit(*item.object, static_cast<float>(item.wrap_x + shift_x), static_cast<float>(item.wrap_y + shift_y));
+				}
+			}
+		}
+	}
+
+	std::size_t Size() const
+	{
+		return items_.size();
+	}
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SPAWN_SCHEDULER_HPP
+#define SPAWN_SCHEDULER_HPP
+
+#include "Asteroid.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class Game;
+
+// Asteroid construction deferred from the tick that asked for it, so a new wave or a burst of splits is built over
+// several ticks under a budget. Positions and velocities are drawn when the spawn is queued, so the random sequence
+// does not depend on the budget, and an asteroid built late is moved on by the ticks it missed.
+class SpawnScheduler
+{
+public:
+	struct Spawn
+	{
+		AsteroidType type;
+		double x;
+		double y;
+		double vx;
+		double vy;
+		// The tick whose asteroid pass should first move it.
+		std::uint64_t due;
+	};
+
+private:
+	std::vector<Spawn> queue_;
+	std::size_t head_;
+	std::size_t per_tick_;
+	double budget_ms_;
+	std::uint64_t last_run_tick_;
+
+	std::size_t Build(Game* game, std::uint64_t tick, std::size_t per_tick, double budget_ms);
+
+public:
+	std::size_t built_;
+	std::size_t deferred_;
+	std::size_t max_pending_;
+	double worst_tick_ms_;
+	std::size_t worst_tick_count_;
+
+	SpawnScheduler();
+
+	// A zero budget means no limit of that kind; with both zero every spawn is built on the tick it was queued.
+	void Configure(std::size_t per_tick, double budget_us);
+
+	void Push(AsteroidType type, double x, double y, double vx, double vy, std::uint64_t tick);
+
+	// Builds queued asteroids, oldest first, until a budget runs out. Called once per tick right before the asteroid pass.
+	void Run(Game* game, std::uint64_t tick);
+
+	// Builds everything queued regardless of the budget, for spawns made outside a tick.
+	void Flush(Game* game, std::uint64_t tick);
+
+	void Clear();
+
+	bool Idle() const;
+
+	std::size_t Pending() const;
+
+	const Spawn& PendingAt(std::size_t index) const;
+
+	// Appends a spawn as saved in a snapshot, after Clear.
+	void Restore(const Spawn& spawn);
+
+	void PrintStats() const;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef SPECTATOR_CHANNEL_HPP
+#define SPECTATOR_CHANNEL_HPP
+
+#include "Options.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Game;
+
+namespace spectator
+{
+	inline constexpr char magic[8] = { 'A', 'S', 'T', 'S', 'P', 'E', 'C', '1' };
+	inline constexpr std::size_t slot_count = 8;
+	inline constexpr std::size_t max_polygons = 4096;
+	inline constexpr std::size_t max_points = 40960;
+	inline constexpr std::size_t max_bullets = 2048;
+
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "atomics in shared memory must not need a lock");
+
+	// One published tick in screen coordinates. Polygons are closed polylines: the first point is repeated at the end,
+	// so a reader draws each with a single SDL_RenderDrawLinesF straight from the mapping.
+	struct Frame
+	{
+		std::atomic<std::uint64_t> sequence;
+		std::uint64_t tick;
+		std::int32_t score;
+		std::int32_t lives;
+		std::uint8_t game_over;
+		std::uint8_t truncated;
+		std::uint32_t polygon_count;
+		std::uint32_t point_count;
+		std::uint32_t bullet_count;
+		std::uint16_t polygon_sizes[max_polygons];
+		SDL_FPoint points[max_points];
+		SDL_FPoint bullets[max_bullets];
+	};
+
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t slot_count;
+		std::uint32_t frame_size;
+		std::uint32_t screen_width;
+		std::uint32_t screen_height;
+		std::atomic<std::uint64_t> latest;
+		std::atomic<std::uint32_t> closed;
+	};
+
+	// Frames are written with a per-slot seqlock: the sequence is odd while the game writes and advances by two per
+	// write. The game never waits for readers; a reader that sees the sequence change under it drops that frame.
+	class Publisher
+	{
+	private:
+		int descriptor_;
+		void* mapping_;
+		std::size_t size_;
+		std::string name_;
+		Header* header_;
+		Frame* frames_;
+		std::uint64_t published_;
+
+	public:
+		std::size_t ticks_published_;
+		double publish_ns_total_;
+		double publish_ns_max_;
+
+		Publisher();
+
+		~Publisher();
+
+		Publisher(const Publisher&) = delete;
+
+		Publisher& operator=(const Publisher&) = delete;
+
+		bool Create(const char* name);
+
+		void Close();
+
+		void Publish(const Game& game);
+	};
+
+	class Reader
+	{
+	private:
+		int descriptor_;
+		const void* mapping_;
+		std::size_t size_;
+		const Header* header_;
+		const Frame* frames_;
+
+	public:
+		Reader();
+
+		~Reader();
+
+		Reader(const Reader&) = delete;
+
+		Reader& operator=(const Reader&) = delete;
+
+		bool Open(const char* name);
+
+		void Close();
+
+		const Header& GetHeader() const;
+
+		// The slot holding the newest frame; check it with Begin and Validate around any use.
+		const Frame& Latest() const;
+
+		// Returns false while the slot is being written; otherwise stores the sequence to validate against.
+		static bool Begin(const Frame& frame, std::uint64_t* sequence);
+
+		static bool Validate(const Frame& frame, std::uint64_t sequence);
+	};
+
+	int RunViewer(const Options& options);
+} // namespace spectator
+
+#endif
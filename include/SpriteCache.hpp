@@ -0,0 +1,50 @@
+#ifndef SPRITE_CACHE_HPP
+#define SPRITE_CACHE_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+class LinePolygon;
+
+class SpriteCache
+{
+private:
+	struct Entry
+	{
+		SDL_Texture* texture;
+		int size;
+		std::uint64_t last_used;
+	};
+
+	std::unordered_map<std::uint32_t, Entry> entries_;
+	int angle_steps_;
+	std::size_t max_bytes_;
+	std::size_t bytes_;
+	std::uint64_t uses_;
+
+	bool Rasterize(SDL_Renderer* renderer, const LinePolygon& polygon, double angle, Entry* entry);
+
+	void EvictLeastRecentlyUsed();
+
+public:
+	std::size_t hits_;
+	std::size_t misses_;
+	std::size_t evictions_;
+
+	SpriteCache(int angle_steps, std::size_t max_bytes);
+
+	~SpriteCache();
+
+	void Configure(int angle_steps, std::size_t max_bytes);
+
+	void Clear();
+
+	bool Render(SDL_Renderer* renderer, const LinePolygon& polygon, float offset_x = 0.0f, float offset_y = 0.0f);
+
+	std::size_t Bytes() const;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef STATE_HASH_HPP
+#define STATE_HASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+class Game;
+
+// Per-tick digest of the simulation, one hash per group of fields. Entities are combined by addition, so the
+// digest does not depend on the order of the asteroid and bullet lists.
+class StateHash
+{
+public:
+	enum Field
+	{
+		PLAYER, ASTEROID_CENTERS, ASTEROID_VERTICES, ASTEROID_VELOCITIES, BULLET_POSITIONS, BULLET_VELOCITIES, BULLET_LIFETIMES, COUNTERS, RANDOM_ENGINE, FIELD_COUNT
+	};
+
+	using Digest = std::array<std::uint64_t, FIELD_COUNT>;
+
+private:
+	std::FILE* file_;
+	std::uint64_t hash_counter_;
+
+public:
+	std::size_t ticks_hashed_;
+
+	StateHash();
+
+	~StateHash();
+
+	static const char* FieldName(int field);
+
+	static Digest Compute(const Game& game);
+
+	bool Open(const char* path);
+
+	void Record(std::uint64_t tick, const Game& game);
+
+	void Close();
+
+	double MicrosecondsPerTick() const;
+
+	static int Compare(const char* first_path, const char* second_path);
+};
+
+#endif
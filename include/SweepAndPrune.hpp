@@ -0,0 +1,50 @@
+#ifndef SWEEP_AND_PRUNE_HPP
+#define SWEEP_AND_PRUNE_HPP
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <vector>
+
+class Asteroid;
+
+class SweepAndPrune
+{
+private:
+	struct Proxy
+	{
+		Asteroid* asteroid;
+		float min_x;
+		float max_x;
+		float radius;
+	};
+
+	std::vector<Proxy> proxies_;
+	std::vector<std::pair<Asteroid*, Asteroid*>> pairs_;
+
+	double world_width_;
+	double world_height_;
+	float max_extent_;
+
+	void AddCandidate(const Proxy& a, const Proxy& b);
+
+public:
+	std::size_t swaps_;
+	std::size_t candidates_;
+
+	SweepAndPrune(double world_width, double world_height);
+
+	void SetWorldSize(double world_width, double world_height);
+
+	void Clear();
+
+	void Update(const std::list<std::unique_ptr<Asteroid>>& asteroids);
+
+	void ResolveCollisions();
+
+	const std::vector<std::pair<Asteroid*, Asteroid*>>& Pairs() const;
+
+	std::size_t Size() const;
+};
+
+#endif
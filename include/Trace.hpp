@@ -0,0 +1,65 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Zone timings in Chrome trace_event format. Each thread records into its own fixed ring, so the hot path takes no
+// lock and memory stays bounded however long the session runs; only the newest events per thread are kept.
+namespace trace
+{
+	inline constexpr std::size_t events_per_thread = 1 << 16;
+
+	extern std::atomic<bool> enabled;
+
+	bool Start(const char* path);
+
+	// Stops recording and writes everything kept to the file given to Start.
+	void Stop();
+
+	void Record(const char* name, std::uint64_t start, std::uint64_t end);
+
+	// Names the calling thread in the trace; threads are otherwise listed by the order they first recorded.
+	void NameThread(const char* name);
+
+	// A thread's first event allocates its ring and takes a lock. A thread that must do neither, such as the audio
+	// callback, gets a named ring reserved up front and adopts it; AdoptReserved is false while it has none to record
+	// into. Reserve does nothing unless tracing is on.
+	void Reserve(const char* name);
+
+	bool AdoptReserved();
+
+	// Times its own scope. With tracing off this is a relaxed load and a branch on each end.
+	class Zone
+	{
+	private:
+		const char* name_;
+		std::uint64_t start_;
+
+	public:
+		explicit Zone(const char* name) : name_(name), start_(enabled.load(std::memory_order_relaxed) ? SDL_GetPerformanceCounter() : 0)
+		{
+		}
+
+		Zone(const char* name, bool record) : name_(name), start_(record && enabled.load(std::memory_order_relaxed) ? SDL_GetPerformanceCounter() : 0)
+		{
+		}
+
+		~Zone()
+		{
+			if (start_ != 0)
+			{
+				Record(name_, start_, SDL_GetPerformanceCounter());
+			}
+		}
+
+		Zone(const Zone&) = delete;
+
+		Zone& operator=(const Zone&) = delete;
+	};
+} // namespace trace
+
+#endif
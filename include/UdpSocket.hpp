@@ -0,0 +1,36 @@
+#ifndef UDP_SOCKET_HPP
+#define UDP_SOCKET_HPP
+
+#include <netinet/in.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-blocking IPv4 datagram socket.
+class UdpSocket
+{
+private:
+	int descriptor_;
+
+public:
+	UdpSocket();
+
+	~UdpSocket();
+
+	UdpSocket(const UdpSocket&) = delete;
+
+	UdpSocket& operator=(const UdpSocket&) = delete;
+
+	bool Open(std::uint16_t port);
+
+	void Close();
+
+	bool Send(const sockaddr_in& address, const void* data, std::size_t size);
+
+	// Returns the datagram size, or -1 when nothing is waiting.
+	int Receive(void* buffer, std::size_t capacity, sockaddr_in* from);
+
+	static bool Resolve(const char* host, std::uint16_t port, sockaddr_in* address);
+};
+
+#endif
@@ -6,6 +6,53 @@ namespace constants
 	inline constexpr char game_title[] = "Asteroids"; 
 	inline constexpr int screen_width = 1300;
 	inline constexpr int screen_height = 1000;
+	inline constexpr int frames_per_second = 60;
+	inline constexpr int ticks_per_second = 60;
+	inline constexpr int min_tick_rate = 10;
+	inline constexpr int max_tick_rate = 1000;
+
+	// Motion is in pixels and degrees per second; each tick advances it by the game's timestep.
+	inline constexpr double ship_thrust = 720.0;
+	inline constexpr float ship_max_speed = 300.0f;
+	inline constexpr int ship_turn_rate = 300;
+	inline constexpr double bullet_speed = 1800.0;
+	inline constexpr double bullet_lifetime = 0.5;
+	inline constexpr double asteroid_spin = -60.0;
+	inline constexpr double wave_speed = 120.0;
+	inline constexpr double split_speed = 300.0;
+
+	inline constexpr int particle_capacity = 131072;
+
+	// Asteroids built per tick from a new wave or a burst of splits; the rest wait for the following ticks.
+	inline constexpr int spawns_per_tick = 64;
+
+	// A replay keyframe bounds how far a seek has to fast-forward; the arrow keys seek this far during playback.
+	inline constexpr double replay_keyframe_seconds = 10.0;
+	inline constexpr double replay_seek_step_seconds = 10.0;
+
+	// Camera culling: grid cell size and the largest distance from an object's position to anything drawn for it.
+	inline constexpr double cull_cell_size = 256.0;
+	inline constexpr double cull_margin = 96.0;
+
+	// Random points a wave tries for each asteroid before settling for the one furthest from the player's view.
+	inline constexpr int spawn_attempts = 32;
+
+	inline constexpr char font_path[] = "res/font/font.ttf";
+	inline constexpr int font_size = 28;
+	inline constexpr int overlay_font_size = 16;
+
+	inline constexpr char shoot_sfx_path[] = "res/sfx/shoot.wav";
+	inline constexpr char explosion_sfx_path[] = "res/sfx/explosion.wav";
+	inline constexpr char bundle_path[] = "res/assets.bundle";
+
+	inline constexpr char toggle_info_text[] = "Press 'i' to toggle info";
+	inline constexpr char info_text[] = "Arrows - move Space - shoot C - asteroid collisions P - performance";
+	inline constexpr int info_wrap_length = 200;
+	inline constexpr char game_over_text[] = "Game Over!.            Press 'r' to restart.";
+	inline constexpr int game_over_wrap_length = 300;
+
+	// Asteroid meshes are identified by their AsteroidType value.
+	inline constexpr int player_mesh_id = 3;
 } // namespace constants
 
 #endif
\ No newline at end of file
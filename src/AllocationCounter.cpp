@@ -0,0 +1,207 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(ALLOCATION_TRACKING)
+#include <atomic>
+#include <cstddef>
+#endif
+
+namespace
+{
+	thread_local std::uint64_t thread_allocations = 0;
+
+#if defined(ALLOCATION_TRACKING)
+	constexpr std::size_t subsystem_count = static_cast<std::size_t>(memory::Subsystem::COUNT);
+
+	constexpr const char* subsystem_names[subsystem_count] = { "other", "tick", "tick/ships", "tick/asteroids", "tick/bullets", "tick/spawns", "collision", "hud", "render" };
+
+	struct Counters
+	{
+		std::atomic<std::uint64_t> allocations;
+		std::atomic<std::uint64_t> bytes;
+		std::atomic<std::int64_t> live_bytes;
+		std::atomic<std::int64_t> peak_live_bytes;
+	};
+
+	// Zero before any constructor runs, since operator new may be called during static initialization.
+	Counters counters[subsystem_count];
+
+	// What the counters held at the previous report; only the reporting thread touches these.
+	std::uint64_t reported_allocations[subsystem_count];
+	std::uint64_t reported_bytes[subsystem_count];
+
+	thread_local memory::Subsystem current_subsystem = memory::Subsystem::OTHER;
+
+	// Placed in front of every block so delete knows what to give back to whom; it keeps malloc's alignment.
+	struct alignas(std::max_align_t) BlockHeader
+	{
+		std::size_t size;
+		memory::Subsystem subsystem;
+	};
+
+	void* Track(void* block, std::size_t size)
+	{
+		BlockHeader* header = static_cast<BlockHeader*>(block);
+		header->size = size;
+		header->subsystem = current_subsystem;
+
+		Counters& counter = counters[static_cast<std::size_t>(current_subsystem)];
+		counter.allocations.fetch_add(1, std::memory_order_relaxed);
+		counter.bytes.fetch_add(size, std::memory_order_relaxed);
+
+		const std::int64_t live = counter.live_bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) + static_cast<std::int64_t>(size);
+		std::int64_t peak = counter.peak_live_bytes.load(std::memory_order_relaxed);
+
+		while (live > peak && !counter.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+
+		return header + 1;
+	}
+
+	void Release(void* memory)
+	{
+		if (memory == nullptr)
+		{
+			return;
+		}
+
+		BlockHeader* header = static_cast<BlockHeader*>(memory) - 1;
+		counters[static_cast<std::size_t>(header->subsystem)].live_bytes.fetch_sub(static_cast<std::int64_t>(header->size), std::memory_order_relaxed);
+
+		std::free(header);
+	}
+#else
+	void Release(void* memory)
+	{
+		std::free(memory);
+	}
+#endif
+} // namespace
+
+namespace memory
+{
+	std::uint64_t ThreadAllocations()
+	{
+		return thread_allocations;
+	}
+
+#if defined(ALLOCATION_TRACKING)
+	Scope::Scope(Subsystem subsystem) : previous_(current_subsystem)
+	{
+		current_subsystem = subsystem;
+	}
+
+	Scope::~Scope()
+	{
+		current_subsystem = previous_;
+	}
+
+	void ResetSubsystemReport()
+	{
+		for (std::size_t i = 0; i < subsystem_count; ++i)
+		{
+			Counters& counter = counters[i];
+			reported_allocations[i] = counter.allocations.load(std::memory_order_relaxed);
+			reported_bytes[i] = counter.bytes.load(std::memory_order_relaxed);
+			counter.peak_live_bytes.store(counter.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+	}
+
+	void ReportSubsystems(double units, const char* unit)
+	{
+		printf("Allocations by subsystem, per %s over %.1f:\n", unit, units);
+		printf("  %-15s %12s %12s %12s %12s\n", "subsystem", "allocs", "KB", "live KB", "peak KB");
+
+		for (std::size_t i = 0; i < subsystem_count; ++i)
+		{
+			Counters& counter = counters[i];
+			const std::uint64_t allocations = counter.allocations.load(std::memory_order_relaxed);
+			const std::uint64_t bytes = counter.bytes.load(std::memory_order_relaxed);
+			const std::int64_t live = counter.live_bytes.load(std::memory_order_relaxed);
+			const std::int64_t peak = counter.peak_live_bytes.exchange(live, std::memory_order_relaxed);
+
+			const double per_unit = units > 0.0 ? 1.0 / units : 0.0;
+
+			printf("  %-15s %12.1f %12.1f %12.1f %12.1f\n", subsystem_names[i], static_cast<double>(allocations - reported_allocations[i]) * per_unit, static_cast<double>(bytes - reported_bytes[i]) / 1024.0 * per_unit, static_cast<double>(live) / 1024.0, static_cast<double>(peak) / 1024.0);
+
+			reported_allocations[i] = allocations;
+			reported_bytes[i] = bytes;
+		}
+	}
+#else
+	void ResetSubsystemReport()
+	{
+	}
+
+	void ReportSubsystems(double, const char*)
+	{
+	}
+#endif
+} // namespace memory
+
+void* operator new(std::size_t size)
+{
+	++thread_allocations;
+
+	if (size == 0)
+	{
+		size = 1;
+	}
+
+	while (true)
+	{
+#if defined(ALLOCATION_TRACKING)
+		void* memory = std::malloc(sizeof(BlockHeader) + size);
+
+		if (memory != nullptr)
+		{
+			return Track(memory, size);
+		}
+#else
+		void* memory = std::malloc(size);
+
+		if (memory != nullptr)
+		{
+			return memory;
+		}
+#endif
+
+		std::new_handler handler = std::get_new_handler();
+
+		if (handler == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		handler();
+	}
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	Release(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	Release(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	Release(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	Release(memory);
+}
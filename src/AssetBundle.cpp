@@ -0,0 +1,239 @@
+#include "AssetBundle.hpp"
+#include "AudioMixer.hpp"
+#include "Utils/Constants.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr char bundle_magic[8] = { 'A', 'S', 'T', 'B', 'N', 'D', 'L', '\0' };
+	constexpr std::uint32_t bundle_version = 1;
+	constexpr std::size_t data_alignment = 16;
+
+	bool ReadFile(const char* path, std::vector<std::uint8_t>* bytes)
+	{
+		std::FILE* file = std::fopen(path, "rb");
+
+		if (file == nullptr)
+		{
+			printf("Unable to open %s!\n", path);
+			return false;
+		}
+
+		std::uint8_t buffer[64 * 1024];
+		std::size_t read = 0;
+
+		while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			bytes->insert(bytes->end(), buffer, buffer + read);
+		}
+
+		std::fclose(file);
+		return true;
+	}
+} // namespace
+
+AssetBundle::AssetBundle() : mapping_(nullptr), mapping_size_(0), entries_(nullptr), entry_count_(0)
+{
+}
+
+AssetBundle::~AssetBundle()
+{
+	Close();
+}
+
+bool AssetBundle::Build(const char* path)
+{
+	struct Source
+	{
+		const char* path;
+		AssetType type;
+	};
+
+	const Source sources[] = { { constants::shoot_sfx_path, AssetType::PCM_S16 }, { constants::explosion_sfx_path, AssetType::PCM_S16 }, { constants::font_path, AssetType::FONT } };
+	constexpr std::size_t source_count = sizeof(sources) / sizeof(sources[0]);
+
+	std::vector<Entry> entries(source_count);
+	std::vector<std::vector<std::uint8_t>> payloads(source_count);
+	std::uint64_t offset = sizeof(Header) + sizeof(Entry) * source_count;
+
+	for (std::size_t i = 0; i < source_count; ++i)
+	{
+		Entry& entry = entries[i];
+		std::memset(&entry, 0, sizeof(entry));
+		std::strncpy(entry.name, sources[i].path, sizeof(entry.name) - 1);
+		entry.type = sources[i].type;
+
+		if (sources[i].type == AssetType::PCM_S16)
+		{
+			std::vector<std::int16_t> samples;
+
+			if (!AudioMixer::Decode(sources[i].path, &samples))
+			{
+				return false;
+			}
+
+			const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(samples.data());
+			payloads[i].assign(bytes, bytes + samples.size() * sizeof(std::int16_t));
+			entry.sample_rate = AudioMixer::frequency;
+		}
+		else if (!ReadFile(sources[i].path, &payloads[i]))
+		{
+			return false;
+		}
+
+		offset = (offset + data_alignment - 1) & ~static_cast<std::uint64_t>(data_alignment - 1);
+		entry.offset = offset;
+		entry.size = payloads[i].size();
+		offset += entry.size;
+	}
+
+	// Written next to the destination and renamed into place, so a running game never maps a half-written bundle.
+	const std::string temporary_path = std::string(path) + ".tmp";
+	std::FILE* file = std::fopen(temporary_path.c_str(), "wb");
+
+	if (file == nullptr)
+	{
+		printf("Unable to open %s!\n", temporary_path.c_str());
+		return false;
+	}
+
+	Header header;
+	std::memcpy(header.magic, bundle_magic, sizeof(header.magic));
+	header.version = bundle_version;
+	header.entry_count = static_cast<std::uint32_t>(source_count);
+
+	bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fwrite(entries.data(), sizeof(Entry), source_count, file) == source_count;
+	std::uint64_t position = sizeof(Header) + sizeof(Entry) * source_count;
+
+	for (std::size_t i = 0; i < source_count && written; ++i)
+	{
+		static const std::uint8_t padding[data_alignment] = {};
+
+		written = std::fwrite(padding, 1, entries[i].offset - position, file) == entries[i].offset - position;
+		written = written && std::fwrite(payloads[i].data(), 1, payloads[i].size(), file) == payloads[i].size();
+		position = entries[i].offset + entries[i].size;
+	}
+
+	written = std::fclose(file) == 0 && written;
+
+	if (!written || std::rename(temporary_path.c_str(), path) != 0)
+	{
+		printf("Unable to write asset bundle %s!\n", path);
+		std::remove(temporary_path.c_str());
+		return false;
+	}
+
+	printf("Wrote %zu assets, %llu bytes to %s\n", source_count, static_cast<unsigned long long>(position), path);
+	return true;
+}
+
+bool AssetBundle::Open(const char* path)
+{
+	Close();
+
+	const int descriptor = open(path, O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(descriptor, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(Header))
+	{
+		close(descriptor);
+		return false;
+	}
+
+	const std::size_t size = static_cast<std::size_t>(file_stat.st_size);
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+	// The mapping stays valid after the descriptor is closed.
+	close(descriptor);
+
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	const Header* header = static_cast<const Header*>(mapping);
+	const bool valid_header = std::memcmp(header->magic, bundle_magic, sizeof(bundle_magic)) == 0 && header->version == bundle_version && sizeof(Header) + sizeof(Entry) * static_cast<std::size_t>(header->entry_count) <= size;
+
+	if (!valid_header)
+	{
+		printf("Ignoring invalid or outdated asset bundle %s\n", path);
+		munmap(mapping, size);
+		return false;
+	}
+
+	const Entry* entries = reinterpret_cast<const Entry*>(static_cast<const std::uint8_t*>(mapping) + sizeof(Header));
+
+	for (std::uint32_t i = 0; i < header->entry_count; ++i)
+	{
+		if (entries[i].offset > size || entries[i].size > size - entries[i].offset)
+		{
+			printf("Ignoring truncated asset bundle %s\n", path);
+			munmap(mapping, size);
+			return false;
+		}
+	}
+
+	mapping_ = mapping;
+	mapping_size_ = size;
+	entries_ = entries;
+	entry_count_ = header->entry_count;
+
+	return true;
+}
+
+void AssetBundle::Close()
+{
+	if (mapping_ == nullptr)
+	{
+		return;
+	}
+
+	munmap(mapping_, mapping_size_);
+	mapping_ = nullptr;
+	mapping_size_ = 0;
+	entries_ = nullptr;
+	entry_count_ = 0;
+}
+
+const void* AssetBundle::Find(const char* name, AssetType type, std::size_t* size) const
+{
+	for (std::uint32_t i = 0; i < entry_count_; ++i)
+	{
+		const Entry& entry = entries_[i];
+
+		if (entry.type != type || std::strncmp(entry.name, name, sizeof(entry.name)) != 0)
+		{
+			continue;
+		}
+
+		if (type == AssetType::PCM_S16 && entry.sample_rate != static_cast<std::uint32_t>(AudioMixer::frequency))
+		{
+			return nullptr;
+		}
+
+		*size = static_cast<std::size_t>(entry.size);
+		return static_cast<const std::uint8_t*>(mapping_) + entry.offset;
+	}
+
+	return nullptr;
+}
+
+bool AssetBundle::IsOpen() const
+{
+	return mapping_ != nullptr;
+}
@@ -1,13 +1,17 @@
 #include "Asteroid.hpp"
 #include "Game.hpp"
+#include "Trace.hpp"
+#include "Utils/Constants.hpp"
 
 #include <random>
 #include <iostream>
 #include <limits>
 #include <algorithm>
 
-Asteroid::Asteroid(Game* game, enum AsteroidType type, double x, double y, double vx, double vy) : LinePolygon(game), type_(type)
+Asteroid::Asteroid(Game* game, enum AsteroidType type, double x, double y, double vx, double vy) : LinePolygon(game), type_(type), broadphase_tracked_(false), id_(0)
 {
+	mesh_id_ = static_cast<int>(type_);
+
 	velocity_vector_.x = vx;
 	velocity_vector_.y = vy;
 	
@@ -52,8 +56,10 @@ void Asteroid::HandleEvent(SDL_Event* e)
 
 void Asteroid::Tick()
 {
-	MoveGeometry(velocity_vector_.x, velocity_vector_.y);
-	RotateGeometry(-1.0);
+	const double dt = game_->tick_seconds_;
+
+	MoveGeometry(velocity_vector_.x * dt, velocity_vector_.y * dt);
+	RotateGeometry(constants::asteroid_spin * dt);
 }
 
 void Asteroid::MoveGeometry(double ax, double ay)
@@ -72,9 +78,23 @@ void Asteroid::MoveGeometry(double ax, double ay)
 
 void Asteroid::Split()
 {
-	std::uniform_real_distribution<double> random_vector_x_{ -5.0, 5.0 };
-  	std::uniform_real_distribution<double> random_vector_y_{ -5.0, 5.0 };
+	trace::Zone zone("Asteroid::Split");
+
+	if (!game_->AllowSplit())
+	{
+		return;
+	}
 
-	game_->AddAsteroid(std::make_unique<Asteroid>(game_, (type_ == AsteroidType::LARGE ? AsteroidType::MEDIUM : AsteroidType::SMALL), center_.x, center_.y, random_vector_x_(game_->mt_), random_vector_y_(game_->mt_)));
-	game_->AddAsteroid(std::make_unique<Asteroid>(game_, (type_ == AsteroidType::LARGE ? AsteroidType::MEDIUM : AsteroidType::SMALL), center_.x, center_.y, random_vector_x_(game_->mt_), random_vector_y_(game_->mt_)));
+	std::uniform_real_distribution<double> random_vector_x_{ -constants::split_speed, constants::split_speed };
+  	std::uniform_real_distribution<double> random_vector_y_{ -constants::split_speed, constants::split_speed };
+
+	const AsteroidType fragment_type = type_ == AsteroidType::LARGE ? AsteroidType::MEDIUM : AsteroidType::SMALL;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		const double vx = random_vector_x_(game_->mt_);
+		const double vy = random_vector_y_(game_->mt_);
+
+		game_->QueueAsteroid(fragment_type, center_.x, center_.y, vx, vy);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "AudioMixer.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+AudioMixer::AudioMixer() : 
+	device_(0), 
+	spec_(), 
+	head_(0), 
+	tail_(0), 
+	voices_(), 
+	last_callback_counter_(0), 
+	callbacks_(0), 
+	late_callbacks_(0), 
+	callback_ns_total_(0), 
+	callback_ns_max_(0), 
+	voices_stolen_(0), 
+	triggers_dropped_(0), 
+	triggers_coalesced_(0), 
+	queue_full_(0)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+	Close();
+}
+
+bool AudioMixer::Open(int buffer_frames)
+{
+	SDL_AudioSpec desired;
+	SDL_zero(desired);
+
+	desired.freq = frequency;
+	desired.format = AUDIO_S16SYS;
+	desired.channels = channels;
+	desired.samples = static_cast<Uint16>(buffer_frames);
+	desired.callback = &AudioMixer::Callback;
+	desired.userdata = this;
+
+	// Let SDL adapt the buffer size to the device, but keep the sample format fixed so clips can be mixed as-is.
+	device_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &spec_, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+
+	if (device_ == 0)
+	{
+		printf("Audio device could not be opened! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	// The device stays paused until Start, so clips can still be added; the callback mixes in chunks of this size.
+	accumulator_.assign(static_cast<std::size_t>(spec_.samples) * channels, 0);
+	trace::Reserve("audio");
+
+	return true;
+}
+
+void AudioMixer::Start()
+{
+	if (device_ != 0)
+	{
+		SDL_PauseAudioDevice(device_, 0);
+	}
+}
+
+void AudioMixer::Close()
+{
+	if (device_ == 0)
+	{
+		return;
+	}
+
+	SDL_CloseAudioDevice(device_);
+	device_ = 0;
+}
+
+bool AudioMixer::Decode(const char* path, std::vector<std::int16_t>* samples)
+{
+	SDL_AudioSpec wav_spec;
+	Uint8* wav_buffer = nullptr;
+	Uint32 wav_length = 0;
+
+	if (SDL_LoadWAV(path, &wav_spec, &wav_buffer, &wav_length) == nullptr)
+	{
+		printf("Failed to load sound %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	SDL_AudioCVT cvt;
+
+	if (SDL_BuildAudioCVT(&cvt, wav_spec.format, wav_spec.channels, wav_spec.freq, AUDIO_S16SYS, channels, frequency) < 0)
+	{
+		printf("Failed to convert sound %s! SDL Error: %s\n", path, SDL_GetError());
+		SDL_FreeWAV(wav_buffer);
+		return false;
+	}
+
+	std::vector<Uint8> converted(static_cast<std::size_t>(wav_length) * std::max(cvt.len_mult, 1));
+	std::memcpy(converted.data(), wav_buffer, wav_length);
+	SDL_FreeWAV(wav_buffer);
+
+	cvt.buf = converted.data();
+	cvt.len = static_cast<int>(wav_length);
+
+	if (cvt.needed && SDL_ConvertAudio(&cvt) < 0)
+	{
+		printf("Failed to convert sound %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	const int converted_length = cvt.needed ? cvt.len_cvt : cvt.len;
+
+	samples->resize(static_cast<std::size_t>(converted_length) / sizeof(std::int16_t));
+	std::memcpy(samples->data(), converted.data(), samples->size() * sizeof(std::int16_t));
+
+	return true;
+}
+
+int AudioMixer::Load(const char* path, int priority)
+{
+	Clip clip;
+
+	if (!Decode(path, &clip.storage))
+	{
+		return -1;
+	}
+
+	clip.samples = clip.storage.data();
+	clip.sample_count = clip.storage.size();
+	clip.priority = priority;
+
+	// Clips are only added before Start, so the callback never sees the vector grow.
+	clips_.push_back(std::move(clip));
+	pending_.push_back(0);
+
+	return static_cast<int>(clips_.size()) - 1;
+}
+
+int AudioMixer::LoadPcm(const std::int16_t* samples, std::size_t sample_count, int priority)
+{
+	clips_.push_back({ samples, sample_count, {}, priority });
+	pending_.push_back(0);
+
+	return static_cast<int>(clips_.size()) - 1;
+}
+
+void AudioMixer::Play(int clip)
+{
+	if (clip < 0 || clip >= static_cast<int>(clips_.size()))
+	{
+		return;
+	}
+
+	++pending_[clip];
+}
+
+void AudioMixer::Flush()
+{
+	for (std::size_t clip = 0; clip < pending_.size(); ++clip)
+	{
+		const int triggers = pending_[clip];
+
+		if (triggers == 0)
+		{
+			continue;
+		}
+
+		pending_[clip] = 0;
+
+		if (device_ == 0)
+		{
+			continue;
+		}
+
+		// A chain of splits in one tick plays once, a bit louder, instead of stacking identical voices.
+		triggers_coalesced_ += static_cast<std::size_t>(triggers - 1);
+		const float gain = std::min(1.0f + 0.25f * static_cast<float>(triggers - 1), 1.75f);
+
+		const std::size_t head = head_.load(std::memory_order_relaxed);
+
+		if (head - tail_.load(std::memory_order_acquire) == queue_capacity)
+		{
+			++queue_full_;
+			continue;
+		}
+
+		commands_[head % queue_capacity] = { static_cast<int>(clip), gain };
+		head_.store(head + 1, std::memory_order_release);
+	}
+}
+
+void AudioMixer::Callback(void* userdata, Uint8* stream, int length)
+{
+	// Only records into the ring Open reserved, since the callback must not allocate or lock.
+	trace::Zone zone("AudioMixer::Callback", trace::AdoptReserved());
+	AudioMixer* mixer = static_cast<AudioMixer*>(userdata);
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+	const std::uint64_t counter_frequency = SDL_GetPerformanceFrequency();
+	const int frames = length / static_cast<int>(sizeof(std::int16_t) * channels);
+
+	// The device asks for the next buffer once the previous one has played; a much longer gap means it ran dry.
+	if (mixer->last_callback_counter_ != 0)
+	{
+		const double gap = static_cast<double>(start - mixer->last_callback_counter_) / static_cast<double>(counter_frequency);
+		const double period = static_cast<double>(frames) / static_cast<double>(mixer->spec_.freq);
+
+		if (gap > period * 1.5)
+		{
+			mixer->late_callbacks_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	mixer->last_callback_counter_ = start;
+	mixer->Mix(reinterpret_cast<std::int16_t*>(stream), frames);
+
+	const std::uint64_t elapsed_ns = (SDL_GetPerformanceCounter() - start) * 1000000000ull / counter_frequency;
+
+	mixer->callbacks_.fetch_add(1, std::memory_order_relaxed);
+	mixer->callback_ns_total_.fetch_add(elapsed_ns, std::memory_order_relaxed);
+
+	if (elapsed_ns > mixer->callback_ns_max_.load(std::memory_order_relaxed))
+	{
+		mixer->callback_ns_max_.store(elapsed_ns, std::memory_order_relaxed);
+	}
+}
+
+void AudioMixer::Mix(std::int16_t* out, int frames)
+{
+	const std::size_t head = head_.load(std::memory_order_acquire);
+	std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+	for (; tail != head; ++tail)
+	{
+		StartVoice(commands_[tail % queue_capacity]);
+	}
+
+	tail_.store(tail, std::memory_order_release);
+
+	// SDL may ask for more than the buffer Open sized the accumulator for, so the stream is mixed a chunk at a time.
+	const std::size_t samples = static_cast<std::size_t>(frames) * channels;
+
+	for (std::size_t offset = 0; offset < samples; offset += accumulator_.size())
+	{
+		const std::size_t chunk = std::min(samples - offset, accumulator_.size());
+
+		std::fill(accumulator_.begin(), accumulator_.begin() + chunk, 0);
+
+		for (Voice& voice : voices_)
+		{
+			if (voice.clip == nullptr)
+			{
+				continue;
+			}
+
+			const std::size_t count = std::min(chunk, voice.clip->sample_count - voice.position);
+			const std::int16_t* source = voice.clip->samples + voice.position;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				accumulator_[i] += static_cast<std::int32_t>(source[i] * voice.gain);
+			}
+
+			voice.position += count;
+
+			if (voice.position >= voice.clip->sample_count)
+			{
+				voice.clip = nullptr;
+			}
+		}
+
+		for (std::size_t i = 0; i < chunk; ++i)
+		{
+			out[offset + i] = static_cast<std::int16_t>(std::clamp<std::int32_t>(accumulator_[i], INT16_MIN, INT16_MAX));
+		}
+	}
+}
+
+void AudioMixer::StartVoice(const Command& command)
+{
+	const Clip* clip = &clips_[command.clip];
+	Voice* target = nullptr;
+
+	for (Voice& voice : voices_)
+	{
+		if (voice.clip == nullptr)
+		{
+			target = &voice;
+			break;
+		}
+
+		// Otherwise steal the least important voice, preferring the one closest to finishing.
+		if (target == nullptr || voice.priority < target->priority || (voice.priority == target->priority && voice.position > target->position))
+		{
+			target = &voice;
+		}
+	}
+
+	if (target->clip != nullptr)
+	{
+		if (target->priority > clip->priority)
+		{
+			triggers_dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		voices_stolen_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	*target = { clip, 0, command.gain, clip->priority };
+}
+
+void AudioMixer::PrintStats() const
+{
+	const std::uint64_t callbacks = callbacks_.load();
+	const double average_us = callbacks == 0 ? 0.0 : static_cast<double>(callback_ns_total_.load()) / static_cast<double>(callbacks) / 1000.0;
+	const double budget_us = spec_.freq == 0 ? 0.0 : static_cast<double>(spec_.samples) * 1000000.0 / spec_.freq;
+
+	printf("Audio: %d Hz, %d frame buffer (%.2f ms), %llu callbacks, %.1f us avg, %.1f us max, %llu late\n", spec_.freq, spec_.samples, budget_us / 1000.0, static_cast<unsigned long long>(callbacks), average_us, static_cast<double>(callback_ns_max_.load()) / 1000.0, static_cast<unsigned long long>(late_callbacks_.load()));
+	printf("Audio: %zu triggers coalesced, %llu voices stolen, %llu triggers dropped, %zu queue full\n", triggers_coalesced_, static_cast<unsigned long long>(voices_stolen_.load()), static_cast<unsigned long long>(triggers_dropped_.load()), queue_full_);
+}
+
+bool AudioMixer::IsOpen() const
+{
+	return device_ != 0;
+}
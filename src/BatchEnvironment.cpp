@@ -0,0 +1,261 @@
+#include "BatchEnvironment.hpp"
+#include "Game.hpp"
+#include "Asteroid.hpp"
+#include "Player.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+BatchEnvironment::BatchEnvironment(const Options& options, std::size_t instances, std::size_t threads) : 
+	seed_(options.seed.value_or(1)), 
+	generation_(0), 
+	pending_(0), 
+	stopping_(false), 
+	actions_(nullptr), 
+	ships_(instances * batch::ship_features, 0.0f), 
+	asteroids_(instances * batch::observed_asteroids * batch::asteroid_features, 0.0f), 
+	rewards_(instances, 0.0f), 
+	asteroid_counts_(instances, 0), 
+	scores_(instances, 0), 
+	lives_(instances, 0), 
+	done_(instances, 0), 
+	steps_(0)
+{
+	for (std::size_t i = 0; i < instances; ++i)
+	{
+		games_.push_back(std::make_unique<Game>(0));
+		games_.back()->ApplyOptions(options);
+		games_.back()->headless_ = true;
+	}
+
+	threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(instances, 1));
+
+	for (std::size_t i = 0; i < threads; ++i)
+	{
+		shards_.push_back({ instances * i / threads, instances * (i + 1) / threads, {} });
+	}
+
+	Reset();
+
+	for (std::size_t i = 1; i < shards_.size(); ++i)
+	{
+		workers_.emplace_back(&BatchEnvironment::WorkerLoop, this, i);
+	}
+}
+
+BatchEnvironment::~BatchEnvironment()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+
+	start_.notify_all();
+
+	for (std::thread& worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+void BatchEnvironment::Reset()
+{
+	for (std::size_t i = 0; i < games_.size(); ++i)
+	{
+		games_[i]->Reset();
+		games_[i]->Seed(seed_ + i);
+		rewards_[i] = 0.0f;
+		done_[i] = 0;
+	}
+
+	for (Shard& shard : shards_)
+	{
+		for (std::size_t i = shard.begin; i < shard.end; ++i)
+		{
+			Observe(i, &shard);
+		}
+	}
+}
+
+void BatchEnvironment::WorkerLoop(std::size_t shard)
+{
+	std::uint64_t seen = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			start_.wait(lock, [this, seen]()
+			{
+				return stopping_ || generation_ != seen;
+			});
+
+			if (stopping_)
+			{
+				return;
+			}
+
+			seen = generation_;
+		}
+
+		StepShard(&shards_[shard]);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			--pending_;
+		}
+
+		finished_.notify_one();
+	}
+}
+
+void BatchEnvironment::Step(const std::uint8_t* actions)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		actions_ = actions;
+		pending_ = shards_.size() - 1;
+		++generation_;
+	}
+
+	start_.notify_all();
+	StepShard(&shards_[0]);
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	finished_.wait(lock, [this]()
+	{
+		return pending_ == 0;
+	});
+
+	++steps_;
+}
+
+void BatchEnvironment::StepShard(Shard* shard)
+{
+	for (std::size_t i = shard->begin; i < shard->end; ++i)
+	{
+		Game& game = *games_[i];
+
+		if (done_[i] != 0)
+		{
+			game.Reset();
+			done_[i] = 0;
+		}
+
+		const int score = game.score_;
+
+		game.ApplyInput(actions_[i]);
+		game.Tick();
+
+		rewards_[i] = static_cast<float>(game.score_ - score);
+		done_[i] = game.game_over_ ? 1 : 0;
+
+		Observe(i, shard);
+	}
+}
+
+void BatchEnvironment::Observe(std::size_t instance, Shard* shard)
+{
+	const Game& game = *games_[instance];
+	const Player& player = game.GetPlayer();
+	const float width = static_cast<float>(game.world_width_);
+	const float height = static_cast<float>(game.world_height_);
+
+	float* ship = &ships_[instance * batch::ship_features];
+	ship[0] = player.center_.x;
+	ship[1] = player.center_.y;
+	ship[2] = player.velocity_vector_.x;
+	ship[3] = player.velocity_vector_.y;
+	ship[4] = static_cast<float>(player.angle_);
+	ship[5] = player.removed_ || game.game_over_ ? 0.0f : 1.0f;
+
+	shard->nearest.clear();
+
+	for (const std::unique_ptr<Asteroid>& asteroid : game.Asteroids())
+	{
+		if (asteroid->removed_)
+		{
+			continue;
+		}
+
+		float dx = asteroid->center_.x - player.center_.x;
+		float dy = asteroid->center_.y - player.center_.y;
+		dx -= width * std::round(dx / width);
+		dy -= height * std::round(dy / height);
+
+		shard->nearest.emplace_back((dx * dx) + (dy * dy), asteroid.get());
+	}
+
+	const std::size_t count = std::min(shard->nearest.size(), batch::observed_asteroids);
+
+	std::partial_sort(shard->nearest.begin(), shard->nearest.begin() + static_cast<std::ptrdiff_t>(count), shard->nearest.end(), [](const std::pair<float, const Asteroid*>& a, const std::pair<float, const Asteroid*>& b)
+	{
+		return a.first < b.first;
+	});
+
+	float* rows = &asteroids_[instance * batch::observed_asteroids * batch::asteroid_features];
+	std::fill(rows, rows + batch::observed_asteroids * batch::asteroid_features, 0.0f);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const Asteroid& asteroid = *shard->nearest[i].second;
+		float* row = rows + i * batch::asteroid_features;
+
+		row[0] = asteroid.center_.x - player.center_.x;
+		row[1] = asteroid.center_.y - player.center_.y;
+		row[0] -= width * std::round(row[0] / width);
+		row[1] -= height * std::round(row[1] / height);
+		row[2] = asteroid.velocity_vector_.x;
+		row[3] = asteroid.velocity_vector_.y;
+		row[4] = static_cast<float>(std::sqrt(asteroid.furthest_distance_squared_));
+	}
+
+	asteroid_counts_[instance] = static_cast<std::int32_t>(count);
+	scores_[instance] = game.score_;
+	lives_[instance] = player.lives_;
+}
+
+std::size_t BatchEnvironment::Size() const
+{
+	return games_.size();
+}
+
+std::size_t BatchEnvironment::Threads() const
+{
+	return shards_.size();
+}
+
+const float* BatchEnvironment::Ships() const
+{
+	return ships_.data();
+}
+
+const float* BatchEnvironment::Asteroids() const
+{
+	return asteroids_.data();
+}
+
+const std::int32_t* BatchEnvironment::AsteroidCounts() const
+{
+	return asteroid_counts_.data();
+}
+
+const float* BatchEnvironment::Rewards() const
+{
+	return rewards_.data();
+}
+
+const std::int32_t* BatchEnvironment::Scores() const
+{
+	return scores_.data();
+}
+
+const std::int32_t* BatchEnvironment::Lives() const
+{
+	return lives_.data();
+}
+
+const std::uint8_t* BatchEnvironment::Done() const
+{
+	return done_.data();
+}
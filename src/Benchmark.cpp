@@ -0,0 +1,950 @@
+#include "Benchmark.hpp"
+#include "Game.hpp"
+#include "Asteroid.hpp"
+#include "ParticleSystem.hpp"
+#include "Framebuffer.hpp"
+#include "RollbackSession.hpp"
+#include "BatchEnvironment.hpp"
+#include "Replay.hpp"
+#include "StateHash.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	double ElapsedMs(std::uint64_t start, std::uint64_t end)
+	{
+		return static_cast<double>(end - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+
+	std::size_t BruteForceContacts(const Game& game)
+	{
+		const std::list<std::unique_ptr<Asteroid>>& asteroids = game.Asteroids();
+		std::vector<const Asteroid*> live;
+
+		for (const std::unique_ptr<Asteroid>& asteroid : asteroids)
+		{
+			if (!asteroid->removed_)
+			{
+				live.push_back(asteroid.get());
+			}
+		}
+
+		std::size_t contacts = 0;
+
+		for (std::size_t i = 0; i < live.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < live.size(); ++j)
+			{
+				double dx = live[j]->center_.x - live[i]->center_.x;
+				double dy = live[j]->center_.y - live[i]->center_.y;
+
+				dx -= game.world_width_ * std::round(dx / game.world_width_);
+				dy -= game.world_height_ * std::round(dy / game.world_height_);
+
+				const double radii = std::sqrt(live[i]->furthest_distance_squared_) + std::sqrt(live[j]->furthest_distance_squared_);
+
+				if ((dx * dx) + (dy * dy) < radii * radii)
+				{
+					++contacts;
+				}
+			}
+		}
+
+		return contacts;
+	}
+
+	// Buttons held for a third of a second at a time, with the trigger pulled every few ticks.
+	std::uint8_t BotInput(int player, std::uint32_t frame)
+	{
+		std::uint64_t x = (static_cast<std::uint64_t>(player) << 32) ^ (frame / 20) ^ 0x9E3779B97F4A7C15ull;
+		x = (x ^ (x >> 31)) * 0xBF58476D1CE4E5B9ull;
+		x ^= x >> 29;
+
+		const std::uint8_t fire = (frame % 8) < 4 && (x & 0x100) ? input::FIRE : 0;
+
+		return static_cast<std::uint8_t>((x & (input::LEFT | input::RIGHT | input::THRUST)) | fire);
+	}
+
+	// Held buttons change every 600 ms and the trigger is pulled every 200 ms, a whole number of ticks at every rate
+	// the tick rate benchmark runs, so each rate sees the same input at the same simulated time.
+	std::uint8_t ScriptedInput(std::uint64_t ms)
+	{
+		std::uint64_t x = (ms / 600) ^ 0x9E3779B97F4A7C15ull;
+		x = (x ^ (x >> 31)) * 0xBF58476D1CE4E5B9ull;
+		x ^= x >> 29;
+
+		const std::uint8_t fire = (ms % 200) < 100 ? input::FIRE : 0;
+
+		return static_cast<std::uint8_t>((x & (input::LEFT | input::RIGHT | input::THRUST)) | fire);
+	}
+
+	double WrappedDistance(const SDL_FPoint& a, const SDL_FPoint& b, double width, double height)
+	{
+		double dx = b.x - a.x;
+		double dy = b.y - a.y;
+
+		dx -= width * std::round(dx / width);
+		dy -= height * std::round(dy / height);
+
+		return std::sqrt((dx * dx) + (dy * dy));
+	}
+
+	struct TickRateRun
+	{
+		std::uint64_t ticks = 0;
+		double cpu_ms = 0.0;
+		// The ship's position every track_interval_ms of simulated time, up to its first collision.
+		std::vector<SDL_FPoint> ship_track;
+		// Asteroids of the starting field that are still alive at the end, by id.
+		std::map<std::uint32_t, SDL_FPoint> field;
+		int score = 0;
+		int lives = 0;
+		std::size_t asteroids = 0;
+		double world_width = 0.0;
+		double world_height = 0.0;
+	};
+
+	constexpr std::uint64_t track_interval_ms = 100;
+
+	TickRateRun SimulateAtRate(const Options& options, int tick_rate, double seconds, int asteroid_count)
+	{
+		Options run_options = options;
+		run_options.tick_rate = tick_rate;
+		run_options.world_scale = std::max(options.world_scale, 6.0);
+
+		std::unique_ptr<Game> game = std::make_unique<Game>();
+		game->ApplyOptions(run_options);
+		game->headless_ = true;
+		game->Seed(options.seed.value_or(1));
+		game->ClearAsteroids();
+
+		// Drawn from the game's generator in the same order at every rate, and kept clear of the ship's start.
+		const SDL_FPoint start = game->GetPlayer().center_;
+		std::uniform_real_distribution<double> random_velocity{ -constants::wave_speed, constants::wave_speed };
+
+		for (int i = 0; i < asteroid_count; ++i)
+		{
+			double x = 0.0;
+			double y = 0.0;
+
+			do
+			{
+				x = game->random_x_(game->mt_);
+				y = game->random_y_(game->mt_);
+			}
+			while (std::fabs(x - start.x) < 500.0 && std::fabs(y - start.y) < 500.0);
+
+			const double vx = random_velocity(game->mt_);
+			const double vy = random_velocity(game->mt_);
+
+			game->AddAsteroid(std::make_unique<Asteroid>(game.get(), static_cast<AsteroidType>(i % 3), x, y, vx, vy));
+		}
+
+		const std::uint32_t field_end = game->next_entity_id_;
+		const int lives = game->GetPlayer().lives_;
+
+		TickRateRun run;
+		run.ticks = static_cast<std::uint64_t>(seconds * tick_rate);
+		run.world_width = game->world_width_;
+		run.world_height = game->world_height_;
+
+		for (std::uint64_t tick = 0; tick < run.ticks; ++tick)
+		{
+			const std::uint64_t ms = tick * 1000 / static_cast<std::uint64_t>(tick_rate);
+
+			const Player& player = game->GetPlayer();
+
+			if ((tick * 1000) % static_cast<std::uint64_t>(tick_rate) == 0 && ms % track_interval_ms == 0 && !player.removed_ && player.lives_ == lives)
+			{
+				run.ship_track.push_back(game->GetPlayer().center_);
+			}
+
+			game->ApplyInput(ScriptedInput(ms));
+
+			const std::uint64_t tick_start = SDL_GetPerformanceCounter();
+			game->Tick();
+			run.cpu_ms += ElapsedMs(tick_start, SDL_GetPerformanceCounter());
+		}
+
+		for (const std::unique_ptr<Asteroid>& asteroid : game->Asteroids())
+		{
+			if (!asteroid->removed_ && asteroid->id_ < field_end)
+			{
+				run.field.emplace(asteroid->id_, asteroid->center_);
+			}
+		}
+
+		run.score = game->score_;
+		run.lives = game->GetPlayer().lives_;
+		run.asteroids = game->Asteroids().size();
+
+		return run;
+	}
+} // namespace
+
+namespace benchmark
+{
+	int Run(const Options& options)
+	{
+		if (options.benchmark == "broadphase")
+		{
+			return RunBroadphase(options);
+		}
+
+		if (options.benchmark == "particles")
+		{
+			return RunParticles(options);
+		}
+
+		if (options.benchmark == "snapshot")
+		{
+			return RunSnapshot(options);
+		}
+
+		if (options.benchmark == "rollback")
+		{
+			return RunRollback(options);
+		}
+
+		if (options.benchmark == "batch")
+		{
+			return RunBatch(options);
+		}
+
+		if (options.benchmark == "tickrate")
+		{
+			return RunTickRate(options);
+		}
+
+		if (options.benchmark == "replay")
+		{
+			return RunReplay(options);
+		}
+
+		if (options.benchmark == "render")
+		{
+			return RunRender(options);
+		}
+
+		printf("Unknown benchmark: %s\n", options.benchmark.c_str());
+		return 1;
+	}
+
+	int RunBroadphase(const Options& options)
+	{
+		constexpr int asteroid_counts[] = { 250, 500, 1000, 2000, 3000, 4000 };
+		constexpr int warmup_ticks = 60;
+		constexpr int measured_ticks = 600;
+		constexpr double tick_budget_ms = 1000.0 / 60.0;
+
+		bool passed = true;
+
+		printf("Broadphase benchmark: %d ticks per run, small asteroids, world scale %.1f, %.1f ms tick budget\n", measured_ticks, options.world_scale, tick_budget_ms);
+		printf("%10s %12s %12s %11s %11s %9s %9s %10s %10s\n", "asteroids", "avg tick ms", "max tick ms", "collide ms", "candidates", "contacts", "swaps", "brute ms", "check");
+
+		for (const int count : asteroid_counts)
+		{
+			std::unique_ptr<Game> game = std::make_unique<Game>();
+			game->ApplyOptions(options);
+			game->headless_ = true;
+			game->asteroid_collisions_ = true;
+			game->mt_.seed(count);
+			game->ClearAsteroids();
+
+			std::uniform_real_distribution<double> random_velocity{ -constants::wave_speed, constants::wave_speed };
+
+			for (int i = 0; i < count; ++i)
+			{
+				game->AddAsteroid(std::make_unique<Asteroid>(game.get(), AsteroidType::SMALL, game->random_x_(game->mt_), game->random_y_(game->mt_), random_velocity(game->mt_), random_velocity(game->mt_)));
+			}
+
+			for (int i = 0; i < warmup_ticks; ++i)
+			{
+				game->Tick();
+			}
+
+			double total_ms = 0.0;
+			double max_ms = 0.0;
+
+			for (int i = 0; i < measured_ticks; ++i)
+			{
+				const std::uint64_t start = SDL_GetPerformanceCounter();
+				game->Tick();
+				const double tick_ms = ElapsedMs(start, SDL_GetPerformanceCounter());
+
+				total_ms += tick_ms;
+				max_ms = std::max(max_ms, tick_ms);
+			}
+
+			const std::uint64_t brute_start = SDL_GetPerformanceCounter();
+			const std::size_t brute_contacts = BruteForceContacts(*game);
+			const double brute_ms = ElapsedMs(brute_start, SDL_GetPerformanceCounter());
+
+			const std::uint64_t collide_start = SDL_GetPerformanceCounter();
+			game->HandleAsteroidCollisions();
+			const double collide_ms = ElapsedMs(collide_start, SDL_GetPerformanceCounter());
+
+			const SweepAndPrune& broadphase = game->Broadphase();
+			const bool matches = broadphase.Pairs().size() == brute_contacts;
+			const double avg_ms = total_ms / measured_ticks;
+
+			passed = passed && matches;
+
+			printf("%10d %12.3f %12.3f %11.3f %11zu %9zu %9zu %10.3f %10s\n", count, avg_ms, max_ms, collide_ms, broadphase.candidates_, broadphase.Pairs().size(), broadphase.swaps_, brute_ms, matches ? (avg_ms < tick_budget_ms ? "ok" : "over") : "MISMATCH");
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int RunParticles(const Options& options)
+	{
+		constexpr int particle_counts[] = { 10000, 50000, 100000 };
+		constexpr int warmup_ticks = 60;
+		constexpr int measured_ticks = 600;
+		constexpr float lifetime = 1.0f;
+		constexpr double tick_budget_ms = 1000.0 / constants::ticks_per_second;
+		constexpr float dt = 1.0f / constants::ticks_per_second;
+
+		const float world_width = static_cast<float>(constants::screen_width * options.world_scale);
+		const float world_height = static_cast<float>(constants::screen_height * options.world_scale);
+
+		bool passed = true;
+
+		printf("Particle benchmark: %d ticks per run, %.1f s lifetime, %.1f ms tick budget\n", measured_ticks, lifetime, tick_budget_ms);
+		printf("%10s %8s %12s %12s %14s %12s %10s\n", "particles", "update", "avg tick ms", "max tick ms", "ns / particle", "build ms", "check");
+
+		for (const int count : particle_counts)
+		{
+			for (const bool use_simd : { false, true })
+			{
+				ParticleSystem particles(count, world_width, world_height);
+				particles.use_simd_ = use_simd;
+
+				// Emitting count / (lifetime * ticks_per_second) * 2 particles per tick keeps the pool close to full.
+				const int per_tick = count * 2 / static_cast<int>(lifetime * constants::ticks_per_second);
+				std::mt19937 mt(static_cast<std::uint32_t>(count));
+				std::uniform_real_distribution<float> random_x{ 0.0f, world_width };
+				std::uniform_real_distribution<float> random_y{ 0.0f, world_height };
+
+				for (int i = 0; i < warmup_ticks; ++i)
+				{
+					particles.Emit(random_x(mt), random_y(mt), 0.0f, 0.0f, per_tick, 200.0f, lifetime);
+					particles.Update(dt);
+				}
+
+				double total_ms = 0.0;
+				double max_ms = 0.0;
+				std::size_t updated = 0;
+
+				for (int i = 0; i < measured_ticks; ++i)
+				{
+					particles.Emit(random_x(mt), random_y(mt), 0.0f, 0.0f, per_tick, 200.0f, lifetime);
+					updated += particles.Count();
+
+					const std::uint64_t start = SDL_GetPerformanceCounter();
+					particles.Update(dt);
+					const double tick_ms = ElapsedMs(start, SDL_GetPerformanceCounter());
+
+					total_ms += tick_ms;
+					max_ms = std::max(max_ms, tick_ms);
+				}
+
+				Framebuffer framebuffer(constants::screen_width, constants::screen_height);
+
+				const std::uint64_t build_start = SDL_GetPerformanceCounter();
+				particles.Render(&framebuffer, 0.0f, 0.0f);
+				const double build_ms = ElapsedMs(build_start, SDL_GetPerformanceCounter());
+
+				const double avg_ms = total_ms / measured_ticks;
+				const double ns_per_particle = total_ms * 1e6 / std::max<std::size_t>(updated, 1);
+				const bool within_budget = avg_ms + build_ms < tick_budget_ms;
+
+				passed = passed && (use_simd ? within_budget : true);
+
+				printf("%10zu %8s %12.3f %12.3f %14.2f %12.3f %10s\n", particles.Count(), use_simd ? "simd" : "scalar", avg_ms, max_ms, ns_per_particle, build_ms, within_budget ? "ok" : "over");
+			}
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int RunSnapshot(const Options& options)
+	{
+		constexpr int entity_counts[] = { 10, 1000, 100000 };
+		constexpr int ticks_between = 30;
+
+		bool passed = true;
+
+		printf("Snapshot benchmark: 3/4 asteroids, 1/4 bullets; round trip checked by replaying %d ticks from a restored state\n", ticks_between);
+		printf("%10s %12s %12s %12s %12s %12s %10s\n", "entities", "bytes", "bytes/entity", "save us", "restore us", "MB/s", "check");
+
+		for (const int count : entity_counts)
+		{
+			std::unique_ptr<Game> game = std::make_unique<Game>();
+			game->ApplyOptions(options);
+			game->headless_ = true;
+			game->mt_.seed(count);
+			game->ClearAsteroids();
+
+			std::uniform_real_distribution<double> random_velocity{ -constants::wave_speed, constants::wave_speed };
+			const int asteroid_count = std::max(count * 3 / 4, 1);
+
+			for (int i = 0; i < asteroid_count; ++i)
+			{
+				game->AddAsteroid(std::make_unique<Asteroid>(game.get(), static_cast<AsteroidType>(i % 3), game->random_x_(game->mt_), game->random_y_(game->mt_), random_velocity(game->mt_), random_velocity(game->mt_)));
+			}
+
+			for (int i = asteroid_count; i < count; ++i)
+			{
+				game->AddBullet(game->random_x_(game->mt_), game->random_y_(game->mt_), random_velocity(game->mt_) * 4.0, random_velocity(game->mt_) * 4.0);
+			}
+
+			std::vector<std::uint8_t> start;
+			std::vector<std::uint8_t> first_run;
+			std::vector<std::uint8_t> second_run;
+
+			game->SaveSnapshot(&start);
+
+			for (int i = 0; i < ticks_between; ++i)
+			{
+				game->Tick();
+			}
+
+			game->SaveSnapshot(&first_run);
+			const bool restored = game->RestoreSnapshot(start.data(), start.size());
+
+			for (int i = 0; i < ticks_between; ++i)
+			{
+				game->Tick();
+			}
+
+			game->SaveSnapshot(&second_run);
+			game->RestoreSnapshot(start.data(), start.size());
+
+			// Timed on the same buffers, so both directions run in the steady state without allocating.
+			const int iterations = std::max(20, 200000 / count);
+			std::vector<std::uint8_t> buffer;
+			game->SaveSnapshot(&buffer);
+
+			const std::uint64_t save_start = SDL_GetPerformanceCounter();
+
+			for (int i = 0; i < iterations; ++i)
+			{
+				game->SaveSnapshot(&buffer);
+			}
+
+			const double save_us = ElapsedMs(save_start, SDL_GetPerformanceCounter()) * 1000.0 / iterations;
+			const std::uint64_t restore_start = SDL_GetPerformanceCounter();
+
+			for (int i = 0; i < iterations; ++i)
+			{
+				game->RestoreSnapshot(buffer.data(), buffer.size());
+			}
+
+			const double restore_us = ElapsedMs(restore_start, SDL_GetPerformanceCounter()) * 1000.0 / iterations;
+			const bool matches = restored && first_run == second_run;
+			const double megabytes_per_second = static_cast<double>(buffer.size()) / (save_us + restore_us) * 2.0;
+
+			passed = passed && matches;
+
+			printf("%10d %12zu %12.1f %12.2f %12.2f %12.1f %10s\n", count, buffer.size(), static_cast<double>(buffer.size()) / count, save_us, restore_us, megabytes_per_second, matches ? "ok" : "MISMATCH");
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int RunRollback(const Options& options)
+	{
+		struct Link
+		{
+			const char* name;
+			net::LinkConditions conditions;
+		};
+
+		const Link links[] = { { "loopback", { 0.0, 0.0, 0.0 } }, { "20+-5 ms", { 20.0, 5.0, 0.0 } }, { "50+-15 ms 2%", { 50.0, 15.0, 0.02 } }, { "80+-25 ms 5%", { 80.0, 25.0, 0.05 } } };
+		constexpr std::uint32_t frames = 1200;
+		constexpr double tick_seconds = 1.0 / constants::ticks_per_second;
+
+		bool passed = true;
+
+		printf("Rollback benchmark: two peers on loopback ports %u and %u, %u ticks of bot input, %d tick window, simulated time\n", options.port, options.port + 1, frames, options.rollback_window);
+		printf("%14s %8s %12s %10s %10s %12s %10s %14s %14s %10s\n", "link", "stalls", "mispredicted", "rollbacks", "resim", "avg depth", "max depth", "ms / rollback", "max ms", "check");
+
+		for (const Link& link : links)
+		{
+			std::unique_ptr<Game> games[2];
+			std::unique_ptr<net::RollbackSession> sessions[2];
+			bool opened = true;
+
+			for (int player = 0; player < 2; ++player)
+			{
+				games[player] = std::make_unique<Game>();
+				games[player]->ApplyOptions(options);
+				games[player]->headless_ = true;
+				games[player]->Seed(options.seed.value_or(1));
+				games[player]->local_player_ = false;
+				games[player]->AddRemotePlayer();
+				games[player]->AddRemotePlayer();
+
+				sessions[player] = std::make_unique<net::RollbackSession>(games[player].get(), player, options.rollback_window);
+				opened = opened && sessions[player]->Open(static_cast<std::uint16_t>(options.port + player), "127.0.0.1", static_cast<std::uint16_t>(options.port + 1 - player), link.conditions, static_cast<std::uint32_t>(player + 1));
+			}
+
+			if (!opened)
+			{
+				return 1;
+			}
+
+			// Both peers share one simulated clock, so the run is fast and the delays are exact.
+			std::uint32_t step = 0;
+			const std::uint32_t step_limit = frames * 8;
+
+			while ((sessions[0]->CurrentFrame() < frames || sessions[1]->CurrentFrame() < frames || sessions[0]->ConfirmedFrames() < frames || sessions[1]->ConfirmedFrames() < frames) && step < step_limit)
+			{
+				const double now = step * tick_seconds;
+
+				for (int player = 0; player < 2; ++player)
+				{
+					const std::uint32_t frame = sessions[player]->CurrentFrame();
+
+					if (frame < frames)
+					{
+						sessions[player]->AdvanceFrame(BotInput(player, frame), now);
+					}
+					else
+					{
+						sessions[player]->Poll(now);
+					}
+				}
+
+				++step;
+			}
+
+			std::vector<std::uint8_t> states[2];
+			games[0]->SaveSnapshot(&states[0]);
+			games[1]->SaveSnapshot(&states[1]);
+
+			const bool matches = step < step_limit && states[0] == states[1];
+			const net::RollbackStats& stats = sessions[0]->stats_;
+
+			passed = passed && matches;
+
+			printf("%14s %8zu %12zu %10zu %10zu %12.2f %10zu %14.3f %14.3f %10s\n", link.name, stats.stalls, stats.mispredictions, stats.rollbacks, stats.resimulated_ticks,
+				static_cast<double>(stats.resimulated_ticks) / std::max<std::size_t>(stats.rollbacks, 1), stats.max_depth,
+				stats.resimulate_ms_total / std::max<std::size_t>(stats.rollbacks, 1), stats.resimulate_ms_max, matches ? "ok" : "DIVERGED");
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int RunBatch(const Options& options)
+	{
+		constexpr int warmup_steps = 30;
+		constexpr int measured_steps = 300;
+
+		const std::size_t instances = static_cast<std::size_t>(options.batch_size);
+		const int max_threads = options.threads > 0 ? options.threads : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+		std::vector<int> thread_counts;
+
+		for (int threads = 1; threads < max_threads; threads *= 2)
+		{
+			thread_counts.push_back(threads);
+		}
+
+		thread_counts.push_back(max_threads);
+
+		// The same actions for every thread count, so every run must end in the same observations.
+		std::vector<std::uint8_t> actions(instances * (warmup_steps + measured_steps));
+
+		for (std::size_t i = 0; i < actions.size(); ++i)
+		{
+			actions[i] = BotInput(static_cast<int>(i % instances), static_cast<std::uint32_t>(i / instances));
+		}
+
+		bool passed = true;
+		double single_thread_rate = 0.0;
+		std::vector<float> reference;
+
+		printf("Batch benchmark: %zu games, %d steps, %zu nearest asteroids observed\n", instances, measured_steps, batch::observed_asteroids);
+		printf("%8s %12s %14s %10s %11s %10s %10s\n", "threads", "ms / step", "ticks / s", "speedup", "efficiency", "episodes", "check");
+
+		for (const int threads : thread_counts)
+		{
+			BatchEnvironment environment(options, instances, static_cast<std::size_t>(threads));
+			std::size_t episodes = 0;
+
+			for (int step = 0; step < warmup_steps; ++step)
+			{
+				environment.Step(&actions[step * instances]);
+			}
+
+			const std::uint64_t start = SDL_GetPerformanceCounter();
+
+			for (int step = warmup_steps; step < warmup_steps + measured_steps; ++step)
+			{
+				environment.Step(&actions[step * instances]);
+				episodes += static_cast<std::size_t>(std::count(environment.Done(), environment.Done() + instances, 1));
+			}
+
+			const double total_ms = ElapsedMs(start, SDL_GetPerformanceCounter());
+			const double rate = static_cast<double>(instances) * measured_steps * 1000.0 / total_ms;
+
+			std::vector<float> observations(environment.Ships(), environment.Ships() + instances * batch::ship_features);
+			observations.insert(observations.end(), environment.Asteroids(), environment.Asteroids() + instances * batch::observed_asteroids * batch::asteroid_features);
+
+			if (reference.empty())
+			{
+				reference = observations;
+				single_thread_rate = rate;
+			}
+
+			const bool matches = observations == reference;
+			passed = passed && matches;
+
+			printf("%8d %12.3f %14.0f %10.2f %10.0f%% %10zu %10s\n", threads, total_ms / measured_steps, rate, rate / single_thread_rate, rate / single_thread_rate / threads * 100.0, episodes, matches ? "ok" : "MISMATCH");
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int RunTickRate(const Options& options)
+	{
+		constexpr int tick_rates[] = { 30, 60, 120, 240 };
+		constexpr double seconds = 20.0;
+		constexpr int asteroid_count = 300;
+
+		// Asteroids drift in straight lines, so only the rounding of their float positions may separate the rates. The
+		// ship integrates thrust once a tick, so its path converges on the fastest rate as the rate goes up but never matches.
+		constexpr double field_tolerance = 1.0;
+
+		std::vector<TickRateRun> runs;
+
+		for (const int tick_rate : tick_rates)
+		{
+			runs.push_back(SimulateAtRate(options, tick_rate, seconds, asteroid_count));
+		}
+
+		const TickRateRun& reference = runs.back();
+		bool passed = true;
+
+		printf("Tick rate benchmark: %d asteroids and a scripted ship for %.0f simulated seconds, compared against %d Hz\n", asteroid_count, seconds, tick_rates[std::size(tick_rates) - 1]);
+		printf("%6s %8s %10s %12s %10s %8s %12s %12s %12s %7s %6s %10s %7s\n", "rate", "ticks", "cpu ms", "ms / sim s", "us / tick", "flown s", "ship mean px", "ship max px", "field px", "score", "lives", "asteroids", "check");
+
+		for (std::size_t i = 0; i < runs.size(); ++i)
+		{
+			const TickRateRun& run = runs[i];
+
+			// A collision resets the ship, so its path is only compared for as long as it flew untouched at both rates.
+			double ship_sum = 0.0;
+			double ship_max = 0.0;
+			const std::size_t samples = std::min(run.ship_track.size(), reference.ship_track.size());
+
+			for (std::size_t sample = 0; sample < samples; ++sample)
+			{
+				const double distance = WrappedDistance(run.ship_track[sample], reference.ship_track[sample], run.world_width, run.world_height);
+				ship_sum += distance;
+				ship_max = std::max(ship_max, distance);
+			}
+
+			// Only asteroids that survived in both runs are compared; ones shot apart are counted in the score.
+			double field_sum = 0.0;
+			std::size_t field_matched = 0;
+
+			for (const auto& [id, position] : run.field)
+			{
+				const auto match = reference.field.find(id);
+
+				if (match != reference.field.end())
+				{
+					field_sum += WrappedDistance(position, match->second, run.world_width, run.world_height);
+					++field_matched;
+				}
+			}
+
+			const double field_mean = field_matched != 0 ? field_sum / static_cast<double>(field_matched) : 0.0;
+			const bool within = field_mean < field_tolerance;
+
+			passed = passed && within;
+
+			printf("%6d %8llu %10.1f %12.2f %10.2f %8.1f %12.2f %12.2f %12.3f %7d %6d %10zu %7s\n", tick_rates[i], static_cast<unsigned long long>(run.ticks), run.cpu_ms, run.cpu_ms / seconds, run.cpu_ms * 1000.0 / static_cast<double>(run.ticks), static_cast<double>(samples * track_interval_ms) / 1000.0, samples != 0 ? ship_sum / static_cast<double>(samples) : 0.0, ship_max, field_mean, run.score, run.lives, run.asteroids, within ? "ok" : "DRIFT");
+		}
+
+		// The comparison above only holds the rates to each other; at 60 Hz the constants must also give back the
+		// per-tick values the game was tuned with when it stepped once a frame.
+		struct LegacyValue
+		{
+			const char* name;
+			double per_tick;
+			double legacy;
+		};
+
+		constexpr double legacy_rate = 60.0;
+		const int bullet_ticks = std::max(static_cast<int>(std::lround(constants::bullet_lifetime * legacy_rate)), 1);
+
+		const LegacyValue legacy_values[] = {
+			{ "ship thrust px/tick^2", constants::ship_thrust / (legacy_rate * legacy_rate), 0.2 },
+			{ "ship max speed px/tick", constants::ship_max_speed / legacy_rate, 5.0 },
+			{ "ship turn deg/tick", constants::ship_turn_rate / legacy_rate, 5.0 },
+			{ "bullet speed px/tick", constants::bullet_speed / legacy_rate, 30.0 },
+			{ "bullet lifetime ticks", static_cast<double>(bullet_ticks), 30.0 },
+			{ "bullet range px", constants::bullet_speed / legacy_rate * bullet_ticks, 900.0 },
+			{ "asteroid spin deg/tick", constants::asteroid_spin / legacy_rate, -1.0 },
+			{ "wave speed px/tick", constants::wave_speed / legacy_rate, 2.0 },
+			{ "split speed px/tick", constants::split_speed / legacy_rate, 5.0 },
+		};
+
+		printf("\nPer-tick values at %.0f Hz against the fixed-step game\n", legacy_rate);
+		printf("%24s %10s %10s %7s\n", "value", "now", "legacy", "check");
+
+		for (const LegacyValue& value : legacy_values)
+		{
+			const bool matches = std::abs(value.per_tick - value.legacy) < 1e-6;
+			passed = passed && matches;
+
+			printf("%24s %10.3f %10.3f %7s\n", value.name, value.per_tick, value.legacy, matches ? "ok" : "CHANGED");
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int RunReplay(const Options& options)
+	{
+		constexpr double minutes = 10.0;
+		constexpr int seeks = 200;
+		constexpr double seek_budget_ms = 1000.0;
+
+		char path[] = "/tmp/asteroids-replay-XXXXXX";
+		const int descriptor = mkstemp(path);
+
+		if (descriptor < 0)
+		{
+			printf("Unable to create a temporary replay file\n");
+			return 1;
+		}
+
+		close(descriptor);
+
+		Options record_options = options;
+		record_options.record_path = path;
+		record_options.replay_path.clear();
+		record_options.governor.clear();
+		record_options.spawn_budget_us = 0.0;
+
+		std::unique_ptr<Game> recorder = std::make_unique<Game>();
+		recorder->ApplyOptions(record_options);
+		recorder->headless_ = true;
+		recorder->Seed(options.seed.value_or(1));
+
+		if (!recorder->StartReplay())
+		{
+			unlink(path);
+			return 1;
+		}
+
+		const int tick_rate = recorder->tick_rate_;
+		const std::uint64_t first_tick = recorder->ticks_;
+		const std::uint64_t ticks = static_cast<std::uint64_t>(minutes * 60.0 * tick_rate);
+
+		// The state every seek should land on: the start of each tick with its input applied, and the end of the run.
+		std::vector<StateHash::Digest> digests;
+		digests.reserve(ticks + 1);
+		double record_ms = 0.0;
+
+		for (std::uint64_t tick = 0; tick < ticks; ++tick)
+		{
+			// The bot restarts after game over, as a player pressing 'r' would.
+			if (recorder->game_over_)
+			{
+				recorder->reset_game_ = true;
+			}
+
+			recorder->ApplyInput(BotInput(0, static_cast<std::uint32_t>(tick)));
+			digests.push_back(StateHash::Compute(*recorder));
+
+			const std::uint64_t tick_start = SDL_GetPerformanceCounter();
+			recorder->Tick();
+			record_ms += ElapsedMs(tick_start, SDL_GetPerformanceCounter());
+		}
+
+		digests.push_back(StateHash::Compute(*recorder));
+		const int score = recorder->score_;
+		const std::size_t asteroids = recorder->Asteroids().size();
+
+		// Closes the replay and writes its index.
+		recorder.reset();
+
+		struct stat file_stat;
+		const double file_kb = stat(path, &file_stat) == 0 ? static_cast<double>(file_stat.st_size) / 1024.0 : 0.0;
+
+		Options play_options = options;
+		play_options.governor.clear();
+		play_options.spawn_budget_us = 0.0;
+
+		std::unique_ptr<Game> game = std::make_unique<Game>();
+		game->ApplyOptions(play_options);
+		game->headless_ = true;
+
+		ReplayReader reader;
+
+		if (!reader.Open(path))
+		{
+			unlink(path);
+			return 1;
+		}
+
+		// Played from the first keyframe to the end, as a viewer watching the whole game would.
+		const std::uint64_t playback_start = SDL_GetPerformanceCounter();
+		bool matches = reader.Seek(game.get(), first_tick);
+
+		while (reader.Step(game.get()))
+		{
+		}
+
+		const double playback_ms = ElapsedMs(playback_start, SDL_GetPerformanceCounter());
+		matches = matches && StateHash::Compute(*game) == digests.back();
+
+		std::mt19937_64 random(options.seed.value_or(1));
+		std::uniform_int_distribution<std::uint64_t> random_tick(0, ticks);
+		std::vector<double> seek_ms;
+		int mismatches = 0;
+
+		for (int i = 0; i < seeks; ++i)
+		{
+			const std::uint64_t target = random_tick(random);
+			const std::uint64_t seek_start = SDL_GetPerformanceCounter();
+
+			reader.Seek(game.get(), first_tick + target);
+
+			seek_ms.push_back(ElapsedMs(seek_start, SDL_GetPerformanceCounter()));
+
+			if (game->ticks_ != first_tick + target || StateHash::Compute(*game) != digests[target])
+			{
+				++mismatches;
+			}
+		}
+
+		reader.Close();
+		unlink(path);
+
+		std::sort(seek_ms.begin(), seek_ms.end());
+
+		const double p50 = seek_ms[seek_ms.size() / 2];
+		const double p99 = seek_ms[seek_ms.size() * 99 / 100];
+		const double max = seek_ms.back();
+		const bool passed = matches && mismatches == 0 && max < seek_budget_ms;
+
+		printf("Replay benchmark: %.0f simulated minutes of bot play at %d Hz, a keyframe every %.1f s, score %d, %zu asteroids at the end\n", minutes, tick_rate, options.keyframe_seconds, score, asteroids);
+		printf("  record    %10.1f ms for %llu ticks, %.2f us per tick with keyframes and input\n", record_ms, static_cast<unsigned long long>(ticks), record_ms * 1000.0 / static_cast<double>(ticks));
+		printf("  file      %10.1f KB, %.1f bytes per simulated second\n", file_kb, file_kb * 1024.0 / (minutes * 60.0));
+		printf("  playback  %10.1f ms, %.0fx real time, end state %s\n", playback_ms, minutes * 60000.0 / playback_ms, matches ? "matches" : "DIFFERS");
+		printf("  seek      %d random ticks: p50 %.2f ms, p99 %.2f ms, max %.2f ms against %.0f ms, %d of them off the recorded state\n", seeks, p50, p99, max, seek_budget_ms, mismatches);
+		printf("  check     %s\n", passed ? "ok" : "FAILED");
+
+		return passed ? 0 : 1;
+	}
+
+	int RunRender(const Options& options)
+	{
+		struct Load
+		{
+			int asteroids;
+			int bullets;
+		};
+
+		constexpr Load loads[] = { { 0, 0 }, { 100, 25 }, { 1000, 250 }, { 5000, 1250 }, { 20000, 5000 } };
+		constexpr int warmup_frames = 10;
+
+		// No display or GPU is needed: SDL's dummy video driver hands the software renderer a window surface in
+		// memory. Both stay overridable from the environment, e.g. SDL_VIDEODRIVER=offscreen or SDL_RENDER_DRIVER=opengl.
+		setenv("SDL_VIDEODRIVER", "dummy", 0);
+		setenv("SDL_AUDIODRIVER", "dummy", 0);
+		SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+
+		bool printed_header = false;
+
+		for (const Load& load : loads)
+		{
+			std::unique_ptr<Game> game = std::make_unique<Game>();
+			game->ApplyOptions(options);
+
+			if (!game->Initialize())
+			{
+				printf("Render benchmark: could not create a window and renderer\n");
+				return 1;
+			}
+
+			if (!printed_header)
+			{
+				SDL_RendererInfo info;
+				SDL_GetRendererInfo(game->Renderer(), &info);
+
+				printf("Render benchmark: Game::Render on the %s video driver with the %s renderer, %s path, %.0fx%.0f world, no particles\n", SDL_GetCurrentVideoDriver(), info.name, options.render_path == RenderPath::SPRITES ? "sprite" : "line", game->world_width_, game->world_height_);
+				printf("%10s %10s %8s %12s %12s %12s %12s %14s\n", "asteroids", "bullets", "frames", "ms / frame", "max ms", "present ms", "draw calls", "us / draw call");
+				printed_header = true;
+			}
+
+			game->mt_.seed(static_cast<std::uint64_t>(load.asteroids) + 1);
+			game->ClearAsteroids();
+
+			std::uniform_real_distribution<double> random_velocity{ -constants::wave_speed, constants::wave_speed };
+
+			for (int i = 0; i < load.asteroids; ++i)
+			{
+				game->AddAsteroid(std::make_unique<Asteroid>(game.get(), static_cast<AsteroidType>(i % 3), game->random_x_(game->mt_), game->random_y_(game->mt_), random_velocity(game->mt_), random_velocity(game->mt_)));
+			}
+
+			for (int i = 0; i < load.bullets; ++i)
+			{
+				game->AddBullet(game->random_x_(game->mt_), game->random_y_(game->mt_), random_velocity(game->mt_) * 4.0, random_velocity(game->mt_) * 4.0);
+			}
+
+			// Nothing moves between frames, so every frame draws the same scene and only the render path is timed.
+			const int frames = std::clamp(100000 / (load.asteroids + load.bullets + 100), 30, 300);
+
+			for (int i = 0; i < warmup_frames; ++i)
+			{
+				game->Render();
+			}
+
+			double total_ms = 0.0;
+			double max_ms = 0.0;
+			double present_ms = 0.0;
+			std::uint64_t draw_calls = 0;
+
+			for (int i = 0; i < frames; ++i)
+			{
+				const std::uint64_t frame_start = SDL_GetPerformanceCounter();
+				game->Render();
+				const double frame_ms = ElapsedMs(frame_start, SDL_GetPerformanceCounter());
+
+				total_ms += frame_ms;
+				max_ms = std::max(max_ms, frame_ms);
+				present_ms += game->PresentMs();
+				draw_calls += static_cast<std::uint64_t>(game->DrawCalls());
+			}
+
+			const double frame_ms = total_ms / frames;
+			const double calls = static_cast<double>(draw_calls) / frames;
+
+			printf("%10d %10d %8d %12.3f %12.3f %12.3f %12.0f %14.3f\n", load.asteroids, load.bullets, frames, frame_ms, max_ms, present_ms / frames, calls, calls > 0.0 ? frame_ms * 1000.0 / calls : 0.0);
+		}
+
+		return 0;
+	}
+} // namespace benchmark
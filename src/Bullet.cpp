@@ -4,9 +4,11 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-Bullet::Bullet(Game* game, double x, double y, double vx, double vy) : game_(game), removed_(false), lifetime_(30)
+Bullet::Bullet(Game* game, double x, double y, double vx, double vy) : game_(game), removed_(false), lifetime_(std::max(static_cast<int>(std::lround(constants::bullet_lifetime * game->tick_rate_)), 1))
 {
 	constexpr double bullet_size = 4.0;
 
@@ -26,33 +28,35 @@ void Bullet::Tick()
 		removed_ = true;
 	}
 
-	geometry_.x += velocity_vector_.x;
-	geometry_.y += velocity_vector_.y;
+	geometry_.x += static_cast<float>(velocity_vector_.x * game_->tick_seconds_);
+	geometry_.y += static_cast<float>(velocity_vector_.y * game_->tick_seconds_);
 
-	if (geometry_.x > constants::screen_width)
+	if (geometry_.x > game_->world_width_)
 	{
-		geometry_.x -= constants::screen_width;
+		geometry_.x -= game_->world_width_;
 	}
 	else if (geometry_.x < 0.0)
 	{
-		geometry_.x += constants::screen_width;
+		geometry_.x += game_->world_width_;
 	}
 
-	if (geometry_.y > constants::screen_height)
+	if (geometry_.y > game_->world_height_)
 	{
-		geometry_.y -= constants::screen_height;
+		geometry_.y -= game_->world_height_;
 	}
 	else if (geometry_.y < 0.0)
 	{
-		geometry_.y += constants::screen_height;
+		geometry_.y += game_->world_height_;
 	}
 
 	HandleCollision();
 }
 
-void Bullet::Render()
+void Bullet::Render(float offset_x, float offset_y) const
 {
-	SDL_RenderFillRectF(game_->Renderer(), &geometry_);
+	const SDL_FRect render_rect = { geometry_.x + offset_x, geometry_.y + offset_y, geometry_.w, geometry_.h };
+
+	SDL_RenderFillRectF(game_->Renderer(), &render_rect);
 }
 
 void Bullet::HandleCollision()
@@ -69,6 +73,7 @@ void Bullet::HandleCollision()
     	if (dist_squared < asteroid->furthest_distance_squared_)
 		{
 			game_->PlayAsteroidExplosionSound();
+			game_->AddExplosion(*asteroid);
 			asteroid->removed_ = true;
 			removed_ = true;
 			game_->score_ += 10;
@@ -0,0 +1,231 @@
+#include "FrameCapture.hpp"
+#include "Framebuffer.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+FrameCapture::FrameCapture() : file_(nullptr), format_(Format::Y4M), width_(0), height_(0), head_(0), tail_(0), stopping_(false), start_counter_(0), stop_counter_(0), encode_counter_(0), submitted_(0), dropped_(0), encoded_(0)
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+	Stop();
+}
+
+bool FrameCapture::Start(const std::string& path, int width, int height, int frames_per_second, std::size_t queue_depth)
+{
+	const bool ppm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+
+	file_ = std::fopen(path.c_str(), "wb");
+
+	if (file_ == nullptr)
+	{
+		printf("Unable to open capture file %s!\n", path.c_str());
+		return false;
+	}
+
+	format_ = ppm ? Format::PPM : Format::Y4M;
+	width_ = width;
+	height_ = height;
+
+	slots_.assign(std::max<std::size_t>(queue_depth, 1), std::vector<std::uint32_t>(static_cast<std::size_t>(width) * static_cast<std::size_t>(height)));
+	head_ = 0;
+	tail_ = 0;
+	submitted_ = 0;
+	dropped_ = 0;
+	encoded_ = 0;
+	encode_counter_ = 0;
+
+	if (format_ == Format::Y4M)
+	{
+		// 4:2:0 with full-range (JPEG) chroma, which is what the RGB conversion in EncodeFrame produces.
+		std::fprintf(file_, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width_, height_, frames_per_second);
+		encode_buffer_.resize(static_cast<std::size_t>(width_) * height_ + 2 * static_cast<std::size_t>((width_ + 1) / 2) * ((height_ + 1) / 2));
+	}
+	else
+	{
+		encode_buffer_.resize(static_cast<std::size_t>(width_) * height_ * 3);
+	}
+
+	stopping_ = false;
+	start_counter_ = SDL_GetPerformanceCounter();
+	stop_counter_ = 0;
+	encoder_ = std::thread(&FrameCapture::EncoderLoop, this);
+
+	return true;
+}
+
+bool FrameCapture::Submit(const Framebuffer& frame)
+{
+	if (file_ == nullptr || frame.Width() != width_ || frame.Height() != height_)
+	{
+		return false;
+	}
+
+	++submitted_;
+
+	const std::size_t head = head_.load(std::memory_order_relaxed);
+
+	// Never wait for the encoder: when every slot is still queued the frame is dropped.
+	if (head - tail_.load(std::memory_order_acquire) >= slots_.size())
+	{
+		++dropped_;
+		return false;
+	}
+
+	std::vector<std::uint32_t>& slot = slots_[head % slots_.size()];
+	std::memcpy(slot.data(), frame.Pixels(), slot.size() * sizeof(std::uint32_t));
+
+	head_.store(head + 1, std::memory_order_release);
+	wake_.notify_one();
+
+	return true;
+}
+
+void FrameCapture::Stop()
+{
+	if (file_ == nullptr)
+	{
+		return;
+	}
+
+	stopping_ = true;
+	wake_.notify_one();
+	encoder_.join();
+
+	stop_counter_ = SDL_GetPerformanceCounter();
+
+	std::fclose(file_);
+	file_ = nullptr;
+
+	printf("Captured %zu of %zu frames (%zu dropped), %.1f fps overall, %.1f fps encoder throughput\n", encoded_.load(), submitted_, dropped_, FramesPerSecond(), EncodeFramesPerSecond());
+}
+
+bool FrameCapture::Active() const
+{
+	return file_ != nullptr;
+}
+
+double FrameCapture::FramesPerSecond() const
+{
+	const std::uint64_t end = stop_counter_ != 0 ? stop_counter_ : SDL_GetPerformanceCounter();
+	const double seconds = static_cast<double>(end - start_counter_) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	return seconds > 0.0 ? encoded_.load() / seconds : 0.0;
+}
+
+double FrameCapture::EncodeFramesPerSecond() const
+{
+	const double seconds = static_cast<double>(encode_counter_) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	return seconds > 0.0 ? encoded_.load() / seconds : 0.0;
+}
+
+void FrameCapture::EncoderLoop()
+{
+	trace::NameThread("encoder");
+
+	while (true)
+	{
+		const std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+		if (tail == head_.load(std::memory_order_acquire))
+		{
+			if (stopping_)
+			{
+				return;
+			}
+
+			// The producer notifies without taking the lock, so wake up periodically in case a notification was missed.
+			std::unique_lock<std::mutex> lock(wake_mutex_);
+			wake_.wait_for(lock, std::chrono::milliseconds(5));
+			continue;
+		}
+
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		EncodeFrame(slots_[tail % slots_.size()]);
+		const std::uint64_t end = SDL_GetPerformanceCounter();
+		encode_counter_ += end - start;
+
+		if (trace::enabled.load(std::memory_order_relaxed))
+		{
+			trace::Record("FrameCapture::EncodeFrame", start, end);
+		}
+
+		tail_.store(tail + 1, std::memory_order_release);
+		++encoded_;
+	}
+}
+
+void FrameCapture::EncodeFrame(const std::vector<std::uint32_t>& pixels)
+{
+	std::uint8_t* out = encode_buffer_.data();
+
+	if (format_ == Format::PPM)
+	{
+		std::fprintf(file_, "P6\n%d %d\n255\n", width_, height_);
+
+		for (const std::uint32_t pixel : pixels)
+		{
+			*out++ = static_cast<std::uint8_t>(pixel >> 16);
+			*out++ = static_cast<std::uint8_t>(pixel >> 8);
+			*out++ = static_cast<std::uint8_t>(pixel);
+		}
+
+		std::fwrite(encode_buffer_.data(), 1, encode_buffer_.size(), file_);
+		return;
+	}
+
+	// BT.601 full range in 16.16 fixed point.
+	for (const std::uint32_t pixel : pixels)
+	{
+		const int r = (pixel >> 16) & 0xFF;
+		const int g = (pixel >> 8) & 0xFF;
+		const int b = pixel & 0xFF;
+
+		*out++ = static_cast<std::uint8_t>((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+	}
+
+	const int chroma_width = (width_ + 1) / 2;
+	const int chroma_height = (height_ + 1) / 2;
+	std::uint8_t* u_plane = out;
+	std::uint8_t* v_plane = out + static_cast<std::size_t>(chroma_width) * chroma_height;
+
+	for (int cy = 0; cy < chroma_height; ++cy)
+	{
+		const int y0 = cy * 2;
+		const int y1 = std::min(y0 + 1, height_ - 1);
+
+		for (int cx = 0; cx < chroma_width; ++cx)
+		{
+			const int x0 = cx * 2;
+			const int x1 = std::min(x0 + 1, width_ - 1);
+			const std::uint32_t block[4] = { pixels[static_cast<std::size_t>(y0) * width_ + x0], pixels[static_cast<std::size_t>(y0) * width_ + x1], pixels[static_cast<std::size_t>(y1) * width_ + x0], pixels[static_cast<std::size_t>(y1) * width_ + x1] };
+
+			int r = 0;
+			int g = 0;
+			int b = 0;
+
+			for (const std::uint32_t pixel : block)
+			{
+				r += (pixel >> 16) & 0xFF;
+				g += (pixel >> 8) & 0xFF;
+				b += pixel & 0xFF;
+			}
+
+			const int u = ((-11059 * r - 21709 * g + 32768 * b) >> 2) + (128 << 16) + 32768;
+			const int v = ((32768 * r - 27439 * g - 5329 * b) >> 2) + (128 << 16) + 32768;
+
+			*u_plane++ = static_cast<std::uint8_t>(std::clamp(u >> 16, 0, 255));
+			*v_plane++ = static_cast<std::uint8_t>(std::clamp(v >> 16, 0, 255));
+		}
+	}
+
+	std::fputs("FRAME\n", file_);
+	std::fwrite(encode_buffer_.data(), 1, encode_buffer_.size(), file_);
+}
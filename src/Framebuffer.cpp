@@ -0,0 +1,188 @@
+#include "Framebuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+Framebuffer::Framebuffer(int width, int height) : width_(width), height_(height), pixels_(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), 0)
+{
+}
+
+void Framebuffer::Clear(std::uint32_t color)
+{
+	std::fill(pixels_.begin(), pixels_.end(), color);
+}
+
+void Framebuffer::DrawLine(float x0, float y0, float x1, float y1, std::uint32_t color)
+{
+	// Liang-Barsky clip against the framebuffer, so the integer loop below never needs a bounds check.
+	const float max_x = static_cast<float>(width_ - 1);
+	const float max_y = static_cast<float>(height_ - 1);
+	const float dx = x1 - x0;
+	const float dy = y1 - y0;
+	const float p[4] = { -dx, dx, -dy, dy };
+	const float q[4] = { x0, max_x - x0, y0, max_y - y0 };
+
+	float t0 = 0.0f;
+	float t1 = 1.0f;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (p[i] == 0.0f)
+		{
+			if (q[i] < 0.0f)
+			{
+				return;
+			}
+
+			continue;
+		}
+
+		const float t = q[i] / p[i];
+
+		if (p[i] < 0.0f)
+		{
+			t0 = std::max(t0, t);
+		}
+		else
+		{
+			t1 = std::min(t1, t);
+		}
+
+		if (t0 > t1)
+		{
+			return;
+		}
+	}
+
+	int x = static_cast<int>(std::lround(x0 + t0 * dx));
+	int y = static_cast<int>(std::lround(y0 + t0 * dy));
+	const int end_x = static_cast<int>(std::lround(x0 + t1 * dx));
+	const int end_y = static_cast<int>(std::lround(y0 + t1 * dy));
+
+	// Bresenham walking a pixel pointer; the major axis steps every iteration, the minor axis on error overflow.
+	const int step_x = end_x >= x ? 1 : -1;
+	const int step_y = end_y >= y ? width_ : -width_;
+	const int delta_x = std::abs(end_x - x);
+	const int delta_y = std::abs(end_y - y);
+
+	std::uint32_t* pixel = pixels_.data() + static_cast<std::size_t>(y) * width_ + x;
+
+	if (delta_x >= delta_y)
+	{
+		int error = delta_x / 2;
+
+		for (int i = 0; i <= delta_x; ++i)
+		{
+			*pixel = color;
+			pixel += step_x;
+			error -= delta_y;
+
+			if (error < 0)
+			{
+				pixel += step_y;
+				error += delta_x;
+			}
+		}
+	}
+	else
+	{
+		int error = delta_y / 2;
+
+		for (int i = 0; i <= delta_y; ++i)
+		{
+			*pixel = color;
+			pixel += step_y;
+			error -= delta_x;
+
+			if (error < 0)
+			{
+				pixel += step_x;
+				error += delta_y;
+			}
+		}
+	}
+}
+
+void Framebuffer::FillRect(const SDL_FRect& rect, std::uint32_t color)
+{
+	const int left = std::max(static_cast<int>(std::lround(rect.x)), 0);
+	const int top = std::max(static_cast<int>(std::lround(rect.y)), 0);
+	const int right = std::min(static_cast<int>(std::lround(rect.x + rect.w)), width_);
+	const int bottom = std::min(static_cast<int>(std::lround(rect.y + rect.h)), height_);
+
+	for (int y = top; y < bottom; ++y)
+	{
+		std::uint32_t* row = pixels_.data() + static_cast<std::size_t>(y) * width_;
+		std::fill(row + left, row + std::max(left, right), color);
+	}
+}
+
+void Framebuffer::DrawPoints(const SDL_FPoint* points, std::size_t count, std::uint32_t color)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const int x = static_cast<int>(points[i].x);
+		const int y = static_cast<int>(points[i].y);
+
+		if (x >= 0 && x < width_ && y >= 0 && y < height_)
+		{
+			pixels_[static_cast<std::size_t>(y) * width_ + x] = color;
+		}
+	}
+}
+
+void Framebuffer::BlendSurface(const SDL_Surface* surface, int x, int y)
+{
+	if (surface == nullptr || surface->format->BytesPerPixel != 4)
+	{
+		return;
+	}
+
+	const int left = std::max(x, 0);
+	const int top = std::max(y, 0);
+	const int right = std::min(x + surface->w, width_);
+	const int bottom = std::min(y + surface->h, height_);
+
+	for (int row = top; row < bottom; ++row)
+	{
+		const std::uint32_t* source = reinterpret_cast<const std::uint32_t*>(static_cast<const std::uint8_t*>(surface->pixels) + static_cast<std::size_t>(row - y) * surface->pitch) + (left - x);
+		std::uint32_t* target = pixels_.data() + static_cast<std::size_t>(row) * width_ + left;
+
+		for (int column = left; column < right; ++column, ++source, ++target)
+		{
+			const std::uint32_t alpha = *source >> 24;
+
+			if (alpha == 0)
+			{
+				continue;
+			}
+
+			std::uint32_t blended = 0xFF000000;
+
+			for (int shift = 0; shift < 24; shift += 8)
+			{
+				const std::uint32_t src = (*source >> shift) & 0xFF;
+				const std::uint32_t dst = (*target >> shift) & 0xFF;
+				blended |= (((src * alpha) + (dst * (255 - alpha))) / 255) << shift;
+			}
+
+			*target = blended;
+		}
+	}
+}
+
+int Framebuffer::Width() const
+{
+	return width_;
+}
+
+int Framebuffer::Height() const
+{
+	return height_;
+}
+
+const std::uint32_t* Framebuffer::Pixels() const
+{
+	return pixels_.data();
+}
@@ -1,38 +1,70 @@
 #include "Game.hpp"
 #include "Utils/Constants.hpp"
 #include "Asteroid.hpp"
+#include "Snapshot.hpp"
+#include "Trace.hpp"
+#include "AllocationCounter.hpp"
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
-#include <SDL2/SDL_mixer.h>
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <random>
+#include <thread>
 
-Game::Game() : 
+Game::Game(std::size_t particle_capacity) : 
 	title_(constants::game_title), 
 	is_running_(false), 
 	score_(0), 
 	number_of_asteroids_(4), 
 	info_toggled_(false), 
+	perf_overlay_toggled_(false), 
 	game_over_(false), 
 	reset_game_(false), 
+	asteroid_collisions_(false), 
+	headless_(false), 
+	render_path_(RenderPath::LINES), 
+	ticks_(0), 
+	tick_rate_(constants::ticks_per_second), 
+	tick_seconds_(1.0 / constants::ticks_per_second), 
+	local_player_(true), 
+	resimulating_(false), 
+	next_entity_id_(1), 
+	world_width_(constants::screen_width), 
+	world_height_(constants::screen_height), 
 	mt_(std::random_device{}()), 
-	random_x_(0.0, constants::screen_width), 
-	random_y_(0.0, constants::screen_height), 
+	random_x_(0.0, world_width_), 
+	random_y_(0.0, world_height_), 
 	score_info_(std::make_unique<Texture>()), 
 	lives_info_(std::make_unique<Texture>()), 
 	toggle_info_(std::make_unique<Texture>()), 
 	info_(std::make_unique<Texture>()), 
 	game_over_info_(std::make_unique<Texture>()), 
+	perf_overlay_(std::make_unique<PerfOverlay>()), 
+	hud_(std::make_unique<HudLayer>()), 
 	player_(std::make_unique<Player>(this, 5)), 
+	broadphase_(world_width_, world_height_), 
+	splits_this_tick_(0), 
+	score_text_dirty_(false), 
+	score_text_tick_(0), 
+	sprite_cache_(std::make_unique<SpriteCache>(120, 32 * 1024 * 1024)), 
+	particles_(std::make_unique<ParticleSystem>(particle_capacity, constants::screen_width, constants::screen_height)), 
+	camera_({ 0.0f, 0.0f }), 
 	font_(nullptr), 
-	shoot_sfx_(nullptr), 
-	asteroid_explosion_sfx_(nullptr), 
+	overlay_font_(nullptr), 
+	bundle_(std::make_unique<AssetBundle>()), 
+	audio_(std::make_unique<AudioMixer>()), 
+	shoot_sfx_(-1), 
+	asteroid_explosion_sfx_(-1), 
 	window_(nullptr), 
-	renderer_(nullptr)
+	renderer_(nullptr), 
+	startup_counter_(SDL_GetPerformanceCounter()), 
+	draw_calls_(0), 
+	present_ms_(0.0)
 {
 	SpawnAsteroids(number_of_asteroids_++);
 }
@@ -42,14 +74,386 @@ Game::~Game()
 	Finalize();
 }
 
+void Game::ApplyOptions(const Options& options)
+{
+	options_ = options;
+	asteroid_collisions_ = options.asteroid_collisions;
+	render_path_ = options.render_path;
+	sprite_cache_->Configure(options.sprite_angle_steps, options.sprite_cache_bytes);
+	spawn_scheduler_.Configure(static_cast<std::size_t>(options.spawn_budget), options.spawn_budget_us);
+	SetTickRate(options.tick_rate);
+
+	if (options.world_scale != 1.0)
+	{
+		SetWorldSize(constants::screen_width * options.world_scale, constants::screen_height * options.world_scale);
+	}
+
+	if (options.seed)
+	{
+		Seed(*options.seed);
+	}
+}
+
+void Game::Seed(std::uint64_t seed)
+{
+	mt_.seed(seed);
+	ClearAsteroids();
+	number_of_asteroids_ = options_.initial_asteroids;
+	SpawnAsteroids(number_of_asteroids_++);
+}
+
+void Game::SetTickRate(int tick_rate)
+{
+	tick_rate_ = std::clamp(tick_rate, constants::min_tick_rate, constants::max_tick_rate);
+	tick_seconds_ = 1.0 / tick_rate_;
+}
+
+bool Game::LoadScenario(const std::string& name_or_path)
+{
+	Scenario scenario;
+
+	if (!scenario::Resolve(name_or_path, &scenario))
+	{
+		return false;
+	}
+
+	asteroid_collisions_ = scenario.asteroid_collisions;
+	options_.ticks = static_cast<int>(scenario.duration_seconds * tick_rate_);
+	SetWorldSize(constants::screen_width * scenario.world_scale, constants::screen_height * scenario.world_scale);
+	Seed(scenario.seed);
+
+	scenario_ = std::make_unique<ScenarioDriver>(scenario, tick_rate_);
+
+	return true;
+}
+
+void Game::SetWorldSize(double world_width, double world_height)
+{
+	ConfigureWorld(std::max<double>(world_width, constants::screen_width), std::max<double>(world_height, constants::screen_height));
+
+	ClearAsteroids();
+	bullets_.clear();
+	number_of_asteroids_ = options_.initial_asteroids;
+	SpawnAsteroids(number_of_asteroids_++);
+
+	player_->ResetPlayer();
+
+	for (const std::unique_ptr<Player>& remote_player : remote_players_)
+	{
+		remote_player->ResetPlayer();
+	}
+
+	UpdateCamera();
+}
+
+void Game::ConfigureWorld(double world_width, double world_height)
+{
+	world_width_ = world_width;
+	world_height_ = world_height;
+
+	random_x_ = std::uniform_real_distribution<double>(0.0, world_width_);
+	random_y_ = std::uniform_real_distribution<double>(0.0, world_height_);
+
+	broadphase_.SetWorldSize(world_width_, world_height_);
+	particles_->SetWorldSize(static_cast<float>(world_width_), static_cast<float>(world_height_));
+	asteroid_grid_.Configure(world_width_, world_height_, constants::cull_cell_size);
+	bullet_grid_.Configure(world_width_, world_height_, constants::cull_cell_size);
+}
+
+void Game::SaveSnapshot(std::vector<std::uint8_t>* buffer) const
+{
+	// resize keeps the capacity, so saving into the same buffer again does not allocate. Records are zeroed first so
+	// padding bytes are deterministic and equal states produce identical buffers.
+	buffer->resize(snapshot::RecordsSize(asteroids_.size(), bullets_.size(), remote_players_.size(), spawn_scheduler_.Pending()));
+	std::uint8_t* out = buffer->data();
+
+	snapshot::Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, snapshot::magic, sizeof(header.magic));
+	header.version = snapshot::version;
+	header.size = buffer->size();
+	header.asteroid_count = static_cast<std::uint32_t>(asteroids_.size());
+	header.bullet_count = static_cast<std::uint32_t>(bullets_.size());
+	header.remote_player_count = static_cast<std::uint32_t>(remote_players_.size());
+	header.pending_spawn_count = static_cast<std::uint32_t>(spawn_scheduler_.Pending());
+	std::memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+
+	snapshot::GameState state;
+	std::memset(&state, 0, sizeof(state));
+	state.world_width = world_width_;
+	state.world_height = world_height_;
+	state.score = score_;
+	state.number_of_asteroids = number_of_asteroids_;
+	state.next_entity_id = next_entity_id_;
+	state.local_player = local_player_;
+	state.game_over = game_over_;
+	state.reset_game = reset_game_;
+	state.asteroid_collisions = asteroid_collisions_;
+	state.tick_rate = tick_rate_;
+	std::memcpy(state.random_engine, &mt_, sizeof(state.random_engine));
+	snapshot::Store(*player_, &state.player);
+	std::memcpy(out, &state, sizeof(state));
+	out += sizeof(state);
+
+	for (const std::unique_ptr<Player>& remote_player : remote_players_)
+	{
+		snapshot::PlayerState player_state;
+		std::memset(&player_state, 0, sizeof(player_state));
+		snapshot::Store(*remote_player, &player_state);
+		std::memcpy(out, &player_state, sizeof(player_state));
+		out += sizeof(player_state);
+	}
+
+	for (const std::unique_ptr<Asteroid>& asteroid : asteroids_)
+	{
+		snapshot::AsteroidState asteroid_state;
+		std::memset(&asteroid_state, 0, sizeof(asteroid_state));
+		snapshot::Store(*asteroid, &asteroid_state.polygon);
+		asteroid_state.id = asteroid->id_;
+		asteroid_state.type = static_cast<std::int32_t>(asteroid->type_);
+		std::memcpy(out, &asteroid_state, sizeof(asteroid_state));
+		out += sizeof(asteroid_state);
+	}
+
+	for (const std::unique_ptr<Bullet>& bullet : bullets_)
+	{
+		snapshot::BulletState bullet_state;
+		std::memset(&bullet_state, 0, sizeof(bullet_state));
+		snapshot::Store(*bullet, &bullet_state);
+		std::memcpy(out, &bullet_state, sizeof(bullet_state));
+		out += sizeof(bullet_state);
+	}
+
+	// Snapshots are taken between ticks, when every queued spawn is due on the next tick or already late.
+	for (std::size_t i = 0; i < spawn_scheduler_.Pending(); ++i)
+	{
+		const SpawnScheduler::Spawn& spawn = spawn_scheduler_.PendingAt(i);
+
+		snapshot::PendingSpawnState spawn_state;
+		std::memset(&spawn_state, 0, sizeof(spawn_state));
+		spawn_state.x = spawn.x;
+		spawn_state.y = spawn.y;
+		spawn_state.vx = spawn.vx;
+		spawn_state.vy = spawn.vy;
+		spawn_state.type = static_cast<std::int32_t>(spawn.type);
+		spawn_state.missed = static_cast<std::int32_t>(static_cast<std::int64_t>(ticks_) - static_cast<std::int64_t>(spawn.due));
+		std::memcpy(out, &spawn_state, sizeof(spawn_state));
+		out += sizeof(spawn_state);
+	}
+}
+
+bool Game::RestoreSnapshot(const std::uint8_t* data, std::size_t size)
+{
+	snapshot::Header header;
+
+	if (size < sizeof(header))
+	{
+		printf("Snapshot is truncated\n");
+		return false;
+	}
+
+	std::memcpy(&header, data, sizeof(header));
+
+	if (std::memcmp(header.magic, snapshot::magic, sizeof(header.magic)) != 0 || header.version != snapshot::version)
+	{
+		printf("Snapshot has an unknown format or version\n");
+		return false;
+	}
+
+	if (header.size != size || snapshot::RecordsSize(header.asteroid_count, header.bullet_count, header.remote_player_count, header.pending_spawn_count) != size)
+	{
+		printf("Snapshot is truncated\n");
+		return false;
+	}
+
+	const std::uint8_t* in = data + sizeof(header);
+
+	snapshot::GameState state;
+	std::memcpy(&state, in, sizeof(state));
+	in += sizeof(state);
+
+	// The broadphase holds pointers to the asteroids about to be overwritten or erased.
+	broadphase_.Clear();
+
+	if (state.world_width != world_width_ || state.world_height != world_height_)
+	{
+		ConfigureWorld(state.world_width, state.world_height);
+	}
+
+	score_ = state.score;
+	number_of_asteroids_ = state.number_of_asteroids;
+	next_entity_id_ = state.next_entity_id;
+	local_player_ = state.local_player != 0;
+	game_over_ = state.game_over != 0;
+	reset_game_ = state.reset_game != 0;
+	asteroid_collisions_ = state.asteroid_collisions != 0;
+	SetTickRate(state.tick_rate);
+	std::memcpy(&mt_, state.random_engine, sizeof(state.random_engine));
+
+	bool valid = snapshot::Load(state.player, player_.get());
+
+	remote_players_.resize(header.remote_player_count);
+
+	for (std::unique_ptr<Player>& remote_player : remote_players_)
+	{
+		snapshot::PlayerState player_state;
+		std::memcpy(&player_state, in, sizeof(player_state));
+		in += sizeof(player_state);
+
+		if (remote_player == nullptr)
+		{
+			remote_player = std::make_unique<Player>(this, 5);
+			remote_player->local_ = false;
+		}
+
+		valid = snapshot::Load(player_state, remote_player.get()) && valid;
+	}
+
+	// Existing objects are overwritten in place; only a snapshot with more of them than the game has allocates.
+	auto asteroid_it = asteroids_.begin();
+
+	for (std::uint32_t i = 0; i < header.asteroid_count; ++i)
+	{
+		snapshot::AsteroidState asteroid_state;
+		std::memcpy(&asteroid_state, in, sizeof(asteroid_state));
+		in += sizeof(asteroid_state);
+
+		if (asteroid_it == asteroids_.end())
+		{
+			asteroid_it = asteroids_.insert(asteroid_it, std::make_unique<Asteroid>(this, AsteroidType::SMALL, 0.0, 0.0, 0.0, 0.0));
+		}
+
+		(*asteroid_it)->id_ = asteroid_state.id;
+		(*asteroid_it)->type_ = static_cast<AsteroidType>(asteroid_state.type);
+		valid = snapshot::Load(asteroid_state.polygon, asteroid_it->get()) && valid;
+		++asteroid_it;
+	}
+
+	asteroids_.erase(asteroid_it, asteroids_.end());
+
+	auto bullet_it = bullets_.begin();
+
+	for (std::uint32_t i = 0; i < header.bullet_count; ++i)
+	{
+		snapshot::BulletState bullet_state;
+		std::memcpy(&bullet_state, in, sizeof(bullet_state));
+		in += sizeof(bullet_state);
+
+		if (bullet_it == bullets_.end())
+		{
+			bullet_it = bullets_.insert(bullet_it, std::make_unique<Bullet>(this, 0.0, 0.0, 0.0, 0.0));
+		}
+
+		snapshot::Load(bullet_state, bullet_it->get());
+		++bullet_it;
+	}
+
+	bullets_.erase(bullet_it, bullets_.end());
+
+	spawn_scheduler_.Clear();
+
+	for (std::uint32_t i = 0; i < header.pending_spawn_count; ++i)
+	{
+		snapshot::PendingSpawnState spawn_state;
+		std::memcpy(&spawn_state, in, sizeof(spawn_state));
+		in += sizeof(spawn_state);
+
+		const std::uint64_t missed = static_cast<std::uint64_t>(std::max(spawn_state.missed, 0));
+		const AsteroidType type = static_cast<AsteroidType>(std::clamp(spawn_state.type, 0, static_cast<std::int32_t>(AsteroidType::SMALL)));
+
+		spawn_scheduler_.Restore({ type, spawn_state.x, spawn_state.y, spawn_state.vx, spawn_state.vy, ticks_ - std::min(missed, ticks_) });
+	}
+
+	if (CameraEnabled())
+	{
+		asteroid_grid_.Rebuild(asteroids_, [](const Asteroid& asteroid)
+		{
+			return asteroid.center_;
+		});
+
+		bullet_grid_.Rebuild(bullets_, [](const Bullet& bullet)
+		{
+			return SDL_FPoint{ bullet.geometry_.x, bullet.geometry_.y };
+		});
+	}
+	else
+	{
+		asteroid_grid_.Clear();
+		bullet_grid_.Clear();
+	}
+
+	UpdateCamera();
+	UpdateScoreText();
+	UpdateLivesText();
+
+	return valid;
+}
+
 bool Game::Initialize()
 {
+	std::uint64_t start = SDL_GetPerformanceCounter();
+
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
 		printf("SDL could not be initialized! SDL Error: %s\n", SDL_GetError());
 		return false;
 	}
 
+	startup_phases_.push_back(TimePhase("sdl video", "main", start));
+	start = SDL_GetPerformanceCounter();
+
+	if (TTF_Init() == -1)
+	{
+		printf("SDL_ttf could not be initialized! SDL_ttf Error: %s\n", TTF_GetError());
+		return false;
+	}
+
+	// Without a bundle (see make bundle) the loose files under res/ are decoded instead.
+	bundle_->Open(options_.bundle_path.c_str());
+	startup_phases_.push_back(TimePhase("ttf, bundle", "main", start));
+
+	// Audio and the font need neither the window nor the renderer, so they load on workers while the main thread,
+	// which SDL requires for video, creates the window. Nothing else calls into SDL_ttf or the mixer until both are joined.
+	std::vector<StartupPhase> audio_phases;
+	std::vector<StartupPhase> font_phases;
+	bool audio_ready = false;
+	bool font_ready = false;
+
+	std::thread audio_worker([this, &audio_phases, &audio_ready]
+	{
+		audio_ready = InitAudio(&audio_phases);
+	});
+
+	std::thread font_worker([this, &font_phases, &font_ready]
+	{
+		font_ready = LoadFont(&font_phases);
+	});
+
+	const bool video_ready = CreateWindowAndRenderer(&startup_phases_);
+
+	audio_worker.join();
+	font_worker.join();
+
+	startup_phases_.insert(startup_phases_.end(), audio_phases.begin(), audio_phases.end());
+	startup_phases_.insert(startup_phases_.end(), font_phases.begin(), font_phases.end());
+
+	if (!video_ready || !audio_ready || !font_ready)
+	{
+		return false;
+	}
+
+	start = SDL_GetPerformanceCounter();
+	const bool resources_ready = InitResources();
+	startup_phases_.push_back(TimePhase("hud textures", "main", start));
+
+	return resources_ready;
+}
+
+bool Game::CreateWindowAndRenderer(std::vector<StartupPhase>* phases)
+{
+	std::uint64_t start = SDL_GetPerformanceCounter();
+
 	if (!SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0"))
 	{
 		printf("%s\n", "Warning: Texture filtering is not enabled!");
@@ -63,6 +467,9 @@ bool Game::Initialize()
 		return false;
 	}
 
+	phases->push_back(TimePhase("window", "main", start));
+	start = SDL_GetPerformanceCounter();
+
 	renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED);
 
 	if (renderer_ == nullptr)
@@ -72,66 +479,132 @@ bool Game::Initialize()
 	}
 
 	SDL_SetRenderDrawColor(renderer_, 0xFF, 0xFF, 0xFF, 0xFF);
+	phases->push_back(TimePhase("renderer", "main", start));
+
+	return true;
+}
 
-	constexpr int img_flags = IMG_INIT_PNG;
+bool Game::InitAudio(std::vector<StartupPhase>* phases)
+{
+	std::uint64_t start = SDL_GetPerformanceCounter();
 
-	if (!(IMG_Init(img_flags) & img_flags))
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
 	{
-		printf("SDL_image could not be initialized! SDL_image Error: %s\n", IMG_GetError());
+		printf("SDL audio could not be initialized! SDL Error: %s\n", SDL_GetError());
 		return false;
 	}
 
-	if (TTF_Init() == -1)
+	if (!audio_->Open(options_.audio_buffer_frames))
 	{
-		printf("SDL_ttf could not be initialized! SDL_ttf Error: %s\n", TTF_GetError());
 		return false;
 	}
 
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0)
+	phases->push_back(TimePhase("audio device", "audio", start));
+	start = SDL_GetPerformanceCounter();
+
+	shoot_sfx_ = LoadSound(constants::shoot_sfx_path, 0);
+	asteroid_explosion_sfx_ = LoadSound(constants::explosion_sfx_path, 1);
+	audio_->Start();
+
+	phases->push_back(TimePhase("sounds", "audio", start));
+
+	return shoot_sfx_ >= 0 && asteroid_explosion_sfx_ >= 0;
+}
+
+bool Game::LoadFont(std::vector<StartupPhase>* phases)
+{
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+
+	std::size_t font_size = 0;
+	const void* font_data = bundle_->Find(constants::font_path, AssetType::FONT, &font_size);
+
+	if (font_data != nullptr)
+	{
+		font_ = TTF_OpenFontRW(SDL_RWFromConstMem(font_data, static_cast<int>(font_size)), 1, constants::font_size);
+		overlay_font_ = TTF_OpenFontRW(SDL_RWFromConstMem(font_data, static_cast<int>(font_size)), 1, constants::overlay_font_size);
+	}
+	else
+	{
+		font_ = TTF_OpenFont(constants::font_path, constants::font_size);
+		overlay_font_ = TTF_OpenFont(constants::font_path, constants::overlay_font_size);
+	}
+
+	if (font_ == nullptr || overlay_font_ == nullptr)
 	{
-		printf("SDL_mixer could not be initialized! SDL_mixer Error: %s\n", Mix_GetError());
+		printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
 		return false;
 	}
 
-	return InitResources();
+	phases->push_back(TimePhase("font", "font", start));
+
+	return true;
+}
+
+StartupPhase Game::TimePhase(const char* name, const char* thread, std::uint64_t start) const
+{
+	const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	const std::uint64_t end = SDL_GetPerformanceCounter();
+
+	return { name, thread, static_cast<double>(start - startup_counter_) * 1000.0 / frequency, static_cast<double>(end - startup_counter_) * 1000.0 / frequency };
 }
 
 void Game::Finalize()
 {
-	SDL_DestroyWindow(window_);
-	window_ = nullptr;
+	if (frame_capture_ != nullptr)
+	{
+		frame_capture_->Stop();
+	}
+
+	if (state_hash_ != nullptr)
+	{
+		state_hash_->Close();
+	}
+
+	if (replay_writer_ != nullptr)
+	{
+		replay_writer_->Close();
+	}
+
+	// Textures belong to the renderer, and the renderer to the window.
+	sprite_cache_->Clear();
+	score_info_->FreeTexture();
+	lives_info_->FreeTexture();
+	toggle_info_->FreeTexture();
+	info_->FreeTexture();
+	game_over_info_->FreeTexture();
+	perf_overlay_->Free();
+	hud_->Free();
 
 	SDL_DestroyRenderer(renderer_);
 	renderer_ = nullptr;
 
+	SDL_DestroyWindow(window_);
+	window_ = nullptr;
+
 	TTF_CloseFont(font_);
 	font_ = nullptr;
+	TTF_CloseFont(overlay_font_);
+	overlay_font_ = nullptr;
 
-	Mix_FreeChunk(shoot_sfx_);
-	shoot_sfx_ = nullptr;
+	if (audio_->IsOpen())
+	{
+		audio_->Close();
+
+		if (options_.audio_stats)
+		{
+			audio_->PrintStats();
+		}
+	}
 
-	Mix_FreeChunk(asteroid_explosion_sfx_);
-	asteroid_explosion_sfx_ = nullptr;
+	// Fonts and sounds loaded from the bundle point into its mapping.
+	bundle_->Close();
 
 	TTF_Quit();
-	IMG_Quit();
 	SDL_Quit();
-	Mix_Quit();
 }
 
 bool Game::InitResources()
 {
-	font_ = TTF_OpenFont("res/font/font.ttf", 28);
-
-	if (font_ == nullptr)
-	{
-		printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
-		return false;
-	}
-
-	shoot_sfx_ = Mix_LoadWAV("res/sfx/shoot.wav");
-	asteroid_explosion_sfx_ = Mix_LoadWAV("res/sfx/explosion.wav");
-
 	SDL_Color text_color = { 0xFF, 0xFF, 0xFF, 0xFF };
 
 	const std::string score_text = "Score: " + std::to_string(score_);
@@ -140,27 +613,70 @@ bool Game::InitResources()
 	const std::string lives_text = "Lives: " + std::to_string(player_->lives_);
 	lives_info_->LoadFromText(renderer_, font_, lives_text.c_str(), text_color);
 
-    toggle_info_->LoadFromText(renderer_, font_, "Press 'i' to toggle info", text_color);
-    info_->LoadFromText(renderer_, font_, "Arrows - move Space - shoot", text_color, 200);
-    game_over_info_->LoadFromText(renderer_, font_, "Game Over!.            Press 'r' to restart.", text_color, 300);
+    toggle_info_->LoadFromText(renderer_, font_, constants::toggle_info_text, text_color);
+    info_->LoadFromText(renderer_, font_, constants::info_text, text_color, constants::info_wrap_length);
+    game_over_info_->LoadFromText(renderer_, font_, constants::game_over_text, text_color, constants::game_over_wrap_length);
+	perf_overlay_->Load(renderer_, overlay_font_);
+	hud_->Create(renderer_, constants::screen_width, constants::screen_height);
 
 	return true;
 }
 
+int Game::LoadSound(const char* path, int priority)
+{
+	std::size_t size = 0;
+	const void* samples = bundle_->Find(path, AssetType::PCM_S16, &size);
+
+	if (samples != nullptr)
+	{
+		return audio_->LoadPcm(static_cast<const std::int16_t*>(samples), size / sizeof(std::int16_t), priority);
+	}
+
+	return audio_->Load(path, priority);
+}
+
 void Game::UpdateScoreText()
 {
+	if (headless_ || resimulating_)
+	{
+		return;
+	}
+
+	// Under the governor's HUD policy a score that changes every tick is redrawn a few times a second; Render catches up.
+	if (governor_.Active(GovernorPolicy::SLOW_HUD) && ticks_ < score_text_tick_ + PerformanceGovernor::hud_interval_ticks)
+	{
+		score_text_dirty_ = true;
+		return;
+	}
+
+	score_text_dirty_ = false;
+	score_text_tick_ = ticks_;
+
+	trace::Zone zone("Game::UpdateScoreText");
+	memory::Scope scope(memory::Subsystem::HUD);
+
 	SDL_Color text_color = { 0xFF, 0xFF, 0xFF, 0xFF };
 	const std::string score_text = "Score: " + std::to_string(score_);
 
 	score_info_->LoadFromText(renderer_, font_, score_text.c_str(), text_color);
+	hud_->Invalidate();
 }
 
 void Game::UpdateLivesText()
 {
+	if (headless_ || resimulating_)
+	{
+		return;
+	}
+
+	trace::Zone zone("Game::UpdateLivesText");
+	memory::Scope scope(memory::Subsystem::HUD);
+
 	SDL_Color text_color = { 0xFF, 0xFF, 0xFF, 0xFF };
 	const std::string lives_text = "Lives: " + std::to_string(player_->lives_);
 
 	lives_info_->LoadFromText(renderer_, font_, lives_text.c_str(), text_color);
+	hud_->Invalidate();
 }
 
 void Game::Run()
@@ -171,9 +687,16 @@ void Game::Run()
 		return;
 	}
 
+	if ((!options_.capture_path.empty() && !StartCapture()) || !StartStateHash() || !StartBroadcast() || !StartGovernor() || !StartReplay())
+	{
+		Finalize();
+		return;
+	}
+
 	is_running_ = true;
+	memory::ResetSubsystemReport();
 
-	constexpr long double ms = 1.0 / 60.0;
+	const long double ms = tick_seconds_;
 	std::uint64_t last_time = SDL_GetPerformanceCounter();
 	long double delta = 0.0;
 	
@@ -181,6 +704,9 @@ void Game::Run()
 
 	int frames = 0;
 	int ticks = 0;
+	bool first_frame = true;
+
+	const double counter_ms = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
 
 	while (is_running_)
 	{
@@ -192,30 +718,271 @@ void Game::Run()
 
 		HandleEvents();
 
+		const std::uint64_t tick_start = SDL_GetPerformanceCounter();
+		const std::uint64_t allocations = memory::ThreadAllocations();
+		int frame_ticks = 0;
+
 		while (delta >= ms)
 		{
-			Tick();
+			Step();
 			delta -= ms;
 			++ticks;
+			++frame_ticks;
 		}
 
+		const std::uint64_t tick_end = SDL_GetPerformanceCounter();
+		const std::uint64_t tick_allocations = memory::ThreadAllocations() - allocations;
+
 		//printf("%Lf\n", delta / ms);
 		Render();
+		CaptureFrame();
+
+		const std::uint64_t render_end = SDL_GetPerformanceCounter();
+
+		FrameSample sample;
+		sample.frame_ms = static_cast<double>(elapsed) * 1000.0;
+		sample.events_ms = static_cast<double>(tick_start - now) * counter_ms;
+		sample.tick_ms = static_cast<double>(tick_end - tick_start) * counter_ms;
+		sample.render_ms = static_cast<double>(render_end - tick_end) * counter_ms - present_ms_;
+		sample.present_ms = present_ms_;
+		sample.ticks = frame_ticks;
+		sample.draw_calls = draw_calls_;
+		sample.allocations = tick_allocations;
+		perf_overlay_->AddFrame(sample);
+		governor_.AddSample(sample.events_ms + sample.tick_ms + sample.render_ms, ticks_);
+
+		if (scenario_ != nullptr)
+		{
+			scenario_->RecordFrame(sample.frame_ms);
+			is_running_ = is_running_ && ticks_ < scenario_->Ticks();
+		}
+
+		if (first_frame && options_.startup_report)
+		{
+			const double startup_ms = static_cast<double>(SDL_GetPerformanceCounter() - startup_counter_) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+			printf("Startup: %.1f ms to first frame, assets from %s\n", startup_ms, bundle_->IsOpen() ? options_.bundle_path.c_str() : "res/ files");
+
+			for (const StartupPhase& phase : startup_phases_)
+			{
+				printf("  %-14s %-6s %8.2f ms -> %8.2f ms  (%.2f ms)\n", phase.name, phase.thread, phase.start_ms, phase.end_ms, phase.end_ms - phase.start_ms);
+			}
+		}
+
+		first_frame = false;
 		++frames;
 
 		if (SDL_GetTicks() - timer > 1000)
 		{
 			timer += 1000;
 			//printf("Frames: %d, Ticks: %d\n", frames, ticks);
+			memory::ReportSubsystems(1.0, "second");
 			frames = 0;
 			ticks = 0;
 		}
 	}
-}
 
-void Game::Reset()
-{
-	reset_game_ = false;
+	if (scenario_ != nullptr)
+	{
+		scenario_->Report();
+		spawn_scheduler_.PrintStats();
+	}
+
+	if (scenario_ != nullptr || replay_reader_ != nullptr)
+	{
+		hud_->PrintStats();
+	}
+}
+
+void Game::RunHeadless()
+{
+	headless_ = true;
+
+	if ((!options_.capture_path.empty() && !StartCapture()) || !StartStateHash() || !StartBroadcast() || !StartGovernor() || !StartReplay())
+	{
+		return;
+	}
+
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+	memory::ResetSubsystemReport();
+
+	// Playback runs to the end of the replay instead of for a set number of ticks.
+	const int ticks = replay_reader_ != nullptr ? static_cast<int>(replay_reader_->EndTick() - replay_reader_->Tick()) : options_.ticks;
+
+	for (int i = 0; i < ticks; ++i)
+	{
+		const std::uint64_t tick_start = governor_.Enabled() ? SDL_GetPerformanceCounter() : 0;
+
+		Step();
+		CaptureFrame();
+
+		if (governor_.Enabled())
+		{
+			governor_.AddSample(static_cast<double>(SDL_GetPerformanceCounter() - tick_start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()), ticks_);
+		}
+	}
+
+	const double elapsed_ms = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	printf("%s %d ticks in %.1f ms, score %d, %zu asteroids\n", replay_reader_ != nullptr ? "Replayed" : "Simulated", ticks, elapsed_ms, score_, asteroids_.size());
+
+	if (scenario_ != nullptr)
+	{
+		scenario_->Report();
+	}
+
+	spawn_scheduler_.PrintStats();
+	memory::ReportSubsystems(ticks * tick_seconds_, "simulated second");
+
+	if (governor_.Enabled())
+	{
+		printf("Governor: %zu decisions, ended at level %zu\n", governor_.decisions_, governor_.Level());
+	}
+
+	if (state_hash_ != nullptr)
+	{
+		printf("State hash: %zu ticks written to %s, %.2f us per tick\n", state_hash_->ticks_hashed_, options_.hash_path.c_str(), state_hash_->MicrosecondsPerTick());
+		state_hash_->Close();
+	}
+
+	if (replay_writer_ != nullptr)
+	{
+		replay_writer_->Close();
+	}
+}
+
+bool Game::StartCapture()
+{
+	if (font_ == nullptr)
+	{
+		if (TTF_WasInit() == 0 && TTF_Init() == -1)
+		{
+			printf("SDL_ttf could not be initialized, capturing without HUD! SDL_ttf Error: %s\n", TTF_GetError());
+		}
+		else if ((font_ = TTF_OpenFont(constants::font_path, constants::font_size)) == nullptr)
+		{
+			printf("Failed to load font, capturing without HUD! SDL_ttf Error: %s\n", TTF_GetError());
+		}
+	}
+
+	software_renderer_ = std::make_unique<SoftwareRenderer>(constants::screen_width, constants::screen_height, font_);
+	frame_capture_ = std::make_unique<FrameCapture>();
+
+	// Headless runs capture every tick; windowed ones every displayed frame.
+	const int frames_per_second = headless_ ? tick_rate_ : constants::frames_per_second;
+
+	return frame_capture_->Start(options_.capture_path, constants::screen_width, constants::screen_height, frames_per_second, options_.capture_queue_depth);
+}
+
+bool Game::StartStateHash()
+{
+	if (options_.hash_path.empty())
+	{
+		return true;
+	}
+
+	state_hash_ = std::make_unique<StateHash>();
+
+	return state_hash_->Open(options_.hash_path.c_str());
+}
+
+bool Game::StartGovernor()
+{
+	if (options_.governor.empty())
+	{
+		return true;
+	}
+
+	// Windowed samples cover a whole frame, with every catch-up tick and the render; headless ones a single tick.
+	const double budget_ms = headless_ ? 1000.0 / tick_rate_ : 1000.0 / constants::frames_per_second;
+
+	return governor_.Configure(options_.governor.c_str(), options_.governor_log_path.c_str(), budget_ms, tick_rate_);
+}
+
+bool Game::StartReplay()
+{
+	if (options_.record_path.empty() && options_.replay_path.empty())
+	{
+		return true;
+	}
+
+	// A replay holds input only, so everything else that steers the simulation has to be reproducible from it.
+	if ((!options_.record_path.empty() && !options_.replay_path.empty()) || scenario_ != nullptr || !options_.governor.empty() || options_.spawn_budget_us > 0.0)
+	{
+		printf("Replays cannot be combined with each other, --scenario, --governor or --spawn-budget-us\n");
+		return false;
+	}
+
+	if (!options_.record_path.empty())
+	{
+		const std::uint32_t keyframe_ticks = static_cast<std::uint32_t>(std::max(std::lround(options_.keyframe_seconds * tick_rate_), 1L));
+
+		replay_writer_ = std::make_unique<ReplayWriter>();
+
+		return replay_writer_->Open(options_.record_path.c_str(), *this, keyframe_ticks, options_.initial_asteroids, options_.spawn_budget);
+	}
+
+	replay_reader_ = std::make_unique<ReplayReader>();
+
+	if (!replay_reader_->Open(options_.replay_path.c_str()))
+	{
+		return false;
+	}
+
+	const replay::Header& info = replay_reader_->Info();
+	options_.initial_asteroids = static_cast<int>(info.initial_asteroids);
+	spawn_scheduler_.Configure(info.spawn_budget, 0.0);
+
+	const std::uint64_t start = replay_reader_->FirstTick() + static_cast<std::uint64_t>(std::max(std::lround(options_.seek_seconds * info.tick_rate), 0L));
+	const std::uint64_t seek_start = SDL_GetPerformanceCounter();
+
+	if (!replay_reader_->Seek(this, start))
+	{
+		return false;
+	}
+
+	printf("Replay: %llu ticks at %u Hz from %s, starting at tick %llu (%.2f ms to seek)\n", static_cast<unsigned long long>(replay_reader_->EndTick() - replay_reader_->FirstTick()), info.tick_rate, options_.replay_path.c_str(), static_cast<unsigned long long>(replay_reader_->Tick()), static_cast<double>(SDL_GetPerformanceCounter() - seek_start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()));
+
+	return true;
+}
+
+void Game::SeekReplay(double seconds)
+{
+	const std::int64_t offset = std::lround(seconds * tick_rate_);
+	const std::uint64_t current = replay_reader_->Tick();
+	const std::uint64_t target = offset < 0 && static_cast<std::uint64_t>(-offset) > current ? 0 : current + offset;
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+
+	replay_reader_->Seek(this, target);
+
+	printf("Replay: seek to tick %llu in %.2f ms\n", static_cast<unsigned long long>(replay_reader_->Tick()), static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()));
+}
+
+bool Game::StartBroadcast()
+{
+	if (!options_.broadcast)
+	{
+		return true;
+	}
+
+	spectator_ = std::make_unique<spectator::Publisher>();
+
+	return spectator_->Create(options_.spectator_channel.c_str());
+}
+
+void Game::CaptureFrame()
+{
+	if (frame_capture_ == nullptr || !frame_capture_->Active())
+	{
+		return;
+	}
+
+	software_renderer_->Render(*this);
+	frame_capture_->Submit(software_renderer_->Frame());
+}
+
+void Game::Reset()
+{
+	reset_game_ = false;
 	game_over_ = false;
 
 	score_ = 0;
@@ -226,15 +993,24 @@ void Game::Reset()
 
 	player_->ResetPlayer();
 
-	number_of_asteroids_ = 4;
-	asteroids_.clear();
+	for (const std::unique_ptr<Player>& remote_player : remote_players_)
+	{
+		remote_player->lives_ = 5;
+		remote_player->ResetPlayer();
+	}
+
+	number_of_asteroids_ = options_.initial_asteroids;
+	ClearAsteroids();
 	SpawnAsteroids(number_of_asteroids_);
 
 	bullets_.clear();
+	particles_->Clear();
 }
 
 void Game::HandleEvents()
 {
+	trace::Zone zone("Game::HandleEvents");
+
 	SDL_Event e;
 
 	while (SDL_PollEvent(&e) != 0)
@@ -243,6 +1019,12 @@ void Game::HandleEvents()
 		{
 			is_running_ = false;
 		}
+
+		if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET)
+		{
+			sprite_cache_->Clear();
+			hud_->Invalidate();
+		}
 		
 		if (e.type == SDL_KEYUP)
 		{
@@ -251,71 +1033,312 @@ void Game::HandleEvents()
 				info_toggled_ = !info_toggled_;
 			}
 
+			if (e.key.keysym.sym == SDLK_p)
+			{
+				perf_overlay_toggled_ = !perf_overlay_toggled_;
+			}
+
+			// Playback owns the simulation; only the view can be changed.
+			if (replay_reader_ != nullptr)
+			{
+				continue;
+			}
+
+			if (e.key.keysym.sym == SDLK_c)
+			{
+				asteroid_collisions_ = !asteroid_collisions_;
+			}
+
 			if (game_over_ && e.key.keysym.sym == SDLK_r)
 			{
 				reset_game_ = true;
 			}
 		}
-		
-		player_->HandleEvent(&e);
+
+		if (replay_reader_ != nullptr)
+		{
+			if (e.type == SDL_KEYDOWN && (e.key.keysym.sym == SDLK_LEFT || e.key.keysym.sym == SDLK_RIGHT))
+			{
+				SeekReplay(e.key.keysym.sym == SDLK_LEFT ? -constants::replay_seek_step_seconds : constants::replay_seek_step_seconds);
+			}
+		}
+		else if (local_player_)
+		{
+			const std::uint8_t buttons = player_->buttons_;
+			player_->HandleEvent(&e);
+
+			if (replay_writer_ != nullptr && player_->buttons_ != buttons)
+			{
+				replay_writer_->AddInput(player_->buttons_);
+			}
+		}
 	}
 }
 
-void Game::Tick()
+void Game::ApplyInput(std::uint8_t buttons)
 {
-	if (reset_game_)
+	if (!local_player_)
 	{
-		Reset();
+		return;
 	}
-	else if (player_->removed_) 
+
+	if (replay_writer_ != nullptr && buttons != player_->buttons_)
 	{
-		player_->ResetPlayer();
+		replay_writer_->AddInput(buttons);
 	}
-	else
+
+	player_->ApplyInput(buttons);
+}
+
+void Game::Step()
+{
+	if (replay_reader_ == nullptr)
 	{
-		player_->Tick();
+		Tick();
 	}
+	else if (!replay_reader_->Step(this))
+	{
+		printf("Replay: finished at tick %llu\n", static_cast<unsigned long long>(ticks_));
+		is_running_ = false;
+	}
+}
 
-	if (asteroids_.empty())
+void Game::Tick()
+{
+	trace::Zone zone("Game::Tick");
+	memory::Scope scope(memory::Subsystem::TICK);
+
+	if (replay_writer_ != nullptr && !resimulating_)
 	{
-		SpawnAsteroids(number_of_asteroids_++);
+		replay_writer_->Record(*this);
 	}
 
-	auto asteroid_it = asteroids_.begin();
+	splits_this_tick_ = 0;
 
-	while (asteroid_it != asteroids_.end())
+	if (scenario_ != nullptr)
 	{
-		if ((*asteroid_it)->removed_)
+		scenario_->BeforeTick(this);
+	}
+
+	{
+		trace::Zone ships_zone("Tick: ships");
+		memory::Scope ships_scope(memory::Subsystem::SHIPS);
+
+		if (reset_game_)
 		{
-			asteroid_it = asteroids_.erase(asteroid_it);
-			continue;
+			Reset();
+		}
+		else if (local_player_ && player_->removed_) 
+		{
+			player_->ResetPlayer();
+		}
+		else if (local_player_)
+		{
+			player_->Tick();
 		}
 
-		(*asteroid_it)->Tick();
-		++asteroid_it;
+		// Remote ships never end the game; one that runs out of lives rejoins with a fresh set.
+		for (const std::unique_ptr<Player>& remote_player : remote_players_)
+		{
+			if (!remote_player->removed_)
+			{
+				remote_player->Tick();
+				continue;
+			}
+
+			if (remote_player->lives_ <= 0)
+			{
+				remote_player->lives_ = 5;
+			}
+
+			remote_player->ResetPlayer();
+		}
 	}
 
-	auto bullet_it = bullets_.begin();
+	if (asteroids_.empty() && spawn_scheduler_.Idle())
+	{
+		QueueWave(number_of_asteroids_++);
+	}
+
+	{
+		memory::Scope spawns_scope(memory::Subsystem::SPAWNS);
+		spawn_scheduler_.Run(this, ticks_);
+	}
 
-	while (bullet_it != bullets_.end())
+	if (asteroid_collisions_)
 	{
-		if ((*bullet_it)->removed_)
+		HandleAsteroidCollisions();
+	}
+	else if (broadphase_.Size() != 0)
+	{
+		broadphase_.Clear();
+	}
+
+	{
+		trace::Zone asteroids_zone("Tick: asteroids");
+		memory::Scope asteroids_scope(memory::Subsystem::ASTEROIDS);
+
+		auto asteroid_it = asteroids_.begin();
+
+		while (asteroid_it != asteroids_.end())
 		{
-			bullet_it = bullets_.erase(bullet_it);
-			continue;
+			if ((*asteroid_it)->removed_)
+			{
+				asteroid_it = asteroids_.erase(asteroid_it);
+				continue;
+			}
+
+			(*asteroid_it)->Tick();
+			++asteroid_it;
 		}
+	}
 
-		(*bullet_it)->Tick();
-		++bullet_it;
+	{
+		trace::Zone bullets_zone("Tick: bullets");
+		memory::Scope bullets_scope(memory::Subsystem::BULLETS);
+
+		auto bullet_it = bullets_.begin();
+
+		while (bullet_it != bullets_.end())
+		{
+			if ((*bullet_it)->removed_)
+			{
+				bullet_it = bullets_.erase(bullet_it);
+				continue;
+			}
+
+			(*bullet_it)->Tick();
+			++bullet_it;
+		}
+	}
+
+	// Ticks replayed after a rollback were already shown; their effects and sounds are not repeated.
+	if (!resimulating_)
+	{
+		particles_->Update(static_cast<float>(tick_seconds_));
 	}
+
+	audio_->Flush();
+
+	if (CameraEnabled())
+	{
+		trace::Zone grids_zone("Tick: spatial grids");
+
+		asteroid_grid_.Rebuild(asteroids_, [](const Asteroid& asteroid)
+		{
+			return asteroid.center_;
+		});
+
+		bullet_grid_.Rebuild(bullets_, [](const Bullet& bullet)
+		{
+			return SDL_FPoint{ bullet.geometry_.x, bullet.geometry_.y };
+		});
+
+		UpdateCamera();
+	}
+
+	++ticks_;
+
+	if (state_hash_ != nullptr && !resimulating_)
+	{
+		state_hash_->Record(ticks_, *this);
+	}
+
+	if (spectator_ != nullptr && !resimulating_)
+	{
+		spectator_->Publish(*this);
+	}
+
+	if (scenario_ != nullptr)
+	{
+		scenario_->AfterTick(*this);
+	}
+}
+
+void Game::HandleAsteroidCollisions()
+{
+	trace::Zone zone("Tick: asteroid collisions");
+	memory::Scope scope(memory::Subsystem::COLLISION);
+
+	broadphase_.Update(asteroids_);
+	broadphase_.ResolveCollisions();
 }
 
 void Game::Render()
 {
+	trace::Zone zone("Game::Render");
+	memory::Scope scope(memory::Subsystem::RENDER);
+
+	int draw_calls = 1;
+	const bool cheap_render = governor_.Active(GovernorPolicy::CHEAP_RENDER);
+
+	if (score_text_dirty_)
+	{
+		UpdateScoreText();
+	}
+
 	SDL_RenderSetViewport(renderer_, NULL);
 	SDL_SetRenderDrawColor(renderer_, 0x00, 0x00, 0x00, 0xFF);
 	SDL_RenderClear(renderer_);
 
+	ForEachVisibleAsteroid([this, &draw_calls](const Asteroid& asteroid, float offset_x, float offset_y)
+	{
+		draw_calls += RenderPolygon(asteroid, offset_x, offset_y);
+	});
+
+	// The sprite path and an empty view leave the clear color set, so bullets set their own.
+	SDL_SetRenderDrawColor(renderer_, 0xFF, 0xFF, 0xFF, 0xFF);
+
+	ForEachVisibleBullet([&draw_calls](const Bullet& bullet, float offset_x, float offset_y)
+	{
+		bullet.Render(offset_x, offset_y);
+		++draw_calls;
+	});
+
+	if (!cheap_render)
+	{
+		trace::Zone particles_zone("Render: particles");
+		draw_calls += particles_->Render(renderer_, camera_.x, camera_.y);
+	}
+
+	SDL_SetRenderDrawColor(renderer_, 0xFF, 0xFF, 0xFF, 0xFF);
+
+	for (const std::unique_ptr<Player>& remote_player : remote_players_)
+	{
+		draw_calls += RenderPolygon(*remote_player, -camera_.x, -camera_.y);
+	}
+
+	if (!game_over_ && local_player_)
+	{
+		draw_calls += RenderPolygon(*player_, -camera_.x, -camera_.y);
+	}
+
+	// Which of the optional texts are shown is part of the layer's state; the textures themselves invalidate it.
+	draw_calls += hud_->Render(renderer_, (info_toggled_ ? 1u : 0u) | (game_over_ ? 2u : 0u), [this]()
+	{
+		return ComposeHud();
+	});
+
+	if (perf_overlay_toggled_)
+	{
+		draw_calls += perf_overlay_->Render(renderer_, asteroids_.size(), bullets_.size(), particles_->Count());
+	}
+
+	draw_calls_ = draw_calls;
+
+	trace::Zone present_zone("SDL_RenderPresent");
+	const std::uint64_t present_start = SDL_GetPerformanceCounter();
+	SDL_RenderPresent(renderer_);
+	present_ms_ = static_cast<double>(SDL_GetPerformanceCounter() - present_start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+int Game::ComposeHud()
+{
+	trace::Zone zone("Game::ComposeHud");
+	memory::Scope scope(memory::Subsystem::HUD);
+
+	int draw_calls = 3;
+
 	score_info_->Render(renderer_, (constants::screen_width / 4) - (score_info_->Width() / 2), 0);
 	lives_info_->Render(renderer_, (constants::screen_width * (3.0 / 4.0)) - (lives_info_->Width() / 2), 0);
 	toggle_info_->Render(renderer_, (constants::screen_width / 2) - (toggle_info_->Width() / 2), constants::screen_height - toggle_info_->Height());
@@ -323,28 +1346,53 @@ void Game::Render()
 	if (info_toggled_)
 	{
 		info_->Render(renderer_, 10, constants::screen_height - info_->Height());
+		++draw_calls;
 	}
 
-	for (const std::unique_ptr<Asteroid>& asteroid : asteroids_)
+	if (game_over_)
 	{
-		asteroid->Render();
+		game_over_info_->Render(renderer_, (constants::screen_width / 2) - (game_over_info_->Width() / 2), (constants::screen_height / 2) - (game_over_info_->Height() / 2));
+		++draw_calls;
 	}
 
-	for (const std::unique_ptr<Bullet>& bullet : bullets_)
-	{
-		bullet->Render();
-	}
+	return draw_calls;
+}
 
-	if (!game_over_)
+int Game::RenderPolygon(const LinePolygon& polygon, float offset_x, float offset_y)
+{
+	const bool sprites = render_path_ == RenderPath::SPRITES || governor_.Active(GovernorPolicy::CHEAP_RENDER);
+
+	if (sprites && sprite_cache_->Render(renderer_, polygon, offset_x, offset_y))
 	{
-		player_->Render();
+		return 1;
 	}
-	else
+
+	polygon.Render(offset_x, offset_y);
+
+	// One line per edge plus setting the color.
+	return static_cast<int>(polygon.Geometry().size()) + 1;
+}
+
+void Game::UpdateCamera()
+{
+	if (!CameraEnabled())
 	{
-		game_over_info_->Render(renderer_, (constants::screen_width / 2) - (game_over_info_->Width() / 2), (constants::screen_height / 2) - (game_over_info_->Height() / 2));
+		camera_ = { 0.0f, 0.0f };
+		return;
 	}
 
-	SDL_RenderPresent(renderer_);
+	camera_.x = player_->center_.x - (constants::screen_width / 2.0f);
+	camera_.y = player_->center_.y - (constants::screen_height / 2.0f);
+}
+
+bool Game::CameraEnabled() const
+{
+	return world_width_ > constants::screen_width || world_height_ > constants::screen_height;
+}
+
+const SDL_FPoint& Game::Camera() const
+{
+	return camera_;
 }
 
 SDL_Renderer* Game::Renderer() const
@@ -352,31 +1400,145 @@ SDL_Renderer* Game::Renderer() const
 	return renderer_;
 }
 
-const std::list<std::unique_ptr<Asteroid>>& Game::Asteroids()
+int Game::DrawCalls() const
+{
+	return draw_calls_;
+}
+
+double Game::PresentMs() const
+{
+	return present_ms_;
+}
+
+const std::list<std::unique_ptr<Asteroid>>& Game::Asteroids() const
 {
 	return asteroids_;
 }
 
+const std::list<std::unique_ptr<Bullet>>& Game::Bullets() const
+{
+	return bullets_;
+}
+
+const Player& Game::GetPlayer() const
+{
+	return *player_;
+}
+
+const std::vector<std::unique_ptr<Player>>& Game::RemotePlayers() const
+{
+	return remote_players_;
+}
+
+Player* Game::AddRemotePlayer()
+{
+	constexpr double spawn_radius = 150.0;
+	const double angle = static_cast<double>(remote_players_.size() + 1) * std::acos(-1.0) / 4.0;
+
+	std::unique_ptr<Player> remote_player = std::make_unique<Player>(this, 5);
+	remote_player->local_ = false;
+	remote_player->spawn_offset_ = { static_cast<float>(std::cos(angle) * spawn_radius), static_cast<float>(std::sin(angle) * spawn_radius) };
+	remote_player->ResetPlayer();
+
+	remote_players_.push_back(std::move(remote_player));
+
+	return remote_players_.back().get();
+}
+
+void Game::RemoveRemotePlayer(const Player* player)
+{
+	remote_players_.erase(std::remove_if(remote_players_.begin(), remote_players_.end(), [player](const std::unique_ptr<Player>& remote_player)
+	{
+		return remote_player.get() == player;
+	}), remote_players_.end());
+}
+
+const SweepAndPrune& Game::Broadphase() const
+{
+	return broadphase_;
+}
+
+const SpawnScheduler& Game::Spawner() const
+{
+	return spawn_scheduler_;
+}
+
+const std::vector<StartupPhase>& Game::StartupPhases() const
+{
+	return startup_phases_;
+}
+
+ParticleSystem* Game::Particles() const
+{
+	return particles_.get();
+}
+
 void Game::PlayShootSound() const
 {
-	Mix_PlayChannel(-1, shoot_sfx_, 0);
+	if (headless_ || resimulating_)
+	{
+		return;
+	}
+
+	audio_->Play(shoot_sfx_);
 }
 	
 void Game::PlayAsteroidExplosionSound() const
 {
-	Mix_PlayChannel(-1, asteroid_explosion_sfx_, 0);
+	if (headless_ || resimulating_)
+	{
+		return;
+	}
+
+	audio_->Play(asteroid_explosion_sfx_);
 }
 
 void Game::AddBullet(double x, double y, double vx, double vy)
 {
+	if (governor_.Active(GovernorPolicy::CAP_BULLETS) && bullets_.size() >= PerformanceGovernor::bullet_cap)
+	{
+		return;
+	}
+
 	bullets_.push_front(std::make_unique<Bullet>(this, x, y, vx, vy));
 }
 
+void Game::AddExplosion(const Asteroid& asteroid)
+{
+	if (resimulating_)
+	{
+		return;
+	}
+
+	const int count = asteroid.type_ == AsteroidType::LARGE ? 64 : (asteroid.type_ == AsteroidType::MEDIUM ? 32 : 16);
+	const float speed = static_cast<float>(std::sqrt(asteroid.furthest_distance_squared_)) * 3.0f;
+
+	particles_->Emit(asteroid.center_.x, asteroid.center_.y, asteroid.velocity_vector_.x, asteroid.velocity_vector_.y, count, speed, 0.8f);
+}
+
+void Game::AddThrust(const SDL_FPoint& position, const SDL_FPoint& direction)
+{
+	if (resimulating_)
+	{
+		return;
+	}
+
+	particles_->EmitCone(position.x, position.y, -direction.x, -direction.y, 3, 180.0f, 0.6f, 0.35f);
+}
+
 void Game::SpawnAsteroids(int amount)
 {
-	SDL_FPoint points[4] = { { -1.0, 0.0 }, { -1.0, constants::screen_height }, { 0, -1.0 }, { constants::screen_width, 0.0 } };
-	std::uniform_real_distribution<double> random_vector_x_{ -2, 2 };
-  	std::uniform_real_distribution<double> random_vector_y_{ -2, 2 };
+	QueueWave(amount);
+	spawn_scheduler_.Flush(this, ticks_);
+}
+
+void Game::QueueWave(int amount)
+{
+	trace::Zone zone("Game::QueueWave");
+
+	SDL_FPoint points[4] = { { -1.0, 0.0 }, { -1.0, static_cast<float>(world_height_) }, { 0, -1.0 }, { static_cast<float>(world_width_), 0.0 } };
+	std::uniform_real_distribution<double> random_vector_x_{ -constants::wave_speed, constants::wave_speed };
+  	std::uniform_real_distribution<double> random_vector_y_{ -constants::wave_speed, constants::wave_speed };
 
 	 for (int i = 0; i < amount; ++i)
 	 {
@@ -385,11 +1547,61 @@ void Game::SpawnAsteroids(int amount)
  		spawn_point.x = spawn_point.x == -1 ? random_x_(mt_) : spawn_point.x;
  		spawn_point.y = spawn_point.y == -1 ? random_y_(mt_) : spawn_point.y;
 
-	 	asteroids_.push_back(std::make_unique<Asteroid>(this, AsteroidType::LARGE, spawn_point.x, spawn_point.y, random_vector_x_(mt_), random_vector_y_(mt_)));
+ 		// In an arena larger than the screen, scatter the wave over the world, outside the player's view. A world only
+ 		// a little larger than the screen may have no such point, so after a few tries the one furthest out is taken.
+ 		if (CameraEnabled())
+ 		{
+ 			double best_distance = -1.0;
+
+ 			for (int attempt = 0; attempt < constants::spawn_attempts && best_distance < 1.0; ++attempt)
+ 			{
+ 				const double x = random_x_(mt_);
+ 				const double y = random_y_(mt_);
+
+ 				double dx = std::fabs(x - player_->center_.x);
+ 				double dy = std::fabs(y - player_->center_.y);
+ 				dx = std::min(dx, world_width_ - dx);
+ 				dy = std::min(dy, world_height_ - dy);
+
+ 				// At least 1 once the point is outside the view on either axis.
+ 				const double distance = std::max(dx / (constants::screen_width / 2.0 + constants::cull_margin), dy / (constants::screen_height / 2.0 + constants::cull_margin));
+
+ 				if (distance > best_distance)
+ 				{
+ 					best_distance = distance;
+ 					spawn_point.x = static_cast<float>(x);
+ 					spawn_point.y = static_cast<float>(y);
+ 				}
+ 			}
+ 		}
+
+	 	const double vx = random_vector_x_(mt_);
+	 	const double vy = random_vector_y_(mt_);
+
+	 	QueueAsteroid(AsteroidType::LARGE, spawn_point.x, spawn_point.y, vx, vy);
 	 }
 }
 
+bool Game::AllowSplit()
+{
+	return !governor_.Active(GovernorPolicy::CAP_SPLITS) || splits_this_tick_++ < PerformanceGovernor::splits_per_tick;
+}
+
+void Game::QueueAsteroid(AsteroidType type, double x, double y, double vx, double vy)
+{
+	spawn_scheduler_.Push(type, x, y, vx, vy, ticks_);
+}
+
 void Game::AddAsteroid(std::unique_ptr<Asteroid> asteroid)
 {
+	asteroid->id_ = next_entity_id_++;
 	asteroids_.push_back(std::move(asteroid));
 }
+
+void Game::ClearAsteroids()
+{
+	broadphase_.Clear();
+	asteroid_grid_.Clear();
+	asteroids_.clear();
+	spawn_scheduler_.Clear();
+}
@@ -0,0 +1,59 @@
+#include "HudLayer.hpp"
+
+#include <cstdio>
+
+HudLayer::HudLayer() :
+	target_(nullptr),
+	dirty_(true),
+	state_(0),
+	compositions_(0),
+	frames_(0)
+{
+}
+
+HudLayer::~HudLayer()
+{
+	Free();
+}
+
+bool HudLayer::Create(SDL_Renderer* renderer, int width, int height)
+{
+	Free();
+	dirty_ = true;
+
+	if (!SDL_RenderTargetSupported(renderer))
+	{
+		return false;
+	}
+
+	target_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+
+	if (target_ == nullptr)
+	{
+		printf("Unable to create HUD texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	SDL_SetTextureBlendMode(target_, SDL_BLENDMODE_BLEND);
+
+	return true;
+}
+
+void HudLayer::Free()
+{
+	if (target_ != nullptr)
+	{
+		SDL_DestroyTexture(target_);
+		target_ = nullptr;
+	}
+}
+
+void HudLayer::Invalidate()
+{
+	dirty_ = true;
+}
+
+void HudLayer::PrintStats() const
+{
+	printf("HUD: composed %zu times in %zu frames%s\n", compositions_, frames_, target_ == nullptr ? " (no render target, drawn directly)" : "");
+}
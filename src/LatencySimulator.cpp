@@ -0,0 +1,78 @@
+#include "LatencySimulator.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace net
+{
+	namespace
+	{
+		constexpr std::size_t max_queued_packets = 256;
+	} // namespace
+
+	LatencySimulator::LatencySimulator(UdpSocket* socket) : socket_(socket), mt_(1), queue_(max_queued_packets), queued_(0), sent_(0), lost_(0)
+	{
+	}
+
+	void LatencySimulator::Configure(const LinkConditions& conditions, std::uint32_t seed)
+	{
+		conditions_ = conditions;
+		mt_.seed(seed);
+		queued_ = 0;
+	}
+
+	void LatencySimulator::Send(const sockaddr_in& address, const std::uint8_t* data, std::size_t size, double now)
+	{
+		++sent_;
+
+		if (conditions_.loss > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(mt_) < conditions_.loss)
+		{
+			++lost_;
+			return;
+		}
+
+		if (conditions_.latency_ms <= 0.0 && conditions_.jitter_ms <= 0.0)
+		{
+			socket_->Send(address, data, size);
+			return;
+		}
+
+		// A full queue behaves like a congested link.
+		if (queued_ == queue_.size() || size > max_packet_size)
+		{
+			++lost_;
+			return;
+		}
+
+		const double jitter = conditions_.jitter_ms > 0.0 ? std::uniform_real_distribution<double>(-conditions_.jitter_ms, conditions_.jitter_ms)(mt_) : 0.0;
+		Packet& packet = queue_[queued_++];
+
+		packet.release = now + std::max(conditions_.latency_ms + jitter, 0.0) / 1000.0;
+		packet.address = address;
+		packet.size = size;
+		std::memcpy(packet.data.data(), data, size);
+	}
+
+	void LatencySimulator::Flush(double now)
+	{
+		std::size_t kept = 0;
+
+		for (std::size_t i = 0; i < queued_; ++i)
+		{
+			if (queue_[i].release <= now)
+			{
+				socket_->Send(queue_[i].address, queue_[i].data.data(), queue_[i].size);
+				continue;
+			}
+
+			if (kept != i)
+			{
+				queue_[kept] = queue_[i];
+			}
+
+			++kept;
+		}
+
+		queued_ = kept;
+	}
+} // namespace net
@@ -4,11 +4,12 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <cmath>
 
-LinePolygon::LinePolygon(Game* game) : game_(game), furthest_distance_squared_(std::numeric_limits<double>::min()), removed_(false)
+LinePolygon::LinePolygon(Game* game) : game_(game), furthest_distance_squared_(std::numeric_limits<double>::min()), removed_(false), mesh_id_(-1), angle_(0.0)
 {
 	center_.x = 0.0;
 	center_.y = 0.0;
@@ -18,7 +19,7 @@ LinePolygon::LinePolygon(Game* game) : game_(game), furthest_distance_squared_(s
 	velocity_vector_.y = 0.0;
 }
 
-void LinePolygon::Render()
+void LinePolygon::Render(float offset_x, float offset_y) const
 {
 	SDL_SetRenderDrawColor(game_->Renderer(), 0xFF, 0xFF, 0xFF, 0xFF);        
 
@@ -27,11 +28,11 @@ void LinePolygon::Render()
 		const int current_index = i;
 		const int next_index = (i + 1) % geometry_.size();
     	
-    	SDL_RenderDrawLineF(game_->Renderer(), geometry_[current_index].x, geometry_[current_index].y, geometry_[next_index].x, geometry_[next_index].y);
+    	SDL_RenderDrawLineF(game_->Renderer(), geometry_[current_index].x + offset_x, geometry_[current_index].y + offset_y, geometry_[next_index].x + offset_x, geometry_[next_index].y + offset_y);
 	}
 }
 
-const std::vector<SDL_FPoint>& LinePolygon::Geometry()
+const std::vector<SDL_FPoint>& LinePolygon::Geometry() const
 {
 	return geometry_;
 }
@@ -45,6 +46,11 @@ void LinePolygon::AddPoint(double x, double y)
 	geometry_.push_back(point);
 }
 
+void LinePolygon::SetGeometry(const SDL_FPoint* points, std::size_t count)
+{
+	geometry_.assign(points, points + count);
+}
+
 void LinePolygon::TranslateGeometry(double x, double y)
 {
 	center_.x += x;
@@ -57,9 +63,9 @@ void LinePolygon::TranslateGeometry(double x, double y)
 	}
 }
 
-void LinePolygon::RotateGeometry(int degrees)
+void LinePolygon::RotateGeometry(double degrees)
 {
-	if (degrees == 0)
+	if (degrees == 0.0)
 	{
 		return;
 	}
@@ -68,14 +74,21 @@ void LinePolygon::RotateGeometry(int degrees)
 	{
 		point = RotatePoint(point, center_, degrees);
 	}
+
+	angle_ = std::fmod(angle_ + degrees, 360.0);
+
+	if (angle_ < 0.0)
+	{
+		angle_ += 360.0;
+	}
 }
 
-SDL_FPoint LinePolygon::RotatePoint(const SDL_FPoint& point, const SDL_FPoint& pivot, int degrees)
+SDL_FPoint LinePolygon::RotatePoint(const SDL_FPoint& point, const SDL_FPoint& pivot, double degrees)
 {
 	SDL_FPoint result_point = point;
 
 	const double pi = std::acos(-1);
-	const double deg_to_rad = static_cast<double>(degrees) * pi / 180.0;
+	const double deg_to_rad = degrees * pi / 180.0;
 	const double sin_degrees = std::sin(deg_to_rad);
 	const double cos_degrees = std::cos(deg_to_rad);
 
@@ -110,6 +123,9 @@ void LinePolygon::VecSetLength(SDL_FPoint* vector, double length)
 
 void LinePolygon::WrapGeometryAroundScreen()
 {
+	const double world_width = game_->world_width_;
+	const double world_height = game_->world_height_;
+
 	bool out_of_left = std::all_of(geometry_.begin(), geometry_.end(), [](const SDL_FPoint& point)
 	{
 		return point.x < 0;
@@ -117,26 +133,26 @@ void LinePolygon::WrapGeometryAroundScreen()
 
 	if (out_of_left)
 	{
-		center_.x += constants::screen_width;
+		center_.x += world_width;
 
 		for (SDL_FPoint& point : geometry_)
 		{
-			point.x += constants::screen_width;
+			point.x += world_width;
 		}
 	}
 
-	bool out_of_right = std::all_of(geometry_.begin(), geometry_.end(), [](const SDL_FPoint& point)
+	bool out_of_right = std::all_of(geometry_.begin(), geometry_.end(), [world_width](const SDL_FPoint& point)
 	{
-		return point.x > constants::screen_width;
+		return point.x > world_width;
 	});
 
 	if (out_of_right)
 	{
-		center_.x -= constants::screen_width;
+		center_.x -= world_width;
 
 		for (SDL_FPoint& point : geometry_)
 		{
-			point.x -= constants::screen_width;
+			point.x -= world_width;
 		}
 	}
 
@@ -147,26 +163,26 @@ void LinePolygon::WrapGeometryAroundScreen()
 
 	if (out_of_top)
 	{
-		center_.y += constants::screen_height;
+		center_.y += world_height;
 
 		for (SDL_FPoint& point : geometry_)
 		{
-			point.y += constants::screen_height;
+			point.y += world_height;
 		}
 	}
 
-	bool out_of_bottom = std::all_of(geometry_.begin(), geometry_.end(), [](const SDL_FPoint& point)
+	bool out_of_bottom = std::all_of(geometry_.begin(), geometry_.end(), [world_height](const SDL_FPoint& point)
 	{
-		return point.y > constants::screen_height;
+		return point.y > world_height;
 	});
 
 	if (out_of_bottom)
 	{
-		center_.y -= constants::screen_height;
+		center_.y -= world_height;
 
 		for (SDL_FPoint& point : geometry_)
 		{
-			point.y -= constants::screen_height;
+			point.y -= world_height;
 		}
 	}
 }
\ No newline at end of file
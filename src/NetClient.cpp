@@ -0,0 +1,499 @@
+#include "NetClient.hpp"
+#include "Player.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+namespace
+{
+	constexpr double hello_interval_seconds = 0.25;
+	constexpr double connect_timeout_seconds = 5.0;
+
+	double SecondsSince(std::uint64_t start)
+	{
+		return static_cast<double>(SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+
+	// Says hello until every client has been welcomed or the timeout passes.
+	bool Connect(const std::vector<net::Client*>& clients)
+	{
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		double next_hello = 0.0;
+
+		while (SecondsSince(start) < connect_timeout_seconds)
+		{
+			bool all_connected = true;
+
+			for (net::Client* client : clients)
+			{
+				client->Receive();
+				all_connected = all_connected && client->Connected();
+			}
+
+			if (all_connected)
+			{
+				return true;
+			}
+
+			if (SecondsSince(start) >= next_hello)
+			{
+				for (net::Client* client : clients)
+				{
+					if (!client->Connected())
+					{
+						client->SendHello();
+					}
+				}
+
+				next_hello += hello_interval_seconds;
+			}
+
+			SDL_Delay(2);
+		}
+
+		return false;
+	}
+
+	void DrawMesh(SDL_Renderer* renderer, const SDL_FPoint* mesh, int count, float x, float y, double degrees)
+	{
+		const double radians = degrees * std::acos(-1.0) / 180.0;
+		const float c = static_cast<float>(std::cos(radians));
+		const float s = static_cast<float>(std::sin(radians));
+		SDL_FPoint points[9];
+
+		for (int i = 0; i <= count; ++i)
+		{
+			const SDL_FPoint& point = mesh[i % count];
+			points[i] = { x + (point.x * c) - (point.y * s), y + (point.x * s) + (point.y * c) };
+		}
+
+		SDL_RenderDrawLinesF(renderer, points, count + 1);
+	}
+} // namespace
+
+namespace net
+{
+	Client::Client() : server_{}, connected_(false), slot_(0), sequence_(0), latest_tick_(0), world_width_(constants::screen_width), world_height_(constants::screen_height), score_(0), lives_(0)
+	{
+	}
+
+	bool Client::Open(const char* host, std::uint16_t port)
+	{
+		return UdpSocket::Resolve(host, port, &server_) && socket_.Open(0);
+	}
+
+	void Client::Send(const ByteWriter& writer, const std::uint8_t* data)
+	{
+		socket_.Send(server_, data, writer.Size());
+		stats_.bytes_sent += writer.Size();
+	}
+
+	void Client::SendHello()
+	{
+		std::uint8_t data[1];
+		ByteWriter writer(data, sizeof(data));
+		writer.U8(static_cast<std::uint8_t>(PacketType::HELLO));
+		Send(writer, data);
+	}
+
+	void Client::SendInput(std::uint8_t buttons)
+	{
+		std::uint8_t data[16];
+		ByteWriter writer(data, sizeof(data));
+		writer.U8(static_cast<std::uint8_t>(PacketType::INPUT));
+		writer.U32(++sequence_);
+		writer.U32(latest_tick_);
+		writer.U8(buttons);
+		Send(writer, data);
+	}
+
+	void Client::SendBye()
+	{
+		std::uint8_t data[1];
+		ByteWriter writer(data, sizeof(data));
+		writer.U8(static_cast<std::uint8_t>(PacketType::BYE));
+		Send(writer, data);
+	}
+
+	void Client::Receive()
+	{
+		std::uint8_t buffer[max_packet_size];
+		sockaddr_in from;
+		int received;
+
+		while ((received = socket_.Receive(buffer, sizeof(buffer), &from)) >= 0)
+		{
+			if (from.sin_addr.s_addr != server_.sin_addr.s_addr || from.sin_port != server_.sin_port)
+			{
+				continue;
+			}
+
+			stats_.bytes_received += static_cast<std::size_t>(received);
+
+			ByteReader reader(buffer, static_cast<std::size_t>(received));
+			const PacketType type = static_cast<PacketType>(reader.U8());
+
+			if (type == PacketType::WELCOME)
+			{
+				slot_ = reader.U8();
+				world_width_ = reader.U32();
+				world_height_ = reader.U32();
+				connected_ = !reader.Error();
+			}
+			else if (type == PacketType::SNAPSHOT && connected_)
+			{
+				HandleSnapshot(&reader);
+			}
+		}
+	}
+
+	void Client::HandleSnapshot(ByteReader* reader)
+	{
+		const std::uint64_t decode_start = SDL_GetPerformanceCounter();
+		const std::uint32_t tick = reader->U32();
+		const std::uint32_t baseline_tick = reader->U32();
+		const int score = static_cast<int>(reader->U32());
+		const int lives = reader->U8();
+
+		// Anything older than what we already have arrived out of order and is of no use.
+		if (tick <= latest_tick_)
+		{
+			++stats_.stale_snapshots;
+			return;
+		}
+
+		static const std::vector<EntityState> no_baseline;
+		const History& baseline = history_[baseline_tick % history_size];
+
+		if (baseline_tick != 0 && baseline.tick != baseline_tick)
+		{
+			++stats_.decode_errors;
+			return;
+		}
+
+		if (!DecodeDelta(baseline_tick != 0 ? baseline.entities : no_baseline, reader, &decoded_))
+		{
+			++stats_.decode_errors;
+			return;
+		}
+
+		const std::uint32_t bullet_count = std::min<std::uint32_t>(reader->VarUint(), max_snapshot_bullets);
+		bullets_.resize(bullet_count);
+
+		for (BulletPosition& bullet : bullets_)
+		{
+			bullet.x = reader->U16();
+			bullet.y = reader->U16();
+		}
+
+		if (reader->Error())
+		{
+			++stats_.decode_errors;
+			return;
+		}
+
+		History& history = history_[tick % history_size];
+		history.tick = tick;
+		history.entities.swap(decoded_);
+
+		latest_tick_ = tick;
+		score_ = score;
+		lives_ = lives;
+
+		++stats_.snapshots;
+		stats_.full_snapshots += baseline_tick == 0 ? 1 : 0;
+		stats_.decode_us_total += SecondsSince(decode_start) * 1e6;
+	}
+
+	bool Client::Connected() const
+	{
+		return connected_;
+	}
+
+	std::uint32_t Client::ShipId() const
+	{
+		return ship_id_base + slot_;
+	}
+
+	std::uint32_t Client::LatestTick() const
+	{
+		return latest_tick_;
+	}
+
+	const std::vector<EntityState>& Client::Entities() const
+	{
+		return history_[latest_tick_ % history_size].entities;
+	}
+
+	const std::vector<BulletPosition>& Client::Bullets() const
+	{
+		return bullets_;
+	}
+
+	int RunClient(const Options& options)
+	{
+		std::unique_ptr<Client> client = std::make_unique<Client>();
+
+		if (!client->Open(options.connect_host.c_str(), options.port))
+		{
+			return 1;
+		}
+
+		printf("Connecting to %s:%u\n", options.connect_host.c_str(), options.port);
+
+		if (!Connect({ client.get() }))
+		{
+			printf("No answer from %s:%u\n", options.connect_host.c_str(), options.port);
+			return 1;
+		}
+
+		if (SDL_Init(SDL_INIT_VIDEO) < 0)
+		{
+			printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+			return 1;
+		}
+
+		SDL_Window* window = SDL_CreateWindow(constants::game_title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, constants::screen_width, constants::screen_height, SDL_WINDOW_SHOWN);
+		SDL_Renderer* renderer = window == nullptr ? nullptr : SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+
+		if (renderer == nullptr)
+		{
+			printf("Window or renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+			SDL_DestroyWindow(window);
+			SDL_Quit();
+			return 1;
+		}
+
+		// Meshes at AsteroidType::SMALL size; larger kinds are scaled like Asteroid does.
+		SDL_FPoint asteroid_mesh[8];
+
+		for (int i = 0; i < 8; ++i)
+		{
+			const double angle = i * std::acos(-1.0) / 4.0;
+			asteroid_mesh[i] = { static_cast<float>(std::cos(angle) * 20.0), static_cast<float>(std::sin(angle) * 20.0) };
+		}
+
+		const SDL_FPoint ship_mesh[3] = { { -12.0f, 10.0f }, { 12.0f, 10.0f }, { 0.0f, -30.0f } };
+		const float asteroid_scales[3] = { 4.0f, 2.0f, 1.0f };
+
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		const double tick_seconds = 1.0 / constants::ticks_per_second;
+		double next_tick = 0.0;
+		double next_title = 1.0;
+		std::size_t title_bytes = 0;
+		bool running = true;
+
+		while (running)
+		{
+			SDL_Event e;
+
+			while (SDL_PollEvent(&e) != 0)
+			{
+				running = running && e.type != SDL_QUIT && !(e.type == SDL_KEYUP && e.key.keysym.sym == SDLK_ESCAPE);
+			}
+
+			client->Receive();
+
+			const double now = SecondsSince(start);
+
+			if (now >= next_tick)
+			{
+				const Uint8* keys = SDL_GetKeyboardState(nullptr);
+				std::uint8_t buttons = 0;
+				buttons |= keys[SDL_SCANCODE_LEFT] ? input::LEFT : 0;
+				buttons |= keys[SDL_SCANCODE_RIGHT] ? input::RIGHT : 0;
+				buttons |= keys[SDL_SCANCODE_UP] ? input::THRUST : 0;
+				buttons |= keys[SDL_SCANCODE_SPACE] ? input::FIRE : 0;
+
+				client->SendInput(buttons);
+				next_tick = std::max(next_tick + tick_seconds, now - 0.25);
+			}
+
+			if (now >= next_title)
+			{
+				char title[128];
+				snprintf(title, sizeof(title), "%s - score %d, lives %d, %.1f KB/s", constants::game_title, client->score_, client->lives_, static_cast<double>(client->stats_.bytes_received - title_bytes) / 1024.0);
+				SDL_SetWindowTitle(window, title);
+
+				title_bytes = client->stats_.bytes_received;
+				next_title += 1.0;
+			}
+
+			const std::vector<EntityState>& entities = client->Entities();
+			const auto own_ship = std::find_if(entities.begin(), entities.end(), [&client](const EntityState& entity)
+			{
+				return entity.id == client->ShipId();
+			});
+
+			// Positions are drawn relative to the ship, taking the short way around the world seam.
+			const std::uint16_t camera_x = own_ship != entities.end() ? own_ship->x : 0x8000;
+			const std::uint16_t camera_y = own_ship != entities.end() ? own_ship->y : 0x8000;
+			const double scale_x = client->world_width_ / 65536.0;
+			const double scale_y = client->world_height_ / 65536.0;
+
+			auto to_screen = [&](std::uint16_t x, std::uint16_t y)
+			{
+				return SDL_FPoint{ static_cast<float>(static_cast<std::int16_t>(static_cast<std::uint16_t>(x - camera_x)) * scale_x + constants::screen_width / 2.0), static_cast<float>(static_cast<std::int16_t>(static_cast<std::uint16_t>(y - camera_y)) * scale_y + constants::screen_height / 2.0) };
+			};
+
+			SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+			SDL_RenderClear(renderer);
+			SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+
+			for (const EntityState& entity : entities)
+			{
+				const SDL_FPoint position = to_screen(entity.x, entity.y);
+				const double degrees = DequantizeAngle(entity.angle);
+
+				if (entity.kind == ship_kind)
+				{
+					DrawMesh(renderer, ship_mesh, 3, position.x, position.y, degrees);
+					continue;
+				}
+
+				SDL_FPoint scaled[8];
+				const float scale = asteroid_scales[std::min<int>(entity.kind, 2)];
+
+				for (int i = 0; i < 8; ++i)
+				{
+					scaled[i] = { asteroid_mesh[i].x * scale, asteroid_mesh[i].y * scale };
+				}
+
+				DrawMesh(renderer, scaled, 8, position.x, position.y, degrees);
+			}
+
+			for (const BulletPosition& bullet : client->Bullets())
+			{
+				const SDL_FPoint position = to_screen(bullet.x, bullet.y);
+				const SDL_FRect rect = { position.x - 1.0f, position.y - 1.0f, 3.0f, 3.0f };
+				SDL_RenderFillRectF(renderer, &rect);
+			}
+
+			SDL_RenderPresent(renderer);
+			SDL_Delay(1);
+		}
+
+		client->SendBye();
+
+		printf("Received %zu snapshots, %zu full, %zu stale, %zu decode errors, %.1f us per decode\n", client->stats_.snapshots, client->stats_.full_snapshots, client->stats_.stale_snapshots, client->stats_.decode_errors, client->stats_.decode_us_total / std::max<std::size_t>(client->stats_.snapshots, 1));
+
+		SDL_DestroyRenderer(renderer);
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+
+		return 0;
+	}
+
+	int RunLoadTest(const Options& options)
+	{
+		std::vector<std::unique_ptr<Client>> clients;
+		std::vector<Client*> pending;
+
+		for (int i = 0; i < options.load_test_clients; ++i)
+		{
+			clients.push_back(std::make_unique<Client>());
+
+			if (!clients.back()->Open(options.connect_host.c_str(), options.port))
+			{
+				return 1;
+			}
+
+			pending.push_back(clients.back().get());
+		}
+
+		if (!Connect(pending))
+		{
+			printf("Not every bot was welcomed by %s:%u; is the server running and not full?\n", options.connect_host.c_str(), options.port);
+			return 1;
+		}
+
+		printf("Load test: %zu bots on %s:%u for %d ticks\n", clients.size(), options.connect_host.c_str(), options.port, options.ticks);
+
+		std::mt19937 mt(static_cast<std::uint32_t>(options.seed.value_or(1)));
+		std::uniform_int_distribution<int> random_buttons{ 0, input::LEFT | input::RIGHT | input::THRUST | input::FIRE };
+		std::vector<std::uint8_t> buttons(clients.size(), 0);
+
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		const double tick_seconds = 1.0 / constants::ticks_per_second;
+		ClientStats previous;
+		double previous_seconds = 0.0;
+
+		auto total_stats = [&clients]()
+		{
+			ClientStats total;
+
+			for (const std::unique_ptr<Client>& client : clients)
+			{
+				total.bytes_received += client->stats_.bytes_received;
+				total.bytes_sent += client->stats_.bytes_sent;
+				total.snapshots += client->stats_.snapshots;
+				total.full_snapshots += client->stats_.full_snapshots;
+				total.stale_snapshots += client->stats_.stale_snapshots;
+				total.decode_errors += client->stats_.decode_errors;
+				total.decode_us_total += client->stats_.decode_us_total;
+			}
+
+			return total;
+		};
+
+		auto report = [&](const char* label, const ClientStats& from, double seconds)
+		{
+			const ClientStats total = total_stats();
+			const std::size_t snapshots = total.snapshots - from.snapshots;
+			const double per_client = static_cast<double>(clients.size()) * std::max(seconds, 1e-9);
+
+			printf("%s: %.1f KB/s down %.1f KB/s up per client, %.0f bytes per snapshot, %.1f us per decode, %zu snapshots, %zu full, %zu stale, %zu decode errors\n", label,
+				static_cast<double>(total.bytes_received - from.bytes_received) / 1024.0 / per_client,
+				static_cast<double>(total.bytes_sent - from.bytes_sent) / 1024.0 / per_client,
+				static_cast<double>(total.bytes_received - from.bytes_received) / std::max<std::size_t>(snapshots, 1),
+				(total.decode_us_total - from.decode_us_total) / std::max<std::size_t>(snapshots, 1),
+				snapshots, total.full_snapshots - from.full_snapshots, total.stale_snapshots - from.stale_snapshots, total.decode_errors - from.decode_errors);
+
+			return total;
+		};
+
+		for (int tick = 0; tick < options.ticks; ++tick)
+		{
+			while (SecondsSince(start) < tick * tick_seconds)
+			{
+				SDL_Delay(1);
+			}
+
+			for (std::size_t i = 0; i < clients.size(); ++i)
+			{
+				clients[i]->Receive();
+
+				// Hold each random combination for half a second, roughly like a player would.
+				if (tick % (constants::ticks_per_second / 2) == 0)
+				{
+					buttons[i] = static_cast<std::uint8_t>(random_buttons(mt));
+				}
+
+				clients[i]->SendInput(buttons[i]);
+			}
+
+			const double seconds = SecondsSince(start);
+
+			if (seconds - previous_seconds >= 1.0)
+			{
+				previous = report("second", previous, seconds - previous_seconds);
+				previous_seconds = seconds;
+			}
+		}
+
+		for (const std::unique_ptr<Client>& client : clients)
+		{
+			client->SendBye();
+		}
+
+		const ClientStats total = report("total", ClientStats(), SecondsSince(start));
+
+		return total.decode_errors == 0 ? 0 : 1;
+	}
+} // namespace net
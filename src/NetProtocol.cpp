@@ -0,0 +1,333 @@
+#include "NetProtocol.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace net
+{
+	namespace
+	{
+		enum DeltaFlags : std::uint8_t
+		{
+			FULL = 1, REMOVED = 2, POSITION = 4, VELOCITY = 8, ANGLE = 16
+		};
+
+		std::int16_t WrappedDifference(std::uint16_t to, std::uint16_t from)
+		{
+			return static_cast<std::int16_t>(static_cast<std::uint16_t>(to - from));
+		}
+
+		void WriteChange(std::uint32_t id, std::uint32_t* previous_id, std::uint8_t flags, ByteWriter* writer)
+		{
+			writer->VarUint(id - *previous_id);
+			writer->U8(flags);
+			*previous_id = id;
+		}
+	} // namespace
+
+	ByteWriter::ByteWriter(std::uint8_t* data, std::size_t capacity) : data_(data), capacity_(capacity), size_(0), overflow_(false)
+	{
+	}
+
+	void ByteWriter::U8(std::uint8_t value)
+	{
+		if (size_ >= capacity_)
+		{
+			overflow_ = true;
+			return;
+		}
+
+		data_[size_++] = value;
+	}
+
+	void ByteWriter::U16(std::uint16_t value)
+	{
+		U8(static_cast<std::uint8_t>(value));
+		U8(static_cast<std::uint8_t>(value >> 8));
+	}
+
+	void ByteWriter::U32(std::uint32_t value)
+	{
+		U16(static_cast<std::uint16_t>(value));
+		U16(static_cast<std::uint16_t>(value >> 16));
+	}
+
+	void ByteWriter::VarUint(std::uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			U8(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		U8(static_cast<std::uint8_t>(value));
+	}
+
+	void ByteWriter::VarInt(std::int32_t value)
+	{
+		// Zigzag, so small negative numbers stay small.
+		VarUint((static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+	}
+
+	void ByteWriter::PatchU16(std::size_t offset, std::uint16_t value)
+	{
+		if (offset + 2 > size_)
+		{
+			return;
+		}
+
+		data_[offset] = static_cast<std::uint8_t>(value);
+		data_[offset + 1] = static_cast<std::uint8_t>(value >> 8);
+	}
+
+	std::size_t ByteWriter::Size() const
+	{
+		return size_;
+	}
+
+	bool ByteWriter::Overflow() const
+	{
+		return overflow_;
+	}
+
+	ByteReader::ByteReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size), position_(0), error_(false)
+	{
+	}
+
+	std::uint8_t ByteReader::U8()
+	{
+		if (position_ >= size_)
+		{
+			error_ = true;
+			return 0;
+		}
+
+		return data_[position_++];
+	}
+
+	std::uint16_t ByteReader::U16()
+	{
+		const std::uint16_t low = U8();
+		return static_cast<std::uint16_t>(low | (U8() << 8));
+	}
+
+	std::uint32_t ByteReader::U32()
+	{
+		const std::uint32_t low = U16();
+		return low | (static_cast<std::uint32_t>(U16()) << 16);
+	}
+
+	std::uint32_t ByteReader::VarUint()
+	{
+		std::uint32_t value = 0;
+
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			const std::uint8_t byte = U8();
+			value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+
+		error_ = true;
+		return value;
+	}
+
+	std::int32_t ByteReader::VarInt()
+	{
+		const std::uint32_t value = VarUint();
+		return static_cast<std::int32_t>((value >> 1) ^ (~(value & 1) + 1));
+	}
+
+	bool ByteReader::Error() const
+	{
+		return error_;
+	}
+
+	std::uint16_t QuantizePosition(double value, double extent)
+	{
+		const double wrapped = value - extent * std::floor(value / extent);
+		return static_cast<std::uint16_t>(static_cast<std::uint32_t>(wrapped / extent * 65536.0) & 0xFFFF);
+	}
+
+	double DequantizePosition(std::uint16_t value, double extent)
+	{
+		return static_cast<double>(value) * extent / 65536.0;
+	}
+
+	std::int16_t QuantizeVelocity(double value)
+	{
+		return static_cast<std::int16_t>(std::clamp(std::lround(value * 8.0), -32768l, 32767l));
+	}
+
+	double DequantizeVelocity(std::int16_t value)
+	{
+		return static_cast<double>(value) / 8.0;
+	}
+
+	std::uint8_t QuantizeAngle(double degrees)
+	{
+		const double wrapped = degrees - 360.0 * std::floor(degrees / 360.0);
+		return static_cast<std::uint8_t>(static_cast<int>(std::lround(wrapped / 360.0 * 256.0)) & 0xFF);
+	}
+
+	double DequantizeAngle(std::uint8_t value)
+	{
+		return static_cast<double>(value) * 360.0 / 256.0;
+	}
+
+	void EncodeDelta(const std::vector<EntityState>& baseline, const std::vector<EntityState>& current, ByteWriter* writer)
+	{
+		const std::size_t count_offset = writer->Size();
+		writer->U16(0);
+
+		std::uint16_t changes = 0;
+		std::uint32_t previous_id = 0;
+		std::size_t i = 0;
+		std::size_t j = 0;
+
+		while (i < baseline.size() || j < current.size())
+		{
+			if (j == current.size() || (i < baseline.size() && baseline[i].id < current[j].id))
+			{
+				WriteChange(baseline[i++].id, &previous_id, REMOVED, writer);
+				++changes;
+				continue;
+			}
+
+			const EntityState& entity = current[j++];
+			std::uint8_t flags = FULL;
+
+			if (i < baseline.size() && baseline[i].id == entity.id)
+			{
+				const EntityState& previous = baseline[i++];
+
+				flags = previous.kind != entity.kind ? FULL : 0;
+				flags |= (previous.x != entity.x || previous.y != entity.y) ? POSITION : 0;
+				flags |= (previous.vx != entity.vx || previous.vy != entity.vy) ? VELOCITY : 0;
+				flags |= previous.angle != entity.angle ? ANGLE : 0;
+
+				if (flags == 0)
+				{
+					continue;
+				}
+
+				if ((flags & FULL) == 0)
+				{
+					WriteChange(entity.id, &previous_id, flags, writer);
+
+					if (flags & POSITION)
+					{
+						writer->VarInt(WrappedDifference(entity.x, previous.x));
+						writer->VarInt(WrappedDifference(entity.y, previous.y));
+					}
+
+					if (flags & VELOCITY)
+					{
+						writer->VarInt(entity.vx - previous.vx);
+						writer->VarInt(entity.vy - previous.vy);
+					}
+
+					if (flags & ANGLE)
+					{
+						writer->U8(entity.angle);
+					}
+
+					++changes;
+					continue;
+				}
+			}
+
+			WriteChange(entity.id, &previous_id, FULL, writer);
+			writer->U8(entity.kind);
+			writer->U16(entity.x);
+			writer->U16(entity.y);
+			writer->U16(static_cast<std::uint16_t>(entity.vx));
+			writer->U16(static_cast<std::uint16_t>(entity.vy));
+			writer->U8(entity.angle);
+			++changes;
+		}
+
+		writer->PatchU16(count_offset, changes);
+	}
+
+	bool DecodeDelta(const std::vector<EntityState>& baseline, ByteReader* reader, std::vector<EntityState>* current)
+	{
+		const std::uint16_t changes = reader->U16();
+		std::uint32_t id = 0;
+		std::size_t i = 0;
+
+		current->clear();
+
+		for (std::uint16_t change = 0; change < changes && !reader->Error(); ++change)
+		{
+			id += reader->VarUint();
+			const std::uint8_t flags = reader->U8();
+
+			while (i < baseline.size() && baseline[i].id < id)
+			{
+				current->push_back(baseline[i++]);
+			}
+
+			const bool in_baseline = i < baseline.size() && baseline[i].id == id;
+
+			if (flags & REMOVED)
+			{
+				i += in_baseline ? 1 : 0;
+				continue;
+			}
+
+			EntityState entity;
+
+			if (flags & FULL)
+			{
+				i += in_baseline ? 1 : 0;
+				entity.id = id;
+				entity.kind = reader->U8();
+				entity.x = reader->U16();
+				entity.y = reader->U16();
+				entity.vx = static_cast<std::int16_t>(reader->U16());
+				entity.vy = static_cast<std::int16_t>(reader->U16());
+				entity.angle = reader->U8();
+				current->push_back(entity);
+				continue;
+			}
+
+			if (!in_baseline)
+			{
+				return false;
+			}
+
+			entity = baseline[i++];
+
+			if (flags & POSITION)
+			{
+				entity.x = static_cast<std::uint16_t>(entity.x + reader->VarInt());
+				entity.y = static_cast<std::uint16_t>(entity.y + reader->VarInt());
+			}
+
+			if (flags & VELOCITY)
+			{
+				entity.vx = static_cast<std::int16_t>(entity.vx + reader->VarInt());
+				entity.vy = static_cast<std::int16_t>(entity.vy + reader->VarInt());
+			}
+
+			if (flags & ANGLE)
+			{
+				entity.angle = reader->U8();
+			}
+
+			current->push_back(entity);
+		}
+
+		while (i < baseline.size())
+		{
+			current->push_back(baseline[i++]);
+		}
+
+		return !reader->Error();
+	}
+} // namespace net
@@ -0,0 +1,413 @@
+#include "NetServer.hpp"
+#include "Game.hpp"
+#include "Player.hpp"
+#include "Asteroid.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+	volatile std::sig_atomic_t server_running = 1;
+
+	void StopServer(int)
+	{
+		server_running = 0;
+	}
+
+	double SecondsSince(std::uint64_t start)
+	{
+		return static_cast<double>(SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+
+	net::EntityState QuantizeEntity(std::uint32_t id, std::uint8_t kind, const LinePolygon& polygon, double world_width, double world_height)
+	{
+		return { id, net::QuantizePosition(polygon.center_.x, world_width), net::QuantizePosition(polygon.center_.y, world_height), net::QuantizeVelocity(polygon.velocity_vector_.x), net::QuantizeVelocity(polygon.velocity_vector_.y), net::QuantizeAngle(polygon.angle_), kind };
+	}
+} // namespace
+
+namespace net
+{
+	Server::Server(Game* game) : game_(game)
+	{
+		packet_.resize(max_packet_size);
+	}
+
+	bool Server::Open(std::uint16_t port)
+	{
+		return socket_.Open(port);
+	}
+
+	Server::Client* Server::FindClient(const sockaddr_in& address)
+	{
+		for (Client& client : clients_)
+		{
+			if (client.active && client.address.sin_addr.s_addr == address.sin_addr.s_addr && client.address.sin_port == address.sin_port)
+			{
+				return &client;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void Server::HandlePacket(const sockaddr_in& from, const std::uint8_t* data, std::size_t size, double now)
+	{
+		ByteReader reader(data, size);
+		const PacketType type = static_cast<PacketType>(reader.U8());
+		Client* client = FindClient(from);
+
+		if (type == PacketType::HELLO)
+		{
+			if (client == nullptr)
+			{
+				const auto free_slot = std::find_if(clients_.begin(), clients_.end(), [](const Client& candidate)
+				{
+					return !candidate.active;
+				});
+
+				if (free_slot == clients_.end())
+				{
+					printf("Server full, ignoring %s:%u\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+					return;
+				}
+
+				client = &*free_slot;
+				*client = Client();
+				client->active = true;
+				client->address = from;
+				client->player = game_->AddRemotePlayer();
+
+				printf("Client %zu joined from %s:%u\n", static_cast<std::size_t>(client - clients_.data()), inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+			}
+
+			// Sent again for every repeated hello, in case the first welcome was lost.
+			client->last_heard = now;
+			SendWelcome(*client, static_cast<std::size_t>(client - clients_.data()));
+			return;
+		}
+
+		if (client == nullptr)
+		{
+			return;
+		}
+
+		client->last_heard = now;
+
+		if (type == PacketType::INPUT)
+		{
+			const std::uint32_t sequence = reader.U32();
+			const std::uint32_t ack_tick = reader.U32();
+			const std::uint8_t buttons = reader.U8();
+
+			if (reader.Error())
+			{
+				return;
+			}
+
+			// Datagrams can arrive out of order; only the newest input counts.
+			if (sequence > client->last_sequence)
+			{
+				client->last_sequence = sequence;
+				client->buttons = buttons;
+			}
+
+			if (ack_tick > client->acked_tick && ack_tick <= game_->ticks_)
+			{
+				client->acked_tick = ack_tick;
+			}
+		}
+		else if (type == PacketType::BYE)
+		{
+			printf("Client %zu left\n", static_cast<std::size_t>(client - clients_.data()));
+			game_->RemoveRemotePlayer(client->player);
+			*client = Client();
+		}
+	}
+
+	void Server::SendWelcome(const Client& client, std::size_t slot)
+	{
+		ByteWriter writer(packet_.data(), packet_.size());
+		writer.U8(static_cast<std::uint8_t>(PacketType::WELCOME));
+		writer.U8(static_cast<std::uint8_t>(slot));
+		writer.U32(static_cast<std::uint32_t>(game_->world_width_));
+		writer.U32(static_cast<std::uint32_t>(game_->world_height_));
+
+		socket_.Send(client.address, packet_.data(), writer.Size());
+		metrics_.bytes_sent += writer.Size();
+	}
+
+	void Server::QuantizeWorld()
+	{
+		world_.clear();
+		bullets_.clear();
+
+		for (const std::unique_ptr<Asteroid>& asteroid : game_->Asteroids())
+		{
+			if (!asteroid->removed_)
+			{
+				world_.push_back(QuantizeEntity(asteroid->id_, static_cast<std::uint8_t>(asteroid->type_), *asteroid, game_->world_width_, game_->world_height_));
+			}
+		}
+
+		for (std::size_t slot = 0; slot < clients_.size(); ++slot)
+		{
+			if (clients_[slot].active && !clients_[slot].player->removed_)
+			{
+				world_.push_back(QuantizeEntity(ship_id_base + static_cast<std::uint32_t>(slot), ship_kind, *clients_[slot].player, game_->world_width_, game_->world_height_));
+			}
+		}
+
+		// Split fragments get new ids but can sit anywhere in the asteroid list.
+		std::sort(world_.begin(), world_.end(), [](const EntityState& a, const EntityState& b)
+		{
+			return a.id < b.id;
+		});
+
+		for (const std::unique_ptr<Bullet>& bullet : game_->Bullets())
+		{
+			if (!bullet->removed_)
+			{
+				bullets_.push_back({ QuantizePosition(bullet->geometry_.x, game_->world_width_), QuantizePosition(bullet->geometry_.y, game_->world_height_) });
+			}
+		}
+	}
+
+	void Server::SendSnapshot(Client* client)
+	{
+		const std::uint64_t encode_start = SDL_GetPerformanceCounter();
+		const std::uint32_t tick = static_cast<std::uint32_t>(game_->ticks_);
+		const Player& ship = *client->player;
+		const std::uint16_t ship_x = QuantizePosition(ship.center_.x, game_->world_width_);
+		const std::uint16_t ship_y = QuantizePosition(ship.center_.y, game_->world_height_);
+		const double scale_x = game_->world_width_ / 65536.0;
+		const double scale_y = game_->world_height_ / 65536.0;
+		const double radius_squared = interest_radius * interest_radius;
+
+		// Quantized differences wrap at 16 bits, which is the shortest way around the world seam.
+		auto distance_squared = [&](std::uint16_t x, std::uint16_t y)
+		{
+			const double dx = static_cast<std::int16_t>(static_cast<std::uint16_t>(x - ship_x)) * scale_x;
+			const double dy = static_cast<std::int16_t>(static_cast<std::uint16_t>(y - ship_y)) * scale_y;
+			return (dx * dx) + (dy * dy);
+		};
+
+		selected_.clear();
+
+		for (const EntityState& entity : world_)
+		{
+			if (distance_squared(entity.x, entity.y) <= radius_squared)
+			{
+				selected_.push_back(entity);
+			}
+		}
+
+		std::uint16_t bullet_count = 0;
+		std::array<BulletPosition, max_snapshot_bullets> nearby_bullets;
+
+		for (const BulletPosition& bullet : bullets_)
+		{
+			if (bullet_count < max_snapshot_bullets && distance_squared(bullet.x, bullet.y) <= radius_squared)
+			{
+				nearby_bullets[bullet_count++] = bullet;
+			}
+		}
+
+		const History& acked = client->history[client->acked_tick % history_size];
+		const bool has_baseline = client->acked_tick != 0 && acked.tick == client->acked_tick && tick - client->acked_tick < history_size;
+		static const std::vector<EntityState> no_baseline;
+		const std::vector<EntityState>& baseline = has_baseline ? acked.entities : no_baseline;
+
+		std::size_t limit = max_snapshot_entities;
+		std::size_t size = 0;
+
+		while (true)
+		{
+			// Keep the closest entities when there are too many; the ship itself is at distance zero, so it always stays.
+			if (selected_.size() > limit)
+			{
+				std::nth_element(selected_.begin(), selected_.begin() + static_cast<std::ptrdiff_t>(limit), selected_.end(), [&](const EntityState& a, const EntityState& b)
+				{
+					return distance_squared(a.x, a.y) < distance_squared(b.x, b.y);
+				});
+
+				selected_.resize(limit);
+				std::sort(selected_.begin(), selected_.end(), [](const EntityState& a, const EntityState& b)
+				{
+					return a.id < b.id;
+				});
+			}
+
+			ByteWriter writer(packet_.data(), packet_.size());
+			writer.U8(static_cast<std::uint8_t>(PacketType::SNAPSHOT));
+			writer.U32(tick);
+			writer.U32(has_baseline ? client->acked_tick : 0);
+			writer.U32(static_cast<std::uint32_t>(game_->score_));
+			writer.U8(static_cast<std::uint8_t>(std::clamp(ship.lives_, 0, 255)));
+
+			EncodeDelta(baseline, selected_, &writer);
+
+			writer.VarUint(bullet_count);
+
+			for (std::uint16_t i = 0; i < bullet_count; ++i)
+			{
+				writer.U16(nearby_bullets[i].x);
+				writer.U16(nearby_bullets[i].y);
+			}
+
+			if (!writer.Overflow())
+			{
+				size = writer.Size();
+				break;
+			}
+
+			// Entities new to the client cost a full record, so a crowded view fills in over a few ticks.
+			limit = selected_.size() * 3 / 4;
+			++metrics_.truncated_snapshots;
+		}
+
+		History& history = client->history[tick % history_size];
+		history.tick = tick;
+		history.entities.assign(selected_.begin(), selected_.end());
+
+		socket_.Send(client->address, packet_.data(), size);
+
+		metrics_.encode_us_total += SecondsSince(encode_start) * 1e6;
+		metrics_.bytes_sent += size;
+		++metrics_.snapshots;
+
+		if (!has_baseline)
+		{
+			++metrics_.full_snapshots;
+		}
+	}
+
+	void Server::Tick(double now)
+	{
+		std::uint8_t buffer[max_packet_size];
+		sockaddr_in from;
+		int received;
+
+		while ((received = socket_.Receive(buffer, sizeof(buffer), &from)) >= 0)
+		{
+			HandlePacket(from, buffer, static_cast<std::size_t>(received), now);
+		}
+
+		for (std::size_t slot = 0; slot < clients_.size(); ++slot)
+		{
+			Client& client = clients_[slot];
+
+			if (!client.active)
+			{
+				continue;
+			}
+
+			if (now - client.last_heard > client_timeout_seconds)
+			{
+				printf("Client %zu timed out\n", slot);
+				game_->RemoveRemotePlayer(client.player);
+				client = Client();
+				continue;
+			}
+
+			client.player->ApplyInput(client.buttons);
+		}
+
+		const std::uint64_t tick_start = SDL_GetPerformanceCounter();
+		game_->Tick();
+		const double tick_ms = SecondsSince(tick_start) * 1000.0;
+
+		metrics_.tick_ms_total += tick_ms;
+		metrics_.tick_ms_max = std::max(metrics_.tick_ms_max, tick_ms);
+		++metrics_.ticks;
+
+		QuantizeWorld();
+
+		for (Client& client : clients_)
+		{
+			if (client.active)
+			{
+				SendSnapshot(&client);
+			}
+		}
+	}
+
+	std::size_t Server::ClientCount() const
+	{
+		return static_cast<std::size_t>(std::count_if(clients_.begin(), clients_.end(), [](const Client& client)
+		{
+			return client.active;
+		}));
+	}
+
+	std::size_t Server::EntityCount() const
+	{
+		return world_.size();
+	}
+
+	int RunServer(const Options& options)
+	{
+		std::unique_ptr<Game> game = std::make_unique<Game>();
+		game->ApplyOptions(options);
+		game->headless_ = true;
+		game->local_player_ = false;
+
+		std::unique_ptr<Server> server = std::make_unique<Server>(game.get());
+
+		if (!server->Open(options.port) || !game->StartStateHash())
+		{
+			return 1;
+		}
+
+		std::signal(SIGINT, StopServer);
+		std::signal(SIGTERM, StopServer);
+
+		printf("Server listening on UDP port %u, world %.0f x %.0f, %d ticks per second\n", options.port, game->world_width_, game->world_height_, constants::ticks_per_second);
+
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		const double tick_seconds = 1.0 / constants::ticks_per_second;
+		double next_tick = 0.0;
+		double next_report = 1.0;
+
+		while (server_running)
+		{
+			const double now = SecondsSince(start);
+
+			if (now < next_tick)
+			{
+				SDL_Delay(static_cast<Uint32>((next_tick - now) * 1000.0));
+				continue;
+			}
+
+			server->Tick(now);
+
+			// After a long stall, drop the missed ticks instead of running them back to back.
+			next_tick = std::max(next_tick + tick_seconds, now - 0.25);
+
+			if (now >= next_report)
+			{
+				const ServerMetrics& metrics = server->metrics_;
+				const std::size_t clients = server->ClientCount();
+
+				printf("tick %.3f ms avg %.3f ms max, encode %.1f us/client, %.0f bytes/client/s, %zu clients, %zu entities, %zu full, %zu truncated\n",
+					metrics.tick_ms_total / std::max<std::size_t>(metrics.ticks, 1), metrics.tick_ms_max,
+					metrics.encode_us_total / std::max<std::size_t>(metrics.snapshots, 1),
+					static_cast<double>(metrics.bytes_sent) / std::max<std::size_t>(metrics.snapshots, 1) * constants::ticks_per_second,
+					clients, server->EntityCount(), metrics.full_snapshots, metrics.truncated_snapshots);
+
+				server->metrics_ = ServerMetrics();
+				next_report += 1.0;
+			}
+		}
+
+		printf("Server stopped after %llu ticks\n", static_cast<unsigned long long>(game->ticks_));
+
+		return 0;
+	}
+} // namespace net
@@ -0,0 +1,285 @@
+#include "Options.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+bool ParseOptions(int argc, char* argv[], Options* options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const bool has_value = i + 1 < argc;
+
+		if (std::strcmp(arg, "--asteroid-collisions") == 0)
+		{
+			options->asteroid_collisions = true;
+		}
+		else if (std::strcmp(arg, "--render-path") == 0 && has_value)
+		{
+			const char* path = argv[++i];
+
+			if (std::strcmp(path, "lines") == 0)
+			{
+				options->render_path = RenderPath::LINES;
+			}
+			else if (std::strcmp(path, "sprites") == 0)
+			{
+				options->render_path = RenderPath::SPRITES;
+			}
+			else
+			{
+				printf("Unknown render path: %s\n", path);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--sprite-steps") == 0 && has_value)
+		{
+			options->sprite_angle_steps = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(arg, "--sprite-cache-mb") == 0 && has_value)
+		{
+			options->sprite_cache_bytes = static_cast<std::size_t>(std::max(std::atoi(argv[++i]), 1)) * 1024 * 1024;
+		}
+		else if (std::strcmp(arg, "--world-scale") == 0 && has_value)
+		{
+			options->world_scale = std::max(std::atof(argv[++i]), 1.0);
+		}
+		else if (std::strcmp(arg, "--asteroids") == 0 && has_value)
+		{
+			options->initial_asteroids = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(arg, "--headless") == 0)
+		{
+			options->headless = true;
+		}
+		else if (std::strcmp(arg, "--ticks") == 0 && has_value)
+		{
+			options->ticks = std::max(std::atoi(argv[++i]), 0);
+		}
+		else if (std::strcmp(arg, "--tick-rate") == 0 && has_value)
+		{
+			options->tick_rate = std::clamp(std::atoi(argv[++i]), constants::min_tick_rate, constants::max_tick_rate);
+		}
+		else if (std::strcmp(arg, "--seed") == 0 && has_value)
+		{
+			options->seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(arg, "--capture") == 0 && has_value)
+		{
+			options->capture_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--capture-queue") == 0 && has_value)
+		{
+			options->capture_queue_depth = static_cast<std::size_t>(std::max(std::atoi(argv[++i]), 1));
+		}
+		else if (std::strcmp(arg, "--audio-buffer") == 0 && has_value)
+		{
+			options->audio_buffer_frames = std::clamp(std::atoi(argv[++i]), 64, 8192);
+		}
+		else if (std::strcmp(arg, "--audio-stats") == 0)
+		{
+			options->audio_stats = true;
+		}
+		else if (std::strcmp(arg, "--bundle") == 0 && has_value)
+		{
+			options->bundle_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--build-bundle") == 0 && has_value)
+		{
+			options->build_bundle_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--startup-report") == 0)
+		{
+			options->startup_report = true;
+		}
+		else if (std::strcmp(arg, "--state-hash") == 0 && has_value)
+		{
+			options->hash_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--compare-hashes") == 0 && i + 2 < argc)
+		{
+			options->hash_compare_first = argv[++i];
+			options->hash_compare_second = argv[++i];
+		}
+		else if (std::strcmp(arg, "--benchmark") == 0 && has_value)
+		{
+			options->benchmark = argv[++i];
+		}
+		else if (std::strcmp(arg, "--server") == 0)
+		{
+			options->server = true;
+		}
+		else if (std::strcmp(arg, "--port") == 0 && has_value)
+		{
+			options->port = static_cast<std::uint16_t>(std::clamp(std::atoi(argv[++i]), 1, 65535));
+		}
+		else if (std::strcmp(arg, "--connect") == 0 && has_value)
+		{
+			options->client = true;
+			options->connect_host = argv[++i];
+		}
+		else if (std::strcmp(arg, "--load-test") == 0 && has_value)
+		{
+			options->load_test_clients = std::clamp(std::atoi(argv[++i]), 1, 32);
+		}
+		else if (std::strcmp(arg, "--rollback") == 0 && has_value)
+		{
+			options->rollback_player = std::clamp(std::atoi(argv[++i]), 0, 1);
+		}
+		else if (std::strcmp(arg, "--peer") == 0 && has_value)
+		{
+			options->peer_host = argv[++i];
+		}
+		else if (std::strcmp(arg, "--rollback-window") == 0 && has_value)
+		{
+			options->rollback_window = std::clamp(std::atoi(argv[++i]), 1, 30);
+		}
+		else if (std::strcmp(arg, "--net-latency") == 0 && has_value)
+		{
+			options->net_latency_ms = std::max(std::atof(argv[++i]), 0.0);
+		}
+		else if (std::strcmp(arg, "--net-jitter") == 0 && has_value)
+		{
+			options->net_jitter_ms = std::max(std::atof(argv[++i]), 0.0);
+		}
+		else if (std::strcmp(arg, "--net-loss") == 0 && has_value)
+		{
+			options->net_loss = std::clamp(std::atof(argv[++i]) / 100.0, 0.0, 1.0);
+		}
+		else if (std::strcmp(arg, "--broadcast") == 0)
+		{
+			options->broadcast = true;
+		}
+		else if (std::strcmp(arg, "--spectate") == 0)
+		{
+			options->spectate = true;
+		}
+		else if (std::strcmp(arg, "--spectator-channel") == 0 && has_value)
+		{
+			options->spectator_channel = argv[++i];
+		}
+		else if (std::strcmp(arg, "--batch-size") == 0 && has_value)
+		{
+			options->batch_size = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(arg, "--threads") == 0 && has_value)
+		{
+			options->threads = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(arg, "--trace") == 0 && has_value)
+		{
+			options->trace_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--soak") == 0 && has_value)
+		{
+			options->soak_hours = std::max(std::atof(argv[++i]), 0.0);
+		}
+		else if (std::strcmp(arg, "--soak-baseline") == 0 && has_value)
+		{
+			options->soak_baseline_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--soak-save") == 0 && has_value)
+		{
+			options->soak_save_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--scenario") == 0 && has_value)
+		{
+			options->scenario = argv[++i];
+		}
+		else if (std::strcmp(arg, "--spawn-budget") == 0 && has_value)
+		{
+			options->spawn_budget = std::max(std::atoi(argv[++i]), 0);
+		}
+		else if (std::strcmp(arg, "--spawn-budget-us") == 0 && has_value)
+		{
+			options->spawn_budget_us = std::max(std::atof(argv[++i]), 0.0);
+		}
+		else if (std::strcmp(arg, "--governor") == 0 && has_value)
+		{
+			options->governor = argv[++i];
+		}
+		else if (std::strcmp(arg, "--governor-log") == 0 && has_value)
+		{
+			options->governor_log_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--record") == 0 && has_value)
+		{
+			options->record_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--replay") == 0 && has_value)
+		{
+			options->replay_path = argv[++i];
+		}
+		else if (std::strcmp(arg, "--seek") == 0 && has_value)
+		{
+			options->seek_seconds = std::max(std::atof(argv[++i]), 0.0);
+		}
+		else if (std::strcmp(arg, "--keyframe-interval") == 0 && has_value)
+		{
+			options->keyframe_seconds = std::max(std::atof(argv[++i]), 0.1);
+		}
+		else
+		{
+			printf("Unknown or incomplete option: %s\n", arg);
+			PrintUsage(argv[0]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void PrintUsage(const char* program)
+{
+	printf("Usage: %s [options]\n", program);
+	printf("  --asteroid-collisions    asteroids bounce off each other\n");
+	printf("  --render-path <path>     lines (default) or sprites (pre-rasterized rotated sprites)\n");
+	printf("  --sprite-steps <n>       rotation steps per sprite mesh, default 120\n");
+	printf("  --sprite-cache-mb <n>    sprite cache memory bound, default 32\n");
+	printf("  --world-scale <s>        world is s times the screen on each axis; the camera follows the ship\n");
+	printf("  --asteroids <n>          asteroids in the first wave, default 4\n");
+	printf("  --headless               simulate without a window or audio\n");
+	printf("  --ticks <n>              ticks to simulate in headless mode, default 3600\n");
+	printf("  --tick-rate <hz>         simulation ticks per second, e.g. 30, 60 (default), 120 or 240; local games only\n");
+	printf("  --seed <n>               seed the game's random number generator\n");
+	printf("  --capture <file>         stream frames to a .y4m (default) or .ppm file\n");
+	printf("  --capture-queue <n>      frames buffered for the encoder before dropping, default 8\n");
+	printf("  --audio-buffer <n>       audio buffer in sample frames, default 256 (about 6 ms)\n");
+	printf("  --audio-stats            print audio callback timing and voice statistics on exit\n");
+	printf("  --bundle <file>          asset bundle to map at startup, default res/assets.bundle\n");
+	printf("  --build-bundle <file>    decode the sounds and pack them with the font into a bundle, then exit\n");
+	printf("  --startup-report         print the time from launch to the first frame and each startup phase\n");
+	printf("  --state-hash <file>      write a hash of the simulation state after every tick\n");
+	printf("  --compare-hashes <a> <b> report the first tick and fields where two state hash files differ\n");
+	printf("  --benchmark <name>       run a headless benchmark: broadphase, particles, snapshot, rollback, batch, tickrate, replay, render\n");
+	printf("  --server                 run a headless authoritative multiplayer server\n");
+	printf("  --port <n>               UDP port to serve or connect to, default 27015\n");
+	printf("  --connect <host>         join a server as a windowed client\n");
+	printf("  --load-test <n>          connect n bot clients (to --connect, default 127.0.0.1) for --ticks ticks\n");
+	printf("  --rollback <0|1>         play ship 0 or 1 against a peer with rollback; ship 0 uses --port, ship 1 the next port\n");
+	printf("  --peer <host>            rollback peer, default 127.0.0.1\n");
+	printf("  --rollback-window <n>    ticks of remote input to predict before waiting, default 8\n");
+	printf("  --net-latency <ms>       delay outgoing rollback packets\n");
+	printf("  --net-jitter <ms>        vary the delay by up to this much either way\n");
+	printf("  --net-loss <percent>     drop this share of outgoing rollback packets\n");
+	printf("  --broadcast              publish every tick to shared memory for spectator processes\n");
+	printf("  --spectate               show the frames a --broadcast game publishes\n");
+	printf("  --spectator-channel <n>  shared memory name, default /asteroids-spectator\n");
+	printf("  --batch-size <n>         games stepped together by the batch benchmark, default 1024\n");
+	printf("  --threads <n>            most threads the batch benchmark tries, default all cores\n");
+	printf("  --trace <file>           write hot-path zone timings as a Chrome trace (chrome://tracing, Perfetto)\n");
+	printf("  --soak <hours>           let an autopilot play headless for this much simulated time, reporting tick times and memory\n");
+	printf("  --soak-baseline <file>   compare the soak summary against a saved baseline and fail on regressions\n");
+	printf("  --soak-save <file>       save the soak summary as a baseline\n");
+	printf("  --scenario <name|file>   run a stress profile or scenario file and report tick times; 'list' shows the profiles\n");
+	printf("  --spawn-budget <n>       asteroids built per tick from waves and splits, default 64, 0 for no limit\n");
+	printf("  --spawn-budget-us <n>    also stop building after this long in a tick; timing then depends on the machine\n");
+	printf("  --governor <policies>    degrade in this order while over the tick budget: splits,bullets,render,hud or all\n");
+	printf("  --governor-log <file>    also write every governor decision to a CSV file\n");
+	printf("  --record <file>          write the game's input and periodic keyframes to a replay file\n");
+	printf("  --replay <file>          play a replay back, windowed or headless; left and right arrows seek 10 s\n");
+	printf("  --seek <seconds>         start playback this far into the replay\n");
+	printf("  --keyframe-interval <s>  seconds between replay keyframes, default 10\n");
+}
@@ -0,0 +1,280 @@
+#include "ParticleSystem.hpp"
+#include "Framebuffer.hpp"
+#include "Trace.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr float drag_per_second = 1.5f;
+	constexpr std::uint8_t brightness[] = { 0x3C, 0x6E, 0xB4, 0xFF };
+} // namespace
+
+ParticleSystem::ParticleSystem(std::size_t capacity, float world_width, float world_height) : 
+	capacity_(capacity), 
+	count_(0), 
+	world_width_(world_width), 
+	world_height_(world_height), 
+	random_state_(0x9E3779B9u), 
+	use_simd_(true), 
+	dropped_(0)
+{
+	// Padded to a whole number of SIMD lanes, so the vector loop can run past count_ without a scalar tail.
+	const std::size_t padded = (capacity_ + 3) & ~static_cast<std::size_t>(3);
+
+	x_.assign(padded, 0.0f);
+	y_.assign(padded, 0.0f);
+	vx_.assign(padded, 0.0f);
+	vy_.assign(padded, 0.0f);
+	life_.assign(padded, 0.0f);
+
+	// Every live particle may fall in the same brightness level, so each one is sized for all of them.
+	for (std::vector<SDL_FPoint>& points : points_)
+	{
+		points.reserve(capacity_);
+	}
+}
+
+void ParticleSystem::SetWorldSize(float world_width, float world_height)
+{
+	world_width_ = world_width;
+	world_height_ = world_height;
+	Clear();
+}
+
+void ParticleSystem::Clear()
+{
+	count_ = 0;
+}
+
+float ParticleSystem::Random()
+{
+	random_state_ ^= random_state_ << 13;
+	random_state_ ^= random_state_ >> 17;
+	random_state_ ^= random_state_ << 5;
+
+	return static_cast<float>(random_state_ >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleSystem::Emit(float x, float y, float base_vx, float base_vy, int count, float speed, float lifetime)
+{
+	const float two_pi = 2.0f * static_cast<float>(std::acos(-1.0));
+
+	for (int i = 0; i < count; ++i)
+	{
+		if (count_ == capacity_)
+		{
+			dropped_ += count - i;
+			return;
+		}
+
+		const float angle = Random() * two_pi;
+		const float particle_speed = speed * (0.3f + 0.7f * Random());
+
+		x_[count_] = x;
+		y_[count_] = y;
+		vx_[count_] = base_vx + std::cos(angle) * particle_speed;
+		vy_[count_] = base_vy + std::sin(angle) * particle_speed;
+		life_[count_] = lifetime * (0.5f + 0.5f * Random());
+		++count_;
+	}
+}
+
+void ParticleSystem::EmitCone(float x, float y, float direction_x, float direction_y, int count, float speed, float spread, float lifetime)
+{
+	const float heading = std::atan2(direction_y, direction_x);
+
+	for (int i = 0; i < count; ++i)
+	{
+		if (count_ == capacity_)
+		{
+			dropped_ += count - i;
+			return;
+		}
+
+		const float angle = heading + (Random() - 0.5f) * spread;
+		const float particle_speed = speed * (0.5f + 0.5f * Random());
+
+		x_[count_] = x;
+		y_[count_] = y;
+		vx_[count_] = std::cos(angle) * particle_speed;
+		vy_[count_] = std::sin(angle) * particle_speed;
+		life_[count_] = lifetime * (0.5f + 0.5f * Random());
+		++count_;
+	}
+}
+
+void ParticleSystem::Update(float dt)
+{
+	trace::Zone zone("ParticleSystem::Update");
+
+	if (use_simd_)
+	{
+		UpdateSimd(dt);
+	}
+	else
+	{
+		UpdateScalar(dt, 0);
+	}
+
+	Cull();
+}
+
+void ParticleSystem::UpdateScalar(float dt, std::size_t begin)
+{
+	const float drag = std::exp(-drag_per_second * dt);
+
+	for (std::size_t i = begin; i < count_; ++i)
+	{
+		vx_[i] *= drag;
+		vy_[i] *= drag;
+		x_[i] += vx_[i] * dt;
+		y_[i] += vy_[i] * dt;
+
+		x_[i] += x_[i] < 0.0f ? world_width_ : 0.0f;
+		x_[i] -= x_[i] >= world_width_ ? world_width_ : 0.0f;
+		y_[i] += y_[i] < 0.0f ? world_height_ : 0.0f;
+		y_[i] -= y_[i] >= world_height_ ? world_height_ : 0.0f;
+
+		life_[i] -= dt;
+	}
+}
+
+void ParticleSystem::UpdateSimd(float dt)
+{
+#if defined(__SSE2__)
+	const __m128 dt4 = _mm_set1_ps(dt);
+	const __m128 drag4 = _mm_set1_ps(std::exp(-drag_per_second * dt));
+	const __m128 width4 = _mm_set1_ps(world_width_);
+	const __m128 height4 = _mm_set1_ps(world_height_);
+	const __m128 zero4 = _mm_setzero_ps();
+	const std::size_t padded_count = (count_ + 3) & ~static_cast<std::size_t>(3);
+
+	float* x = x_.data();
+	float* y = y_.data();
+	float* vx = vx_.data();
+	float* vy = vy_.data();
+	float* life = life_.data();
+
+	for (std::size_t i = 0; i < padded_count; i += 4)
+	{
+		const __m128 new_vx = _mm_mul_ps(_mm_loadu_ps(vx + i), drag4);
+		const __m128 new_vy = _mm_mul_ps(_mm_loadu_ps(vy + i), drag4);
+		__m128 new_x = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(new_vx, dt4));
+		__m128 new_y = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(new_vy, dt4));
+
+		// Branchless wrap: add the world size where below zero, subtract it where past the far edge.
+		new_x = _mm_add_ps(new_x, _mm_and_ps(_mm_cmplt_ps(new_x, zero4), width4));
+		new_x = _mm_sub_ps(new_x, _mm_and_ps(_mm_cmpge_ps(new_x, width4), width4));
+		new_y = _mm_add_ps(new_y, _mm_and_ps(_mm_cmplt_ps(new_y, zero4), height4));
+		new_y = _mm_sub_ps(new_y, _mm_and_ps(_mm_cmpge_ps(new_y, height4), height4));
+
+		_mm_storeu_ps(vx + i, new_vx);
+		_mm_storeu_ps(vy + i, new_vy);
+		_mm_storeu_ps(x + i, new_x);
+		_mm_storeu_ps(y + i, new_y);
+		_mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), dt4));
+	}
+#else
+	UpdateScalar(dt, 0);
+#endif
+}
+
+void ParticleSystem::Cull()
+{
+	std::size_t i = 0;
+
+	// Swap-remove keeps the live particles packed at the front of every array.
+	while (i < count_)
+	{
+		if (life_[i] > 0.0f)
+		{
+			++i;
+			continue;
+		}
+
+		--count_;
+		x_[i] = x_[count_];
+		y_[i] = y_[count_];
+		vx_[i] = vx_[count_];
+		vy_[i] = vy_[count_];
+		life_[i] = life_[count_];
+	}
+}
+
+void ParticleSystem::BuildPoints(float camera_x, float camera_y, float view_width, float view_height)
+{
+	for (std::vector<SDL_FPoint>& points : points_)
+	{
+		points.clear();
+	}
+
+	for (std::size_t i = 0; i < count_; ++i)
+	{
+		float screen_x = x_[i] - camera_x;
+		float screen_y = y_[i] - camera_y;
+
+		screen_x -= world_width_ * std::floor(screen_x / world_width_);
+		screen_y -= world_height_ * std::floor(screen_y / world_height_);
+
+		if (screen_x >= view_width || screen_y >= view_height)
+		{
+			continue;
+		}
+
+		const float life = life_[i];
+		const int level = life > 0.6f ? 3 : (life > 0.3f ? 2 : (life > 0.15f ? 1 : 0));
+
+		points_[level].push_back({ screen_x, screen_y });
+	}
+}
+
+int ParticleSystem::Render(SDL_Renderer* renderer, float camera_x, float camera_y)
+{
+	BuildPoints(camera_x, camera_y, constants::screen_width, constants::screen_height);
+
+	int draw_calls = 0;
+
+	for (int level = 0; level < brightness_levels; ++level)
+	{
+		if (points_[level].empty())
+		{
+			continue;
+		}
+
+		SDL_SetRenderDrawColor(renderer, brightness[level], brightness[level], brightness[level], 0xFF);
+		SDL_RenderDrawPointsF(renderer, points_[level].data(), static_cast<int>(points_[level].size()));
+		++draw_calls;
+	}
+
+	return draw_calls;
+}
+
+void ParticleSystem::Render(Framebuffer* framebuffer, float camera_x, float camera_y)
+{
+	BuildPoints(camera_x, camera_y, static_cast<float>(framebuffer->Width()), static_cast<float>(framebuffer->Height()));
+
+	for (int level = 0; level < brightness_levels; ++level)
+	{
+		const std::uint32_t color = 0xFF000000 | (brightness[level] << 16) | (brightness[level] << 8) | brightness[level];
+		framebuffer->DrawPoints(points_[level].data(), points_[level].size(), color);
+	}
+}
+
+std::size_t ParticleSystem::Count() const
+{
+	return count_;
+}
+
+std::size_t ParticleSystem::Capacity() const
+{
+	return capacity_;
+}
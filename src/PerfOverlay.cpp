@@ -0,0 +1,230 @@
+#include "PerfOverlay.hpp"
+#include "Utils/Constants.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+PerfOverlay::PerfOverlay() :
+	atlas_(nullptr),
+	glyph_x_(),
+	glyph_height_(0),
+	frame_ms_(),
+	frames_recorded_(0),
+	sum_(),
+	window_frames_(0),
+	window_max_ticks_(0),
+	window_start_(0),
+	average_(),
+	frames_per_second_(0.0),
+	ticks_per_second_(0.0),
+	ticks_per_frame_(0.0),
+	max_ticks_per_frame_(0),
+	allocations_per_tick_(0.0),
+	draw_calls_(0)
+{
+}
+
+PerfOverlay::~PerfOverlay()
+{
+	Free();
+}
+
+bool PerfOverlay::Load(SDL_Renderer* renderer, TTF_Font* font)
+{
+	Free();
+
+	char glyphs[glyph_count + 1];
+
+	for (int i = 0; i < glyph_count; ++i)
+	{
+		glyphs[i] = static_cast<char>(first_glyph + i);
+	}
+
+	glyphs[glyph_count] = '\0';
+
+	const SDL_Color text_color = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Surface* surface = TTF_RenderText_Blended(font, glyphs, text_color);
+
+	if (surface == nullptr)
+	{
+		printf("Unable to render overlay glyphs! SDL_ttf Error: %s\n", TTF_GetError());
+		return false;
+	}
+
+	// Each glyph spans from the width of the text before it to the width including it.
+	char prefix[glyph_count + 1];
+
+	for (int i = 0; i <= glyph_count; ++i)
+	{
+		std::copy(glyphs, glyphs + i, prefix);
+		prefix[i] = '\0';
+
+		int width = 0;
+		TTF_SizeText(font, prefix, &width, nullptr);
+		glyph_x_[i] = std::min(width, surface->w);
+	}
+
+	atlas_ = SDL_CreateTextureFromSurface(renderer, surface);
+	glyph_height_ = surface->h;
+	SDL_FreeSurface(surface);
+
+	if (atlas_ == nullptr)
+	{
+		printf("Unable to create overlay glyph texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	window_start_ = SDL_GetPerformanceCounter();
+
+	return true;
+}
+
+void PerfOverlay::Free()
+{
+	SDL_DestroyTexture(atlas_);
+	atlas_ = nullptr;
+}
+
+void PerfOverlay::AddFrame(const FrameSample& sample)
+{
+	frame_ms_[frames_recorded_ % history] = static_cast<float>(sample.frame_ms);
+	++frames_recorded_;
+
+	sum_.frame_ms += sample.frame_ms;
+	sum_.events_ms += sample.events_ms;
+	sum_.tick_ms += sample.tick_ms;
+	sum_.render_ms += sample.render_ms;
+	sum_.present_ms += sample.present_ms;
+	sum_.ticks += sample.ticks;
+	sum_.allocations += sample.allocations;
+	++window_frames_;
+	window_max_ticks_ = std::max(window_max_ticks_, sample.ticks);
+	draw_calls_ = sample.draw_calls;
+
+	const std::uint64_t now = SDL_GetPerformanceCounter();
+	const double seconds = static_cast<double>(now - window_start_) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	if (seconds < 1.0)
+	{
+		return;
+	}
+
+	average_.frame_ms = sum_.frame_ms / window_frames_;
+	average_.events_ms = sum_.events_ms / window_frames_;
+	average_.tick_ms = sum_.tick_ms / window_frames_;
+	average_.render_ms = sum_.render_ms / window_frames_;
+	average_.present_ms = sum_.present_ms / window_frames_;
+	frames_per_second_ = window_frames_ / seconds;
+	ticks_per_second_ = sum_.ticks / seconds;
+	ticks_per_frame_ = static_cast<double>(sum_.ticks) / window_frames_;
+	max_ticks_per_frame_ = window_max_ticks_;
+	allocations_per_tick_ = sum_.ticks > 0 ? static_cast<double>(sum_.allocations) / sum_.ticks : 0.0;
+
+	sum_ = FrameSample();
+	window_frames_ = 0;
+	window_max_ticks_ = 0;
+	window_start_ = now;
+}
+
+int PerfOverlay::DrawText(SDL_Renderer* renderer, int x, int y, const char* text) const
+{
+	int draw_calls = 0;
+
+	for (const char* c = text; *c != '\0'; ++c)
+	{
+		const int glyph = (*c >= first_glyph && *c < first_glyph + glyph_count) ? *c - first_glyph : '?' - first_glyph;
+		const int width = glyph_x_[glyph + 1] - glyph_x_[glyph];
+
+		if (*c != ' ')
+		{
+			const SDL_Rect source = { glyph_x_[glyph], 0, width, glyph_height_ };
+			const SDL_Rect destination = { x, y, width, glyph_height_ };
+
+			SDL_RenderCopy(renderer, atlas_, &source, &destination);
+			++draw_calls;
+		}
+
+		x += width;
+	}
+
+	return draw_calls;
+}
+
+int PerfOverlay::Render(SDL_Renderer* renderer, std::size_t asteroids, std::size_t bullets, std::size_t particles) const
+{
+	if (atlas_ == nullptr)
+	{
+		return 0;
+	}
+
+	constexpr int lines = 6;
+	constexpr int margin = 6;
+	constexpr int bar_width = 3;
+	constexpr int graph_height = 60;
+	constexpr float graph_ms = 2000.0f / constants::frames_per_second;
+
+	const int left = 10;
+	const int top = 40;
+	const int graph_top = top + margin + (lines * glyph_height_) + margin;
+	const SDL_Rect panel = { left, top, (history * bar_width) + (2 * margin), graph_top + graph_height + margin - top };
+
+	int draw_calls = 0;
+
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xB0);
+	SDL_RenderFillRect(renderer, &panel);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+	++draw_calls;
+
+	char text[lines][96];
+
+	std::snprintf(text[0], sizeof(text[0]), "FPS %.0f  ticks/s %.0f", frames_per_second_, ticks_per_second_);
+	std::snprintf(text[1], sizeof(text[1]), "catch-up ticks/frame %.2f  max %d", ticks_per_frame_, max_ticks_per_frame_);
+	std::snprintf(text[2], sizeof(text[2]), "frame %.2f ms  events %.2f  tick %.2f", average_.frame_ms, average_.events_ms, average_.tick_ms);
+	std::snprintf(text[3], sizeof(text[3]), "render %.2f ms  present %.2f ms", average_.render_ms, average_.present_ms);
+	std::snprintf(text[4], sizeof(text[4]), "asteroids %zu  bullets %zu  particles %zu", asteroids, bullets, particles);
+	std::snprintf(text[5], sizeof(text[5]), "draw calls %d  allocs/tick %.1f", draw_calls_, allocations_per_tick_);
+
+	for (int line = 0; line < lines; ++line)
+	{
+		draw_calls += DrawText(renderer, left + margin, top + margin + (line * glyph_height_), text[line]);
+	}
+
+	// Oldest frame on the left; frames over budget are drawn red.
+	std::array<SDL_Rect, history> within_budget;
+	std::array<SDL_Rect, history> over_budget;
+	int within_count = 0;
+	int over_count = 0;
+
+	const std::size_t shown = std::min<std::size_t>(frames_recorded_, history);
+	const float budget_ms = 1000.0f / constants::frames_per_second;
+
+	for (std::size_t i = 0; i < shown; ++i)
+	{
+		const float ms = frame_ms_[(frames_recorded_ - shown + i) % history];
+		const int height = std::max(1, static_cast<int>(std::min(ms / graph_ms, 1.0f) * graph_height));
+		const SDL_Rect bar = { left + margin + static_cast<int>(history - shown + i) * bar_width, graph_top + graph_height - height, bar_width - 1, height };
+
+		if (ms > budget_ms * 1.05f)
+		{
+			over_budget[over_count++] = bar;
+		}
+		else
+		{
+			within_budget[within_count++] = bar;
+		}
+	}
+
+	SDL_SetRenderDrawColor(renderer, 0x40, 0xC0, 0x40, 0xFF);
+	SDL_RenderFillRects(renderer, within_budget.data(), within_count);
+	SDL_SetRenderDrawColor(renderer, 0xE0, 0x40, 0x40, 0xFF);
+	SDL_RenderFillRects(renderer, over_budget.data(), over_count);
+
+	const int budget_y = graph_top + graph_height - static_cast<int>(budget_ms / graph_ms * graph_height);
+
+	SDL_SetRenderDrawColor(renderer, 0x80, 0x80, 0x80, 0xFF);
+	SDL_RenderDrawLine(renderer, left + margin, budget_y, left + margin + (history * bar_width), budget_y);
+	draw_calls += 3;
+
+	return draw_calls;
+}
@@ -0,0 +1,177 @@
+#include "PerformanceGovernor.hpp"
+#include "Utils/Constants.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+PerformanceGovernor::PerformanceGovernor() :
+	level_(0),
+	budget_ms_(1000.0 / constants::ticks_per_second),
+	tick_seconds_(1.0 / constants::ticks_per_second),
+	average_ms_(0.0),
+	over_samples_(0),
+	under_samples_(0),
+	log_(nullptr),
+	decisions_(0)
+{
+}
+
+PerformanceGovernor::~PerformanceGovernor()
+{
+	if (log_ != nullptr)
+	{
+		std::fclose(log_);
+	}
+}
+
+bool PerformanceGovernor::Configure(const char* policies, const char* log_path, double budget_ms, int tick_rate)
+{
+	policies_.clear();
+	budget_ms_ = budget_ms;
+	tick_seconds_ = 1.0 / tick_rate;
+
+	const std::string list = std::strcmp(policies, "all") == 0 ? "splits,bullets,render,hud" : policies;
+	std::size_t begin = 0;
+
+	while (begin <= list.size())
+	{
+		const std::size_t end = std::min(list.find(',', begin), list.size());
+		const std::string name = list.substr(begin, end - begin);
+		begin = end + 1;
+
+		GovernorPolicy policy;
+
+		if (name == "splits")
+		{
+			policy = GovernorPolicy::CAP_SPLITS;
+		}
+		else if (name == "bullets")
+		{
+			policy = GovernorPolicy::CAP_BULLETS;
+		}
+		else if (name == "render")
+		{
+			policy = GovernorPolicy::CHEAP_RENDER;
+		}
+		else if (name == "hud")
+		{
+			policy = GovernorPolicy::SLOW_HUD;
+		}
+		else
+		{
+			printf("Unknown governor policy: %s\n", name.c_str());
+			return false;
+		}
+
+		if (std::find(policies_.begin(), policies_.end(), policy) == policies_.end())
+		{
+			policies_.push_back(policy);
+		}
+	}
+
+	if (log_ != nullptr)
+	{
+		std::fclose(log_);
+		log_ = nullptr;
+	}
+
+	if (log_path != nullptr && log_path[0] != '\0')
+	{
+		log_ = std::fopen(log_path, "w");
+
+		if (log_ == nullptr)
+		{
+			printf("Unable to open governor log %s\n", log_path);
+			return false;
+		}
+
+		std::fprintf(log_, "tick,seconds,average_ms,budget_ms,action,policy,level\n");
+	}
+
+	return true;
+}
+
+bool PerformanceGovernor::Enabled() const
+{
+	return !policies_.empty();
+}
+
+void PerformanceGovernor::AddSample(double work_ms, std::uint64_t tick)
+{
+	if (policies_.empty())
+	{
+		return;
+	}
+
+	// About a quarter second of smoothing at 60 samples a second, so a single hitch does not trigger anything.
+	average_ms_ += (work_ms - average_ms_) * 0.06;
+
+	over_samples_ = average_ms_ > budget_ms_ * escalate_ratio ? over_samples_ + 1 : 0;
+	under_samples_ = average_ms_ < budget_ms_ * recover_ratio ? under_samples_ + 1 : 0;
+
+	// Counters restart after every decision so the previous one gets time to show its effect.
+	if (over_samples_ >= escalate_samples && level_ < policies_.size())
+	{
+		++level_;
+		Log(tick, "apply", policies_[level_ - 1]);
+		over_samples_ = 0;
+		under_samples_ = 0;
+	}
+	else if (under_samples_ >= recover_samples && level_ > 0)
+	{
+		--level_;
+		Log(tick, "lift", policies_[level_]);
+		over_samples_ = 0;
+		under_samples_ = 0;
+	}
+}
+
+bool PerformanceGovernor::Active(GovernorPolicy policy) const
+{
+	for (std::size_t i = 0; i < level_; ++i)
+	{
+		if (policies_[i] == policy)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::size_t PerformanceGovernor::Level() const
+{
+	return level_;
+}
+
+const char* PerformanceGovernor::Name(GovernorPolicy policy)
+{
+	switch (policy)
+	{
+	case GovernorPolicy::CAP_SPLITS:
+		return "cap-splits";
+	case GovernorPolicy::CAP_BULLETS:
+		return "cap-bullets";
+	case GovernorPolicy::CHEAP_RENDER:
+		return "cheap-render";
+	case GovernorPolicy::SLOW_HUD:
+		return "slow-hud";
+	}
+
+	return "unknown";
+}
+
+void PerformanceGovernor::Log(std::uint64_t tick, const char* action, GovernorPolicy policy)
+{
+	const double seconds = static_cast<double>(tick) * tick_seconds_;
+
+	++decisions_;
+	printf("Governor: tick %llu (%.1f s), %.2f ms average against %.2f ms: %s %s, level %zu of %zu\n", static_cast<unsigned long long>(tick), seconds, average_ms_, budget_ms_, action, Name(policy), level_, policies_.size());
+
+	if (log_ != nullptr)
+	{
+		std::fprintf(log_, "%llu,%.3f,%.3f,%.3f,%s,%s,%zu\n", static_cast<unsigned long long>(tick), seconds, average_ms_, budget_ms_, action, Name(policy), level_);
+		std::fflush(log_);
+	}
+}
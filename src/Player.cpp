@@ -2,14 +2,13 @@
 #include "Player.hpp"
 #include "Game.hpp"
 
-#include <SDL2/SDL_mixer.h>
-
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 
-Player::Player(Game* game, int lives) : LinePolygon(game), moving_(false), rotating_degrees_(0), lives_(lives)
+Player::Player(Game* game, int lives) : LinePolygon(game), moving_(false), rotating_degrees_(0), lives_(lives), buttons_(0), local_(true), spawn_offset_({ 0.0f, 0.0f })
 {
+	mesh_id_ = constants::player_mesh_id;
 	CreatePlayerGeometry();
 }
 
@@ -19,7 +18,7 @@ void Player::CreatePlayerGeometry()
 	AddPoint(12.0, 10.0);
 	AddPoint(0.0, -30.0);
 
-	TranslateGeometry(constants::screen_width / 2.0, constants::screen_height / 2.0);
+	TranslateGeometry(game_->world_width_ / 2.0, game_->world_height_ / 2.0);
 
 	direction_vector_.x = geometry_[2].x - center_.x;
 	direction_vector_.y = geometry_[2].y - center_.y;	
@@ -27,77 +26,93 @@ void Player::CreatePlayerGeometry()
 
 void Player::HandleEvent(SDL_Event* e)
 {
-	const int rotation_degrees = 5;
-	const double acceleration = 0.2;
+	if ((e->type != SDL_KEYDOWN && e->type != SDL_KEYUP) || e->key.repeat != 0)
+	{
+		return;
+	}
 
-	if (e->type == SDL_KEYDOWN && e->key.repeat == 0)
+	std::uint8_t button = 0;
+
+	switch (e->key.keysym.sym)
 	{
-		if (e->key.keysym.sym == SDLK_LEFT)
-		{
-			rotating_degrees_ -= rotation_degrees;
-		}
-		else if (e->key.keysym.sym == SDLK_RIGHT)
-		{
-			rotating_degrees_ += rotation_degrees;
-		}
-		
-		if (e->key.keysym.sym == SDLK_UP)
-		{
-			moving_ = true;
-		
-			acceleration_vector_ = direction_vector_;
-			VecSetLength(&acceleration_vector_, acceleration);
-		}
-		if (!game_->game_over_ && e->key.keysym.sym == SDLK_SPACE)
-		{
-			Shoot();
-		}
+	case SDLK_LEFT:
+		button = input::LEFT;
+		break;
+	case SDLK_RIGHT:
+		button = input::RIGHT;
+		break;
+	case SDLK_UP:
+		button = input::THRUST;
+		break;
+	case SDLK_SPACE:
+		button = input::FIRE;
+		break;
 	}
-	else if (e->type == SDL_KEYUP && e->key.repeat == 0)
+
+	if (button != 0)
 	{
-		if (e->key.keysym.sym == SDLK_LEFT)
-		{
-			rotating_degrees_ += rotation_degrees;
-		}
-		else if (e->key.keysym.sym == SDLK_RIGHT)
+		ApplyInput(e->type == SDL_KEYDOWN ? (buttons_ | button) : (buttons_ & ~button));
+	}
+}
+
+void Player::ApplyInput(std::uint8_t buttons)
+{
+	const std::uint8_t pressed = buttons & ~buttons_;
+	const std::uint8_t released = buttons_ & ~buttons;
+
+	buttons_ = buttons;
+	rotating_degrees_ = ((buttons & input::RIGHT) ? constants::ship_turn_rate : 0) - ((buttons & input::LEFT) ? constants::ship_turn_rate : 0);
+
+	if (pressed & input::THRUST)
+	{
+		moving_ = true;
+
+		acceleration_vector_ = direction_vector_;
+		VecSetLength(&acceleration_vector_, constants::ship_thrust);
+	}
+
+	if ((pressed & input::FIRE) && !game_->game_over_)
+	{
+		Shoot();
+	}
+
+	if (released & input::THRUST)
+	{
+		moving_ = false;
+		acceleration_vector_.x = -acceleration_vector_.x;
+		acceleration_vector_.y = -acceleration_vector_.y;
+
+		if ((acceleration_vector_.x > 0.0 && velocity_vector_.x > 0.0) || (acceleration_vector_.x < 0.0 && velocity_vector_.x < 0.0))
 		{
-			rotating_degrees_ -= rotation_degrees;
+			acceleration_vector_.x *= -1.0f;
 		}
 
-		if (e->key.keysym.sym == SDLK_UP)
+		if ((acceleration_vector_.y > 0.0 && velocity_vector_.y > 0.0) || (acceleration_vector_.y < 0.0 && velocity_vector_.y < 0.0))
 		{
-			moving_ = false;
-			acceleration_vector_.x = -acceleration_vector_.x;
-			acceleration_vector_.y = -acceleration_vector_.y;
-
-			if ((acceleration_vector_.x > 0.0 && velocity_vector_.x > 0.0) || (acceleration_vector_.x < 0.0 && velocity_vector_.x < 0.0))
-			{
-				acceleration_vector_.x *= -1.0f;
-			}
-
-			if ((acceleration_vector_.y > 0.0 && velocity_vector_.y > 0.0) || (acceleration_vector_.y < 0.0 && velocity_vector_.y < 0.0))
-			{
-				acceleration_vector_.y *= -1.0f;
-			}
+			acceleration_vector_.y *= -1.0f;
 		}
 	}
 }
 	
 void Player::Tick()
 {
-	RotateGeometry(rotating_degrees_);
+	const double dt = game_->tick_seconds_;
+
+	RotateGeometry(rotating_degrees_ * dt);
 
 	direction_vector_.x = geometry_[2].x - center_.x;
 	direction_vector_.y = geometry_[2].y - center_.y;
 
 	if (moving_)
 	{
-		const double acceleration = 0.2;
 		acceleration_vector_ = direction_vector_;
-		VecSetLength(&acceleration_vector_, acceleration);
+		VecSetLength(&acceleration_vector_, constants::ship_thrust);
+
+		const SDL_FPoint tail = { (geometry_[0].x + geometry_[1].x) / 2.0f, (geometry_[0].y + geometry_[1].y) / 2.0f };
+		game_->AddThrust(tail, direction_vector_);
 	}
 
- 	MoveGeometry(acceleration_vector_.x, acceleration_vector_.y);
+ 	MoveGeometry(acceleration_vector_.x * dt, acceleration_vector_.y * dt);
  	HandleCollision();
 }
 
@@ -108,8 +123,8 @@ void Player::MoveGeometry(double ax, double ay)
 	
 	if (moving_)
 	{
-		velocity_vector_.x = std::clamp(velocity_vector_.x, -5.0f, 5.0f);
-		velocity_vector_.y = std::clamp(velocity_vector_.y, -5.0f, 5.0f);
+		velocity_vector_.x = std::clamp(velocity_vector_.x, -constants::ship_max_speed, constants::ship_max_speed);
+		velocity_vector_.y = std::clamp(velocity_vector_.y, -constants::ship_max_speed, constants::ship_max_speed);
 	}
 	else
 	{
@@ -124,13 +139,16 @@ void Player::MoveGeometry(double ax, double ay)
 		}
 	}
 
-	center_.x += velocity_vector_.x;
-	center_.y += velocity_vector_.y;
+	const float dx = static_cast<float>(velocity_vector_.x * game_->tick_seconds_);
+	const float dy = static_cast<float>(velocity_vector_.y * game_->tick_seconds_);
+
+	center_.x += dx;
+	center_.y += dy;
 
 	for (SDL_FPoint& point : geometry_)
 	{
-		point.x += velocity_vector_.x;
-		point.y += velocity_vector_.y;
+		point.x += dx;
+		point.y += dy;
 	}
 
 	WrapGeometryAroundScreen();
@@ -138,7 +156,10 @@ void Player::MoveGeometry(double ax, double ay)
 
 void Player::Shoot()
 {
-	game_->AddBullet(geometry_[2].x, geometry_[2].y, direction_vector_.x, direction_vector_.y);
+	SDL_FPoint bullet_velocity = direction_vector_;
+	VecSetLength(&bullet_velocity, constants::bullet_speed);
+
+	game_->AddBullet(geometry_[2].x, geometry_[2].y, bullet_velocity.x, bullet_velocity.y);
 	game_->PlayShootSound();
 }
 
@@ -153,6 +174,7 @@ void Player::HandleCollision()
 			if (dist_squared < asteroid->furthest_distance_squared_)
 			{
 				game_->PlayAsteroidExplosionSound();
+				game_->AddExplosion(*asteroid);
 				asteroid->removed_ = true;
 				removed_ = true;
 				--lives_;
@@ -171,7 +193,9 @@ void Player::HandleCollision()
 
 void Player::ResetPlayer()
 {
+	// A held thrust engages again on the next input instead of being released later as if it were still active.
 	moving_ = false;
+	buttons_ &= ~input::THRUST;
 	velocity_vector_.x = 0.0;
 	velocity_vector_.y = 0.0;
 	acceleration_vector_.x = 0.0;
@@ -179,10 +203,10 @@ void Player::ResetPlayer()
 
 	if (lives_ > 0)
 	{
-		TranslateGeometry((constants::screen_width / 2.0) - center_.x, (constants::screen_height / 2.0) - center_.y);
+		TranslateGeometry((game_->world_width_ / 2.0) + spawn_offset_.x - center_.x, (game_->world_height_ / 2.0) + spawn_offset_.y - center_.y);
 		removed_ = false;
 	}
-	else
+	else if (local_)
 	{
 		game_->game_over_ = true;
 	}
@@ -0,0 +1,420 @@
+#include "Replay.hpp"
+#include "Game.hpp"
+#include "Snapshot.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+ReplayWriter::ReplayWriter() :
+	file_(nullptr),
+	keyframe_ticks_(1),
+	position_(0),
+	ticks_(0),
+	input_bytes_(0)
+{
+}
+
+ReplayWriter::~ReplayWriter()
+{
+	Close();
+}
+
+bool ReplayWriter::Open(const char* path, const Game& game, std::uint32_t keyframe_ticks, int initial_asteroids, int spawn_budget)
+{
+	Close();
+
+	file_ = std::fopen(path, "wb");
+
+	if (file_ == nullptr)
+	{
+		printf("Unable to open replay %s!\n", path);
+		return false;
+	}
+
+	// Keyframes are a few kilobytes and records a byte or two, so a large buffer keeps writes off the tick.
+	std::setvbuf(file_, nullptr, _IOFBF, 256 * 1024);
+
+	path_ = path;
+	keyframe_ticks_ = std::max<std::uint32_t>(keyframe_ticks, 1);
+	position_ = 0;
+	ticks_ = 0;
+	input_bytes_ = 0;
+	pending_inputs_.clear();
+	index_.clear();
+
+	replay::Header header = {};
+	std::memcpy(header.magic, replay::magic, sizeof(header.magic));
+	header.version = replay::version;
+	header.snapshot_version = snapshot::version;
+	header.tick_rate = static_cast<std::uint32_t>(game.tick_rate_);
+	header.keyframe_ticks = keyframe_ticks_;
+	header.initial_asteroids = static_cast<std::uint32_t>(initial_asteroids);
+	header.spawn_budget = static_cast<std::uint32_t>(spawn_budget);
+	Write(&header, sizeof(header));
+
+	return true;
+}
+
+void ReplayWriter::Write(const void* data, std::size_t size)
+{
+	std::fwrite(data, 1, size, file_);
+	position_ += size;
+}
+
+void ReplayWriter::AddInput(std::uint8_t buttons)
+{
+	// Far more changes than a tick can see from a keyboard; anything past the count byte is dropped.
+	if (pending_inputs_.size() < 0xFF)
+	{
+		pending_inputs_.push_back(buttons);
+	}
+}
+
+void ReplayWriter::Record(const Game& game)
+{
+	if (file_ == nullptr)
+	{
+		return;
+	}
+
+	if (ticks_ % keyframe_ticks_ == 0)
+	{
+		game.SaveSnapshot(&snapshot_);
+
+		replay::IndexEntry entry = {};
+		entry.tick = game.ticks_;
+		entry.offset = position_;
+		entry.snapshot_size = snapshot_.size();
+		index_.push_back(entry);
+
+		const replay::SegmentHeader segment = { game.ticks_, snapshot_.size() };
+		Write(&segment, sizeof(segment));
+		Write(snapshot_.data(), snapshot_.size());
+	}
+
+	const std::size_t count = pending_inputs_.size();
+	std::uint8_t record[2];
+	std::size_t record_size = 1;
+
+	record[0] = static_cast<std::uint8_t>(std::min<std::size_t>(count, replay::long_input_count));
+
+	if (count >= replay::long_input_count)
+	{
+		record[1] = static_cast<std::uint8_t>(count);
+		record_size = 2;
+	}
+
+	record[0] |= game.reset_game_ ? replay::reset_game_flag : 0;
+	record[0] |= game.asteroid_collisions_ ? replay::asteroid_collisions_flag : 0;
+
+	Write(record, record_size);
+	Write(pending_inputs_.data(), count);
+
+	replay::IndexEntry& entry = index_.back();
+	entry.input_size += record_size + count;
+	++entry.ticks;
+
+	input_bytes_ += record_size + count;
+	++ticks_;
+	pending_inputs_.clear();
+}
+
+bool ReplayWriter::Close()
+{
+	if (file_ == nullptr)
+	{
+		return true;
+	}
+
+	// The index is read in place from the mapping, so it starts on an 8-byte boundary.
+	const std::uint8_t padding[8] = {};
+	Write(padding, (8 - position_ % 8) % 8);
+
+	replay::Footer footer = {};
+	footer.index_offset = position_;
+	footer.segment_count = index_.size();
+	footer.total_ticks = ticks_;
+	std::memcpy(footer.magic, replay::magic, sizeof(footer.magic));
+
+	Write(index_.data(), index_.size() * sizeof(replay::IndexEntry));
+	Write(&footer, sizeof(footer));
+
+	const bool written = std::ferror(file_) == 0;
+	const bool closed = std::fclose(file_) == 0;
+	file_ = nullptr;
+
+	if (!written || !closed)
+	{
+		printf("Unable to write replay %s!\n", path_.c_str());
+		return false;
+	}
+
+	printf("Replay: %llu ticks, %zu keyframes, %.1f KB written to %s, %.2f bytes of input per tick\n", static_cast<unsigned long long>(ticks_), index_.size(), static_cast<double>(position_) / 1024.0, path_.c_str(), ticks_ > 0 ? static_cast<double>(input_bytes_) / static_cast<double>(ticks_) : 0.0);
+
+	return true;
+}
+
+ReplayReader::ReplayReader() :
+	mapping_(nullptr),
+	mapping_size_(0),
+	header_(),
+	index_(nullptr),
+	segment_count_(0),
+	end_tick_(0),
+	segment_(0),
+	record_(nullptr),
+	tick_(0),
+	applied_(false)
+{
+}
+
+ReplayReader::~ReplayReader()
+{
+	Close();
+}
+
+bool ReplayReader::Open(const char* path)
+{
+	Close();
+
+	const int descriptor = open(path, O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		printf("Unable to open replay %s!\n", path);
+		return false;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(descriptor, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(replay::Header) + sizeof(replay::Footer))
+	{
+		printf("Replay %s is truncated\n", path);
+		close(descriptor);
+		return false;
+	}
+
+	const std::size_t size = static_cast<std::size_t>(file_stat.st_size);
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+	// The mapping stays valid after the descriptor is closed.
+	close(descriptor);
+
+	if (mapping == MAP_FAILED)
+	{
+		printf("Unable to map replay %s!\n", path);
+		return false;
+	}
+
+	const std::uint8_t* data = static_cast<const std::uint8_t*>(mapping);
+	replay::Header header;
+	replay::Footer footer;
+	std::memcpy(&header, data, sizeof(header));
+	std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+
+	bool valid = std::memcmp(header.magic, replay::magic, sizeof(header.magic)) == 0 && header.version == replay::version && header.snapshot_version == snapshot::version;
+	valid = valid && std::memcmp(footer.magic, replay::magic, sizeof(footer.magic)) == 0 && footer.segment_count > 0 && footer.index_offset % 8 == 0;
+	valid = valid && footer.index_offset <= size - sizeof(footer) && footer.segment_count == (size - sizeof(footer) - footer.index_offset) / sizeof(replay::IndexEntry);
+
+	const replay::IndexEntry* index = valid ? reinterpret_cast<const replay::IndexEntry*>(data + footer.index_offset) : nullptr;
+	std::uint64_t ticks = 0;
+
+	for (std::uint64_t i = 0; valid && i < footer.segment_count; ++i)
+	{
+		const replay::IndexEntry& entry = index[i];
+		const std::uint64_t end = entry.offset + sizeof(replay::SegmentHeader) + entry.snapshot_size + entry.input_size;
+
+		valid = entry.offset >= sizeof(header) && end <= footer.index_offset && entry.ticks > 0 && (i == 0 || entry.tick == index[i - 1].tick + index[i - 1].ticks);
+		ticks += entry.ticks;
+	}
+
+	if (!valid || ticks != footer.total_ticks)
+	{
+		printf("Replay %s has an unknown format or version, or was not closed\n", path);
+		munmap(mapping, size);
+		return false;
+	}
+
+	mapping_ = mapping;
+	mapping_size_ = size;
+	header_ = header;
+	index_ = index;
+	segment_count_ = static_cast<std::size_t>(footer.segment_count);
+	end_tick_ = index[0].tick + footer.total_ticks;
+
+	// Playback reads front to back; seeks land on a keyframe and read forward from there.
+	madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+
+	// Nothing is played until the first Seek restores a keyframe.
+	segment_ = segment_count_;
+	record_ = nullptr;
+	tick_ = index[0].tick;
+	applied_ = false;
+
+	return true;
+}
+
+void ReplayReader::Close()
+{
+	if (mapping_ == nullptr)
+	{
+		return;
+	}
+
+	munmap(mapping_, mapping_size_);
+	mapping_ = nullptr;
+	mapping_size_ = 0;
+	index_ = nullptr;
+	segment_count_ = 0;
+	end_tick_ = 0;
+	record_ = nullptr;
+}
+
+const replay::Header& ReplayReader::Info() const
+{
+	return header_;
+}
+
+std::uint64_t ReplayReader::FirstTick() const
+{
+	return segment_count_ > 0 ? index_[0].tick : 0;
+}
+
+std::uint64_t ReplayReader::EndTick() const
+{
+	return end_tick_;
+}
+
+std::uint64_t ReplayReader::Tick() const
+{
+	return tick_;
+}
+
+const std::uint8_t* ReplayReader::Data(std::uint64_t offset) const
+{
+	return static_cast<const std::uint8_t*>(mapping_) + offset;
+}
+
+void ReplayReader::EnterSegment(std::size_t segment)
+{
+	// Pages of the segments behind are given back; the kernel reads them in again if a seek returns there.
+	if (segment > segment_)
+	{
+		const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+		const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(Data(index_[segment_].offset)) / page * page;
+		const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(Data(index_[segment].offset)) / page * page;
+
+		if (end > begin)
+		{
+			madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+		}
+	}
+
+	segment_ = segment;
+	record_ = Data(index_[segment].offset + sizeof(replay::SegmentHeader) + index_[segment].snapshot_size);
+	tick_ = index_[segment].tick;
+}
+
+void ReplayReader::ApplyRecord(Game* game)
+{
+	if (applied_ || tick_ >= end_tick_)
+	{
+		return;
+	}
+
+	const std::uint8_t flags = record_[0];
+	const std::uint8_t* inputs = record_ + 1;
+	std::size_t count = flags & replay::input_count_mask;
+
+	if (count == replay::long_input_count)
+	{
+		count = *inputs++;
+	}
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		game->ApplyInput(inputs[i]);
+	}
+
+	game->reset_game_ = (flags & replay::reset_game_flag) != 0;
+	game->asteroid_collisions_ = (flags & replay::asteroid_collisions_flag) != 0;
+	applied_ = true;
+}
+
+bool ReplayReader::Step(Game* game)
+{
+	if (record_ == nullptr || tick_ >= end_tick_)
+	{
+		return false;
+	}
+
+	ApplyRecord(game);
+	game->Tick();
+
+	const std::size_t count = record_[0] & replay::input_count_mask;
+	record_ += count == replay::long_input_count ? 2 + record_[1] : 1 + count;
+	++tick_;
+	applied_ = false;
+
+	// Playback runs straight on into the next segment; its keyframe is only needed to seek there.
+	if (tick_ < end_tick_ && segment_ + 1 < segment_count_ && tick_ == index_[segment_ + 1].tick)
+	{
+		EnterSegment(segment_ + 1);
+	}
+
+	return true;
+}
+
+bool ReplayReader::Seek(Game* game, std::uint64_t tick)
+{
+	if (mapping_ == nullptr)
+	{
+		return false;
+	}
+
+	tick = std::clamp(tick, FirstTick(), end_tick_);
+
+	const replay::IndexEntry* entry = std::upper_bound(index_, index_ + segment_count_, tick, [](std::uint64_t target, const replay::IndexEntry& segment)
+	{
+		return target < segment.tick;
+	}) - 1;
+
+	const std::size_t segment = static_cast<std::size_t>(entry - index_);
+
+	// A target further on in the current segment is reached from where playback is; anything else starts at a keyframe.
+	if (record_ == nullptr || segment != segment_ || tick < tick_)
+	{
+		// Pending spawns in the snapshot are timed relative to the game's tick.
+		game->ticks_ = entry->tick;
+
+		if (!game->RestoreSnapshot(Data(entry->offset + sizeof(replay::SegmentHeader)), static_cast<std::size_t>(entry->snapshot_size)))
+		{
+			return false;
+		}
+
+		game->Particles()->Clear();
+
+		EnterSegment(segment);
+		applied_ = true;
+	}
+
+	game->resimulating_ = true;
+
+	while (tick_ < tick)
+	{
+		Step(game);
+	}
+
+	game->resimulating_ = false;
+
+	ApplyRecord(game);
+	game->UpdateScoreText();
+	game->UpdateLivesText();
+
+	return true;
+}
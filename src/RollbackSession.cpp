@@ -0,0 +1,276 @@
+#include "RollbackSession.hpp"
+#include "Game.hpp"
+#include "Player.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+	double SecondsSince(std::uint64_t start)
+	{
+		return static_cast<double>(SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+} // namespace
+
+namespace net
+{
+	RollbackSession::RollbackSession(Game* game, int local_index, int window) : game_(game), local_index_(local_index), window_(static_cast<std::uint32_t>(std::clamp(window, 1, max_rollback_window))), peer_{}, link_(&socket_), remote_inputs_{}, frame_(0), remote_frames_(0), remote_ack_(0), rollback_to_(UINT32_MAX)
+	{
+	}
+
+	bool RollbackSession::Open(std::uint16_t port, const char* peer_host, std::uint16_t peer_port, const LinkConditions& conditions, std::uint32_t seed)
+	{
+		link_.Configure(conditions, seed);
+
+		return UdpSocket::Resolve(peer_host, peer_port, &peer_) && socket_.Open(port);
+	}
+
+	std::uint8_t RollbackSession::PredictRemote(std::uint32_t frame) const
+	{
+		if (frame < remote_frames_)
+		{
+			return remote_inputs_[frame % rollback_ring_size];
+		}
+
+		return remote_frames_ == 0 ? 0 : remote_inputs_[(remote_frames_ - 1) % rollback_ring_size];
+	}
+
+	void RollbackSession::Simulate(std::uint32_t frame, bool save)
+	{
+		Frame& state = frames_[frame % rollback_ring_size];
+		const std::vector<std::unique_ptr<Player>>& ships = game_->RemotePlayers();
+
+		if (save)
+		{
+			game_->SaveSnapshot(&state.state);
+		}
+
+		state.remote = PredictRemote(frame);
+
+		// Both peers must apply input in the same ship order; firing adds bullets.
+		ships[0]->ApplyInput(local_index_ == 0 ? state.local : state.remote);
+		ships[1]->ApplyInput(local_index_ == 1 ? state.local : state.remote);
+		game_->Tick();
+	}
+
+	void RollbackSession::ReceiveInputs()
+	{
+		std::uint8_t buffer[max_packet_size];
+		sockaddr_in from;
+		int received;
+
+		while ((received = socket_.Receive(buffer, sizeof(buffer), &from)) >= 0)
+		{
+			ByteReader reader(buffer, static_cast<std::size_t>(received));
+
+			if (static_cast<PacketType>(reader.U8()) != PacketType::ROLLBACK_INPUT)
+			{
+				continue;
+			}
+
+			const std::uint32_t ack = reader.U32();
+			const std::uint32_t first = reader.U32();
+			const std::uint8_t count = reader.U8();
+
+			if (reader.Error())
+			{
+				continue;
+			}
+
+			remote_ack_ = std::max(remote_ack_, std::min(ack, frame_));
+
+			// Every packet repeats all unacknowledged input, so anything but the next expected frame is a duplicate or a gap.
+			for (std::uint32_t frame = first; frame < first + count; ++frame)
+			{
+				const std::uint8_t buttons = reader.U8();
+
+				if (reader.Error() || frame > remote_frames_)
+				{
+					break;
+				}
+
+				if (frame < remote_frames_)
+				{
+					continue;
+				}
+
+				remote_inputs_[frame % rollback_ring_size] = buttons;
+				++remote_frames_;
+
+				if (frame < frame_ && frames_[frame % rollback_ring_size].remote != buttons)
+				{
+					rollback_to_ = std::min(rollback_to_, frame);
+					++stats_.mispredictions;
+				}
+			}
+		}
+	}
+
+	void RollbackSession::Resimulate()
+	{
+		if (rollback_to_ >= frame_)
+		{
+			rollback_to_ = UINT32_MAX;
+			return;
+		}
+
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		const Frame& restore = frames_[rollback_to_ % rollback_ring_size];
+
+		// Snapshots leave the tick count alone, and pending spawns in them are timed relative to it.
+		game_->ticks_ = rollback_to_;
+		game_->RestoreSnapshot(restore.state.data(), restore.state.size());
+		game_->resimulating_ = true;
+
+		for (std::uint32_t frame = rollback_to_; frame < frame_; ++frame)
+		{
+			Simulate(frame, frame != rollback_to_);
+		}
+
+		game_->resimulating_ = false;
+		game_->UpdateScoreText();
+
+		const double elapsed_ms = SecondsSince(start) * 1000.0;
+		const std::size_t depth = frame_ - rollback_to_;
+
+		++stats_.rollbacks;
+		stats_.resimulated_ticks += depth;
+		stats_.max_depth = std::max(stats_.max_depth, depth);
+		stats_.resimulate_ms_total += elapsed_ms;
+		stats_.resimulate_ms_max = std::max(stats_.resimulate_ms_max, elapsed_ms);
+
+		rollback_to_ = UINT32_MAX;
+	}
+
+	void RollbackSession::SendInputs(double now)
+	{
+		const std::uint32_t first = std::max(remote_ack_, frame_ - std::min<std::uint32_t>(frame_, rollback_ring_size));
+		std::uint8_t buffer[16 + rollback_ring_size];
+		ByteWriter writer(buffer, sizeof(buffer));
+
+		writer.U8(static_cast<std::uint8_t>(PacketType::ROLLBACK_INPUT));
+		writer.U32(remote_frames_);
+		writer.U32(first);
+		writer.U8(static_cast<std::uint8_t>(frame_ - first));
+
+		for (std::uint32_t frame = first; frame < frame_; ++frame)
+		{
+			writer.U8(frames_[frame % rollback_ring_size].local);
+		}
+
+		link_.Send(peer_, buffer, writer.Size(), now);
+		link_.Flush(now);
+	}
+
+	bool RollbackSession::AdvanceFrame(std::uint8_t local_buttons, double now)
+	{
+		ReceiveInputs();
+		Resimulate();
+
+		if (frame_ >= remote_frames_ + window_)
+		{
+			++stats_.stalls;
+			SendInputs(now);
+			return false;
+		}
+
+		frames_[frame_ % rollback_ring_size].local = local_buttons;
+		Simulate(frame_, true);
+		++frame_;
+		++stats_.frames;
+
+		SendInputs(now);
+		return true;
+	}
+
+	void RollbackSession::Poll(double now)
+	{
+		ReceiveInputs();
+		Resimulate();
+		SendInputs(now);
+	}
+
+	std::uint32_t RollbackSession::CurrentFrame() const
+	{
+		return frame_;
+	}
+
+	std::uint32_t RollbackSession::ConfirmedFrames() const
+	{
+		return remote_frames_;
+	}
+
+	int RunRollback(const Options& options)
+	{
+		const int player = options.rollback_player;
+		std::unique_ptr<Game> game = std::make_unique<Game>();
+		game->ApplyOptions(options);
+		game->Seed(options.seed.value_or(1));
+		game->local_player_ = false;
+		game->AddRemotePlayer();
+		game->AddRemotePlayer();
+
+		std::unique_ptr<RollbackSession> session = std::make_unique<RollbackSession>(game.get(), player, options.rollback_window);
+		const std::uint16_t port = static_cast<std::uint16_t>(options.port + player);
+		const std::uint16_t peer_port = static_cast<std::uint16_t>(options.port + 1 - player);
+
+		LinkConditions link;
+		link.latency_ms = options.net_latency_ms;
+		link.jitter_ms = options.net_jitter_ms;
+		link.loss = options.net_loss;
+
+		if (!session->Open(port, options.peer_host.c_str(), peer_port, link, static_cast<std::uint32_t>(player + 1)) || !game->Initialize())
+		{
+			return 1;
+		}
+
+		printf("Rollback session: ship %d on UDP port %u, peer %s:%u, window %d ticks\n", player, port, options.peer_host.c_str(), peer_port, options.rollback_window);
+
+		constexpr double tick_seconds = 1.0 / constants::ticks_per_second;
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		double last_time = 0.0;
+		double delta = 0.0;
+
+		game->is_running_ = true;
+
+		while (game->is_running_)
+		{
+			const double now = SecondsSince(start);
+
+			// A stalled session keeps its backlog only up to one window; beyond that the game slows down instead.
+			delta = std::min(delta + now - last_time, tick_seconds * options.rollback_window);
+			last_time = now;
+
+			game->HandleEvents();
+
+			const Uint8* keys = SDL_GetKeyboardState(nullptr);
+			std::uint8_t buttons = 0;
+			buttons |= keys[SDL_SCANCODE_LEFT] ? input::LEFT : 0;
+			buttons |= keys[SDL_SCANCODE_RIGHT] ? input::RIGHT : 0;
+			buttons |= keys[SDL_SCANCODE_UP] ? input::THRUST : 0;
+			buttons |= keys[SDL_SCANCODE_SPACE] ? input::FIRE : 0;
+
+			session->Poll(now);
+
+			while (delta >= tick_seconds && session->AdvanceFrame(buttons, now))
+			{
+				delta -= tick_seconds;
+			}
+
+			game->Render();
+		}
+
+		const RollbackStats& stats = session->stats_;
+
+		printf("Rollback: %zu ticks, %zu stalls, %zu mispredicted inputs, %zu rollbacks resimulated %zu ticks (max %zu), %.3f ms per rollback, %.3f ms max\n",
+			stats.frames, stats.stalls, stats.mispredictions, stats.rollbacks, stats.resimulated_ticks, stats.max_depth,
+			stats.resimulate_ms_total / std::max<std::size_t>(stats.rollbacks, 1), stats.resimulate_ms_max);
+
+		return 0;
+	}
+} // namespace net
@@ -0,0 +1,331 @@
+#include "Scenario.hpp"
+#include "Game.hpp"
+#include "Asteroid.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+	struct Profile
+	{
+		const char* name;
+		const char* description;
+		const char* text;
+	};
+
+	// Built-in profiles are written in the scenario file format and go through the same parser.
+	constexpr Profile profiles[] =
+	{
+		{ "field-10k", "10,000 colliding asteroids of all sizes in an arena 8x the screen",
+			"seed 1\nduration 30\nworld_scale 8\nasteroid_collisions 1\nlarge 2000\nmedium 3000\nsmall 5000\n" },
+		{ "autofire-storm", "3,000 bullets a second through a field that keeps refilling",
+			"seed 2\nduration 30\nworld_scale 2\nlarge 150\nmedium 150\nsmall 200\nspawn_large 5\nmax_asteroids 1500\nbullets 3000\n" },
+		{ "split-cascade", "1,500 large asteroids shot apart into mediums and smalls",
+			"seed 3\nduration 60\nworld_scale 3\nlarge 1500\nbullets 1200\n" },
+		{ "dense-collisions", "3,000 medium asteroids bouncing in an arena twice the screen",
+			"seed 4\nduration 30\nworld_scale 2\nasteroid_collisions 1\nmedium 3000\n" },
+		{ "steady-waves", "a continuous stream of spawns up to 8,000 asteroids, with collisions and light fire",
+			"seed 5\nduration 120\nworld_scale 4\nasteroid_collisions 1\nlarge 100\nspawn_large 20\nspawn_medium 20\nspawn_small 40\nmax_asteroids 8000\nbullets 200\n" },
+	};
+
+	double Percentile(std::vector<float> values, double percentile)
+	{
+		if (values.empty())
+		{
+			return 0.0;
+		}
+
+		const std::size_t rank = std::min(values.size() - 1, static_cast<std::size_t>(percentile / 100.0 * static_cast<double>(values.size())));
+		std::nth_element(values.begin(), values.begin() + rank, values.end());
+
+		return values[rank];
+	}
+
+	double Mean(const std::vector<float>& values)
+	{
+		double sum = 0.0;
+
+		for (const float value : values)
+		{
+			sum += value;
+		}
+
+		return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+	}
+} // namespace
+
+namespace scenario
+{
+	bool Parse(const char* text, const char* source, Scenario* scenario)
+	{
+		int line_number = 0;
+
+		while (*text != '\0')
+		{
+			const char* end = std::strchr(text, '\n');
+			const std::size_t length = end != nullptr ? static_cast<std::size_t>(end - text) : std::strlen(text);
+
+			char line[256];
+			std::snprintf(line, sizeof(line), "%.*s", static_cast<int>(length), text);
+			text += length + (end != nullptr ? 1 : 0);
+			++line_number;
+
+			if (char* comment = std::strchr(line, '#'))
+			{
+				*comment = '\0';
+			}
+
+			char key[64];
+			char value[128];
+			const int fields = std::sscanf(line, "%63s %127s", key, value);
+
+			if (fields <= 0)
+			{
+				continue;
+			}
+
+			if (fields != 2)
+			{
+				printf("%s:%d: expected a key and a value\n", source, line_number);
+				return false;
+			}
+
+			const double number = std::atof(value);
+
+			if (std::strcmp(key, "name") == 0)
+			{
+				scenario->name = value;
+			}
+			else if (std::strcmp(key, "seed") == 0)
+			{
+				scenario->seed = std::strtoull(value, nullptr, 10);
+			}
+			else if (std::strcmp(key, "duration") == 0)
+			{
+				scenario->duration_seconds = std::max(number, 0.0);
+			}
+			else if (std::strcmp(key, "world_scale") == 0)
+			{
+				scenario->world_scale = std::max(number, 1.0);
+			}
+			else if (std::strcmp(key, "asteroid_collisions") == 0)
+			{
+				scenario->asteroid_collisions = number != 0.0;
+			}
+			else if (std::strcmp(key, "large") == 0)
+			{
+				scenario->initial[static_cast<int>(AsteroidType::LARGE)] = std::max(static_cast<int>(number), 0);
+			}
+			else if (std::strcmp(key, "medium") == 0)
+			{
+				scenario->initial[static_cast<int>(AsteroidType::MEDIUM)] = std::max(static_cast<int>(number), 0);
+			}
+			else if (std::strcmp(key, "small") == 0)
+			{
+				scenario->initial[static_cast<int>(AsteroidType::SMALL)] = std::max(static_cast<int>(number), 0);
+			}
+			else if (std::strcmp(key, "spawn_large") == 0)
+			{
+				scenario->spawn_per_second[static_cast<int>(AsteroidType::LARGE)] = std::max(number, 0.0);
+			}
+			else if (std::strcmp(key, "spawn_medium") == 0)
+			{
+				scenario->spawn_per_second[static_cast<int>(AsteroidType::MEDIUM)] = std::max(number, 0.0);
+			}
+			else if (std::strcmp(key, "spawn_small") == 0)
+			{
+				scenario->spawn_per_second[static_cast<int>(AsteroidType::SMALL)] = std::max(number, 0.0);
+			}
+			else if (std::strcmp(key, "max_asteroids") == 0)
+			{
+				scenario->max_asteroids = std::max(static_cast<int>(number), 0);
+			}
+			else if (std::strcmp(key, "bullets") == 0)
+			{
+				scenario->bullets_per_second = std::max(number, 0.0);
+			}
+			else
+			{
+				printf("%s:%d: unknown scenario key %s\n", source, line_number, key);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Load(const char* path, Scenario* scenario)
+	{
+		std::FILE* file = std::fopen(path, "rb");
+
+		if (file == nullptr)
+		{
+			printf("Unknown scenario profile and unable to open scenario file: %s\n", path);
+			return false;
+		}
+
+		std::string text;
+		char buffer[4096];
+		std::size_t read = 0;
+
+		while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			text.append(buffer, read);
+		}
+
+		std::fclose(file);
+
+		scenario->name = path;
+
+		return Parse(text.c_str(), path, scenario);
+	}
+
+	bool Resolve(const std::string& name_or_path, Scenario* scenario)
+	{
+		for (const Profile& profile : profiles)
+		{
+			if (name_or_path == profile.name)
+			{
+				scenario->name = profile.name;
+				return Parse(profile.text, profile.name, scenario);
+			}
+		}
+
+		return Load(name_or_path.c_str(), scenario);
+	}
+
+	void PrintProfiles()
+	{
+		printf("Scenario profiles:\n");
+
+		for (const Profile& profile : profiles)
+		{
+			printf("  %-18s %s\n", profile.name, profile.description);
+		}
+	}
+} // namespace scenario
+
+ScenarioDriver::ScenarioDriver(const Scenario& scenario, int tick_rate) :
+	scenario_(scenario),
+	tick_rate_(tick_rate),
+	rng_(scenario.seed),
+	spawn_credit_(),
+	bullet_credit_(0.0),
+	started_(false),
+	tick_start_(0),
+	peak_asteroids_(0),
+	peak_bullets_(0)
+{
+	tick_ms_.reserve(static_cast<std::size_t>(Ticks()));
+}
+
+const Scenario& ScenarioDriver::Definition() const
+{
+	return scenario_;
+}
+
+std::uint64_t ScenarioDriver::Ticks() const
+{
+	return static_cast<std::uint64_t>(scenario_.duration_seconds * tick_rate_);
+}
+
+void ScenarioDriver::BeforeTick(Game* game)
+{
+	std::uniform_real_distribution<double> random_x(0.0, game->world_width_);
+	std::uniform_real_distribution<double> random_y(0.0, game->world_height_);
+	std::uniform_real_distribution<double> random_velocity(-constants::wave_speed, constants::wave_speed);
+	std::uniform_real_distribution<double> random_angle(0.0, 2.0 * M_PI);
+
+	const int large = static_cast<int>(AsteroidType::LARGE);
+
+	// The first tick replaces the game's opening wave with the scenario's field; afterwards rates accumulate per tick.
+	std::array<int, 3> spawns = {};
+
+	if (!started_)
+	{
+		started_ = true;
+		game->ClearAsteroids();
+		spawns = scenario_.initial;
+	}
+	else
+	{
+		for (std::size_t type = 0; type < spawns.size(); ++type)
+		{
+			spawn_credit_[type] += scenario_.spawn_per_second[type] / tick_rate_;
+			spawns[type] = static_cast<int>(spawn_credit_[type]);
+			spawn_credit_[type] -= spawns[type];
+		}
+
+		const int room = std::max(scenario_.max_asteroids - static_cast<int>(game->Asteroids().size()), 0);
+
+		for (int& count : spawns)
+		{
+			count = std::min(count, room);
+		}
+	}
+
+	if (spawns[large] > 0)
+	{
+		game->SpawnAsteroids(spawns[large]);
+	}
+
+	for (const AsteroidType type : { AsteroidType::MEDIUM, AsteroidType::SMALL })
+	{
+		for (int i = 0; i < spawns[static_cast<int>(type)]; ++i)
+		{
+			const double x = random_x(rng_);
+			const double y = random_y(rng_);
+			const double vx = random_velocity(rng_);
+			const double vy = random_velocity(rng_);
+
+			game->AddAsteroid(std::make_unique<Asteroid>(game, type, x, y, vx, vy));
+		}
+	}
+
+	bullet_credit_ += scenario_.bullets_per_second / tick_rate_;
+
+	for (; bullet_credit_ >= 1.0; bullet_credit_ -= 1.0)
+	{
+		constexpr double bullet_speed = 900.0;
+
+		const double x = random_x(rng_);
+		const double y = random_y(rng_);
+		const double angle = random_angle(rng_);
+
+		game->AddBullet(x, y, std::cos(angle) * bullet_speed, std::sin(angle) * bullet_speed);
+	}
+
+	tick_start_ = SDL_GetPerformanceCounter();
+}
+
+void ScenarioDriver::AfterTick(const Game& game)
+{
+	tick_ms_.push_back(static_cast<float>(static_cast<double>(SDL_GetPerformanceCounter() - tick_start_) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency())));
+	peak_asteroids_ = std::max(peak_asteroids_, game.Asteroids().size());
+	peak_bullets_ = std::max(peak_bullets_, game.Bullets().size());
+}
+
+void ScenarioDriver::RecordFrame(double frame_ms)
+{
+	frame_ms_.push_back(static_cast<float>(frame_ms));
+}
+
+void ScenarioDriver::Report() const
+{
+	printf("Scenario %s: %zu ticks, peak %zu asteroids and %zu bullets\n", scenario_.name.c_str(), tick_ms_.size(), peak_asteroids_, peak_bullets_);
+	printf("  tick   mean %7.3f ms  p50 %7.3f ms  p99 %7.3f ms  max %7.3f ms\n", Mean(tick_ms_), Percentile(tick_ms_, 50.0), Percentile(tick_ms_, 99.0), Percentile(tick_ms_, 100.0));
+
+	if (!frame_ms_.empty())
+	{
+		const double mean = Mean(frame_ms_);
+		printf("  frame  mean %7.3f ms  p50 %7.3f ms  p99 %7.3f ms  max %7.3f ms  (%.1f fps)\n", mean, Percentile(frame_ms_, 50.0), Percentile(frame_ms_, 99.0), Percentile(frame_ms_, 100.0), mean > 0.0 ? 1000.0 / mean : 0.0);
+	}
+}
@@ -0,0 +1,84 @@
+#include "Snapshot.hpp"
+#include "LinePolygon.hpp"
+#include "Player.hpp"
+#include "Bullet.hpp"
+
+#include <algorithm>
+
+namespace snapshot
+{
+	void Store(const LinePolygon& polygon, PolygonState* state)
+	{
+		const std::vector<SDL_FPoint>& geometry = polygon.Geometry();
+		const std::size_t count = std::min(geometry.size(), max_polygon_points);
+
+		state->center = polygon.center_;
+		state->acceleration = polygon.acceleration_vector_;
+		state->velocity = polygon.velocity_vector_;
+		std::copy(geometry.begin(), geometry.begin() + count, state->points);
+		std::fill(state->points + count, state->points + max_polygon_points, SDL_FPoint{ 0.0f, 0.0f });
+		state->furthest_distance_squared = polygon.furthest_distance_squared_;
+		state->angle = polygon.angle_;
+		state->mesh_id = polygon.mesh_id_;
+		state->point_count = static_cast<std::uint8_t>(count);
+		state->removed = polygon.removed_;
+	}
+
+	bool Load(const PolygonState& state, LinePolygon* polygon)
+	{
+		if (state.point_count > max_polygon_points)
+		{
+			return false;
+		}
+
+		polygon->center_ = state.center;
+		polygon->acceleration_vector_ = state.acceleration;
+		polygon->velocity_vector_ = state.velocity;
+		polygon->SetGeometry(state.points, state.point_count);
+		polygon->furthest_distance_squared_ = state.furthest_distance_squared;
+		polygon->angle_ = state.angle;
+		polygon->mesh_id_ = state.mesh_id;
+		polygon->removed_ = state.removed != 0;
+
+		return true;
+	}
+
+	void Store(const Player& player, PlayerState* state)
+	{
+		Store(player, &state->polygon);
+		state->direction = player.direction_vector_;
+		state->spawn_offset = player.spawn_offset_;
+		state->rotating_degrees = player.rotating_degrees_;
+		state->lives = player.lives_;
+		state->moving = player.moving_;
+		state->buttons = player.buttons_;
+	}
+
+	bool Load(const PlayerState& state, Player* player)
+	{
+		player->direction_vector_ = state.direction;
+		player->spawn_offset_ = state.spawn_offset;
+		player->rotating_degrees_ = state.rotating_degrees;
+		player->lives_ = state.lives;
+		player->moving_ = state.moving != 0;
+		player->buttons_ = state.buttons;
+
+		return Load(state.polygon, player);
+	}
+
+	void Store(const Bullet& bullet, BulletState* state)
+	{
+		state->geometry = bullet.geometry_;
+		state->velocity = bullet.velocity_vector_;
+		state->lifetime = bullet.lifetime_;
+		state->removed = bullet.removed_;
+	}
+
+	void Load(const BulletState& state, Bullet* bullet)
+	{
+		bullet->geometry_ = state.geometry;
+		bullet->velocity_vector_ = state.velocity;
+		bullet->lifetime_ = state.lifetime;
+		bullet->removed_ = state.removed != 0;
+	}
+} // namespace snapshot
@@ -0,0 +1,429 @@
+#include "Soak.hpp"
+#include "Game.hpp"
+#include "AllocationCounter.hpp"
+
+#include <SDL2/SDL.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	// Log-linear buckets over nanoseconds, 32 per power of two, so percentiles stay within about 3% however long the run.
+	class LatencyHistogram
+	{
+	private:
+		static constexpr int sub_buckets = 32;
+		static constexpr int sub_bucket_bits = 5;
+
+		std::array<std::uint64_t, 60 * sub_buckets> counts_;
+		std::uint64_t total_;
+		std::uint64_t max_;
+
+		static int Index(std::uint64_t ns)
+		{
+			if (ns < sub_buckets)
+			{
+				return static_cast<int>(ns);
+			}
+
+			const int exponent = 63 - __builtin_clzll(ns);
+			const int mantissa = static_cast<int>((ns >> (exponent - sub_bucket_bits)) & (sub_buckets - 1));
+
+			return ((exponent - sub_bucket_bits + 1) * sub_buckets) + mantissa;
+		}
+
+		static std::uint64_t LowerBound(int index)
+		{
+			if (index < sub_buckets)
+			{
+				return static_cast<std::uint64_t>(index);
+			}
+
+			const int exponent = (index / sub_buckets) + sub_bucket_bits - 1;
+			const std::uint64_t mantissa = static_cast<std::uint64_t>(index % sub_buckets);
+
+			return (sub_buckets + mantissa) << (exponent - sub_bucket_bits);
+		}
+
+	public:
+		LatencyHistogram() : counts_(), total_(0), max_(0)
+		{
+		}
+
+		void Add(std::uint64_t ns)
+		{
+			++counts_[Index(ns)];
+			++total_;
+			max_ = std::max(max_, ns);
+		}
+
+		void Clear()
+		{
+			counts_.fill(0);
+			total_ = 0;
+			max_ = 0;
+		}
+
+		double PercentileUs(double percentile) const
+		{
+			const std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total_)));
+			std::uint64_t seen = 0;
+
+			for (std::size_t i = 0; i < counts_.size(); ++i)
+			{
+				seen += counts_[i];
+
+				if (seen >= rank && counts_[i] != 0)
+				{
+					return static_cast<double>(LowerBound(static_cast<int>(i))) / 1000.0;
+				}
+			}
+
+			return MaxUs();
+		}
+
+		double MaxUs() const
+		{
+			return static_cast<double>(max_) / 1000.0;
+		}
+	};
+
+	struct MemorySample
+	{
+		double rss_mb;
+		double peak_rss_mb;
+		double heap_in_use_mb;
+		double heap_mapped_mb;
+	};
+
+	// Mapped minus in use is what fragmentation keeps from the system.
+	void SampleHeap(MemorySample* sample)
+	{
+		constexpr double mb = 1024.0 * 1024.0;
+		const struct mallinfo2 heap = mallinfo2();
+		sample->heap_in_use_mb = static_cast<double>(heap.uordblks + heap.hblkhd) / mb;
+		sample->heap_mapped_mb = static_cast<double>(heap.arena + heap.hblkhd) / mb;
+	}
+
+	MemorySample SampleMemory()
+	{
+		constexpr double mb = 1024.0 * 1024.0;
+		MemorySample sample = {};
+
+		if (std::FILE* statm = std::fopen("/proc/self/statm", "r"))
+		{
+			long pages = 0;
+			long resident = 0;
+
+			if (std::fscanf(statm, "%ld %ld", &pages, &resident) == 2)
+			{
+				sample.rss_mb = static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / mb;
+			}
+
+			std::fclose(statm);
+		}
+
+		if (std::FILE* status = std::fopen("/proc/self/status", "r"))
+		{
+			char line[256];
+
+			while (std::fgets(line, sizeof(line), status) != nullptr)
+			{
+				long kilobytes = 0;
+
+				if (std::sscanf(line, "VmHWM: %ld kB", &kilobytes) == 1)
+				{
+					sample.peak_rss_mb = static_cast<double>(kilobytes) / 1024.0;
+					break;
+				}
+			}
+
+			std::fclose(status);
+		}
+
+		SampleHeap(&sample);
+
+		return sample;
+	}
+
+	// Turns toward the nearest asteroid, taps the trigger while roughly aimed at it and closes in when it is far away.
+	std::uint8_t Autopilot(const Game& game, std::uint64_t tick)
+	{
+		const Player& player = game.GetPlayer();
+		double target_dx = 0.0;
+		double target_dy = 0.0;
+		double nearest = std::numeric_limits<double>::max();
+
+		for (const std::unique_ptr<Asteroid>& asteroid : game.Asteroids())
+		{
+			if (asteroid->removed_)
+			{
+				continue;
+			}
+
+			double dx = asteroid->center_.x - player.center_.x;
+			double dy = asteroid->center_.y - player.center_.y;
+
+			dx -= game.world_width_ * std::round(dx / game.world_width_);
+			dy -= game.world_height_ * std::round(dy / game.world_height_);
+
+			const double distance_squared = (dx * dx) + (dy * dy);
+
+			if (distance_squared < nearest)
+			{
+				nearest = distance_squared;
+				target_dx = dx;
+				target_dy = dy;
+			}
+		}
+
+		if (nearest == std::numeric_limits<double>::max())
+		{
+			return 0;
+		}
+
+		const SDL_FPoint& direction = player.direction_vector_;
+		const double lengths = std::sqrt((direction.x * direction.x) + (direction.y * direction.y)) * std::sqrt(nearest);
+		const double cross = (direction.x * target_dy) - (direction.y * target_dx);
+		const double dot = (direction.x * target_dx) + (direction.y * target_dy);
+
+		std::uint8_t buttons = 0;
+
+		if (dot < lengths * 0.97)
+		{
+			buttons |= cross > 0.0 ? input::RIGHT : input::LEFT;
+		}
+
+		// A shot is fired on the press, so the trigger has to be released in between.
+		if (dot > lengths * 0.9 && tick % 2 == 0)
+		{
+			buttons |= input::FIRE;
+		}
+
+		if (dot > lengths * 0.9 && nearest > 350.0 * 350.0)
+		{
+			buttons |= input::THRUST;
+		}
+
+		return buttons;
+	}
+
+	struct Metric
+	{
+		const char* name;
+		double value;
+		// Added to the tolerance so metrics near zero do not flag on noise.
+		double slack;
+	};
+
+	bool SaveBaseline(const char* path, const std::vector<Metric>& metrics)
+	{
+		std::FILE* file = std::fopen(path, "w");
+
+		if (file == nullptr)
+		{
+			printf("Unable to write soak baseline %s\n", path);
+			return false;
+		}
+
+		for (const Metric& metric : metrics)
+		{
+			std::fprintf(file, "%s %.4f\n", metric.name, metric.value);
+		}
+
+		std::fclose(file);
+		printf("Soak baseline written to %s\n", path);
+
+		return true;
+	}
+
+	// Returns the number of regressions, or -1 when the baseline cannot be read.
+	int CompareBaseline(const char* path, const std::vector<Metric>& metrics)
+	{
+		std::FILE* file = std::fopen(path, "r");
+
+		if (file == nullptr)
+		{
+			printf("Unable to read soak baseline %s\n", path);
+			return -1;
+		}
+
+		int regressions = 0;
+		char name[64];
+		double baseline = 0.0;
+
+		printf("Against baseline %s (tolerance %.0f%%):\n", path, soak::tolerance * 100.0);
+
+		while (std::fscanf(file, "%63s %lf", name, &baseline) == 2)
+		{
+			for (const Metric& metric : metrics)
+			{
+				if (std::strcmp(metric.name, name) != 0)
+				{
+					continue;
+				}
+
+				const bool regressed = metric.value > (baseline * (1.0 + soak::tolerance)) + metric.slack;
+				regressions += regressed ? 1 : 0;
+
+				printf("  %-24s %12.3f  baseline %12.3f  %s\n", metric.name, metric.value, baseline, regressed ? "REGRESSION" : "ok");
+			}
+		}
+
+		std::fclose(file);
+
+		return regressions;
+	}
+} // namespace
+
+namespace soak
+{
+	int Run(const Options& options)
+	{
+		std::unique_ptr<Game> game = std::make_unique<Game>();
+		game->ApplyOptions(options);
+		game->headless_ = true;
+		game->Seed(options.seed.value_or(1));
+
+		const std::uint64_t total_ticks = static_cast<std::uint64_t>(options.soak_hours * 3600.0 * game->tick_rate_);
+		const std::uint64_t interval_ticks = static_cast<std::uint64_t>(interval_minutes * 60.0 * game->tick_rate_);
+		const std::uint64_t heap_sample_ticks = static_cast<std::uint64_t>(std::max(game->tick_rate_, 1));
+		const double counter_ns = 1e9 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+		LatencyHistogram run_ticks;
+		LatencyHistogram interval_ticks_histogram;
+
+		// Heap in use after each interval, against simulated hours, for the growth trend. The high-water marks are
+		// sampled once a simulated second, between timed ticks.
+		std::vector<std::pair<double, double>> heap_trend;
+		double heap_peak_mb = 0.0;
+		double heap_mapped_peak_mb = 0.0;
+		int games = 1;
+
+		printf("Soak: %.2f simulated hours (%llu ticks), reporting every %.0f simulated minutes\n", options.soak_hours, static_cast<unsigned long long>(total_ticks), interval_minutes);
+		printf("  %8s %9s %9s %9s %9s %9s %9s %9s %10s %11s %9s %6s\n", "sim", "wall s", "p50 us", "p99 us", "p99.9 us", "max us", "rss MB", "heap MB", "mapped MB", "allocs/tick", "asteroids", "games");
+
+		const std::uint64_t run_start = SDL_GetPerformanceCounter();
+		std::uint64_t interval_allocations = memory::ThreadAllocations();
+		std::uint64_t interval_start_tick = 0;
+
+		for (std::uint64_t tick = 0; tick < total_ticks; ++tick)
+		{
+			if (game->game_over_ && !game->reset_game_)
+			{
+				game->reset_game_ = true;
+				++games;
+			}
+
+			game->ApplyInput(Autopilot(*game, tick));
+
+			const std::uint64_t start = SDL_GetPerformanceCounter();
+			game->Tick();
+			const std::uint64_t ns = static_cast<std::uint64_t>(static_cast<double>(SDL_GetPerformanceCounter() - start) * counter_ns);
+
+			run_ticks.Add(ns);
+			interval_ticks_histogram.Add(ns);
+
+			if ((tick + 1) % heap_sample_ticks == 0)
+			{
+				MemorySample heap_sample = {};
+				SampleHeap(&heap_sample);
+				heap_peak_mb = std::max(heap_peak_mb, heap_sample.heap_in_use_mb);
+				heap_mapped_peak_mb = std::max(heap_mapped_peak_mb, heap_sample.heap_mapped_mb);
+			}
+
+			if ((tick + 1) % interval_ticks != 0 && tick + 1 != total_ticks)
+			{
+				continue;
+			}
+
+			const MemorySample memory_sample = SampleMemory();
+			const std::uint64_t allocations = memory::ThreadAllocations();
+			const double simulated_hours = static_cast<double>(tick + 1) / (3600.0 * game->tick_rate_);
+			const int simulated_minutes = static_cast<int>(simulated_hours * 60.0 + 0.5);
+
+			heap_peak_mb = std::max(heap_peak_mb, memory_sample.heap_in_use_mb);
+			heap_mapped_peak_mb = std::max(heap_mapped_peak_mb, memory_sample.heap_mapped_mb);
+			heap_trend.emplace_back(simulated_hours, memory_sample.heap_in_use_mb);
+
+			printf("  %5d:%02d %9.1f %9.2f %9.2f %9.2f %9.1f %9.1f %9.2f %10.2f %11.2f %9zu %6d\n", simulated_minutes / 60, simulated_minutes % 60, static_cast<double>(SDL_GetPerformanceCounter() - run_start) * counter_ns / 1e9, interval_ticks_histogram.PercentileUs(50.0), interval_ticks_histogram.PercentileUs(99.0), interval_ticks_histogram.PercentileUs(99.9), interval_ticks_histogram.MaxUs(), memory_sample.rss_mb, memory_sample.heap_in_use_mb, memory_sample.heap_mapped_mb, static_cast<double>(allocations - interval_allocations) / static_cast<double>(tick + 1 - interval_start_tick), game->Asteroids().size(), games);
+
+			interval_ticks_histogram.Clear();
+			interval_allocations = allocations;
+			interval_start_tick = tick + 1;
+		}
+
+		// Least-squares slope of heap in use, skipping the first interval while caches and pools warm up.
+		double heap_growth_mb_per_hour = 0.0;
+		const std::size_t first = heap_trend.size() > 2 ? 1 : 0;
+		const double samples = static_cast<double>(heap_trend.size() - first);
+
+		if (samples >= 2.0)
+		{
+			double sum_x = 0.0;
+			double sum_y = 0.0;
+			double sum_xx = 0.0;
+			double sum_xy = 0.0;
+
+			for (std::size_t i = first; i < heap_trend.size(); ++i)
+			{
+				sum_x += heap_trend[i].first;
+				sum_y += heap_trend[i].second;
+				sum_xx += heap_trend[i].first * heap_trend[i].first;
+				sum_xy += heap_trend[i].first * heap_trend[i].second;
+			}
+
+			const double denominator = (samples * sum_xx) - (sum_x * sum_x);
+			heap_growth_mb_per_hour = denominator > 0.0 ? ((samples * sum_xy) - (sum_x * sum_y)) / denominator : 0.0;
+		}
+
+		const MemorySample final_memory = SampleMemory();
+		const double wall_seconds = static_cast<double>(SDL_GetPerformanceCounter() - run_start) * counter_ns / 1e9;
+
+		printf("Soak summary: %llu ticks in %.1f s wall, %d games\n", static_cast<unsigned long long>(total_ticks), wall_seconds, games);
+		printf("  tick p50 %.2f us, p99 %.2f us, p99.9 %.2f us, max %.2f us\n", run_ticks.PercentileUs(50.0), run_ticks.PercentileUs(99.0), run_ticks.PercentileUs(99.9), run_ticks.MaxUs());
+		printf("  peak RSS %.1f MB, heap high-water %.2f MB in use / %.2f MB mapped, heap growth %.3f MB per simulated hour\n", final_memory.peak_rss_mb, heap_peak_mb, heap_mapped_peak_mb, heap_growth_mb_per_hour);
+
+		const std::vector<Metric> metrics =
+		{
+			{ "tick_p50_us", run_ticks.PercentileUs(50.0), 0.5 },
+			{ "tick_p99_us", run_ticks.PercentileUs(99.0), 1.0 },
+			{ "tick_p999_us", run_ticks.PercentileUs(99.9), 2.0 },
+			{ "peak_rss_mb", final_memory.peak_rss_mb, 1.0 },
+			{ "heap_peak_mb", heap_peak_mb, 0.5 },
+			{ "heap_mapped_peak_mb", heap_mapped_peak_mb, 0.5 },
+			{ "heap_growth_mb_per_hour", heap_growth_mb_per_hour, 0.1 },
+		};
+
+		if (!options.soak_save_path.empty() && !SaveBaseline(options.soak_save_path.c_str(), metrics))
+		{
+			return 1;
+		}
+
+		if (!options.soak_baseline_path.empty())
+		{
+			const int regressions = CompareBaseline(options.soak_baseline_path.c_str(), metrics);
+
+			if (regressions > 0)
+			{
+				printf("Soak: %d regression(s) against the baseline\n", regressions);
+			}
+
+			if (regressions != 0)
+			{
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+} // namespace soak
@@ -0,0 +1,141 @@
+#include "SoftwareRenderer.hpp"
+#include "Game.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <string>
+
+namespace
+{
+	constexpr std::uint32_t background_color = 0xFF000000;
+	constexpr std::uint32_t foreground_color = 0xFFFFFFFF;
+
+	int SurfaceWidth(const SDL_Surface* surface)
+	{
+		return surface == nullptr ? 0 : surface->w;
+	}
+
+	int SurfaceHeight(const SDL_Surface* surface)
+	{
+		return surface == nullptr ? 0 : surface->h;
+	}
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, TTF_Font* font) : framebuffer_(width, height), font_(font)
+{
+	for (TextSurface& text_surface : text_surfaces_)
+	{
+		text_surface.surface = nullptr;
+	}
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	for (TextSurface& text_surface : text_surfaces_)
+	{
+		SDL_FreeSurface(text_surface.surface);
+		text_surface.surface = nullptr;
+	}
+}
+
+const SDL_Surface* SoftwareRenderer::Text(HudSlot slot, const char* text, int wrap_length)
+{
+	TextSurface& text_surface = text_surfaces_[slot];
+
+	if (font_ == nullptr || (text_surface.surface != nullptr && text_surface.text == text))
+	{
+		return text_surface.surface;
+	}
+
+	SDL_FreeSurface(text_surface.surface);
+	text_surface.surface = nullptr;
+	text_surface.text = text;
+
+	const SDL_Color text_color = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Surface* rendered = wrap_length == -1 ? TTF_RenderText_Blended(font_, text, text_color) : TTF_RenderText_Blended_Wrapped(font_, text, text_color, wrap_length);
+
+	if (rendered == nullptr)
+	{
+		printf("Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError());
+		return nullptr;
+	}
+
+	text_surface.surface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(rendered);
+
+	return text_surface.surface;
+}
+
+void SoftwareRenderer::DrawPolygon(const LinePolygon& polygon, float offset_x, float offset_y)
+{
+	const std::vector<SDL_FPoint>& geometry = polygon.Geometry();
+
+	for (std::size_t i = 0; i < geometry.size(); ++i)
+	{
+		const SDL_FPoint& current = geometry[i];
+		const SDL_FPoint& next = geometry[(i + 1) % geometry.size()];
+
+		framebuffer_.DrawLine(current.x + offset_x, current.y + offset_y, next.x + offset_x, next.y + offset_y, foreground_color);
+	}
+}
+
+void SoftwareRenderer::Render(const Game& game)
+{
+	const int width = framebuffer_.Width();
+	const int height = framebuffer_.Height();
+
+	framebuffer_.Clear(background_color);
+
+	const std::string score_text = "Score: " + std::to_string(game.score_);
+	const std::string lives_text = "Lives: " + std::to_string(game.GetPlayer().lives_);
+
+	const SDL_Surface* score = Text(SCORE, score_text.c_str());
+	const SDL_Surface* lives = Text(LIVES, lives_text.c_str());
+	const SDL_Surface* toggle_info = Text(TOGGLE_INFO, constants::toggle_info_text);
+
+	framebuffer_.BlendSurface(score, (width / 4) - (SurfaceWidth(score) / 2), 0);
+	framebuffer_.BlendSurface(lives, static_cast<int>(width * (3.0 / 4.0)) - (SurfaceWidth(lives) / 2), 0);
+	framebuffer_.BlendSurface(toggle_info, (width / 2) - (SurfaceWidth(toggle_info) / 2), height - SurfaceHeight(toggle_info));
+
+	if (game.info_toggled_)
+	{
+		const SDL_Surface* info = Text(INFO, constants::info_text, constants::info_wrap_length);
+		framebuffer_.BlendSurface(info, 10, height - SurfaceHeight(info));
+	}
+
+	game.ForEachVisibleAsteroid([this](const Asteroid& asteroid, float offset_x, float offset_y)
+	{
+		DrawPolygon(asteroid, offset_x, offset_y);
+	});
+
+	game.ForEachVisibleBullet([this](const Bullet& bullet, float offset_x, float offset_y)
+	{
+		const SDL_FRect rect = { bullet.geometry_.x + offset_x, bullet.geometry_.y + offset_y, bullet.geometry_.w, bullet.geometry_.h };
+		framebuffer_.FillRect(rect, foreground_color);
+	});
+
+	game.Particles()->Render(&framebuffer_, game.Camera().x, game.Camera().y);
+
+	for (const std::unique_ptr<Player>& remote_player : game.RemotePlayers())
+	{
+		DrawPolygon(*remote_player, -game.Camera().x, -game.Camera().y);
+	}
+
+	if (!game.game_over_ && game.local_player_)
+	{
+		DrawPolygon(game.GetPlayer(), -game.Camera().x, -game.Camera().y);
+	}
+
+	if (game.game_over_)
+	{
+		const SDL_Surface* game_over = Text(GAME_OVER, constants::game_over_text, constants::game_over_wrap_length);
+		framebuffer_.BlendSurface(game_over, (width / 2) - (SurfaceWidth(game_over) / 2), (height / 2) - (SurfaceHeight(game_over) / 2));
+	}
+}
+
+const Framebuffer& SoftwareRenderer::Frame() const
+{
+	return framebuffer_;
+}
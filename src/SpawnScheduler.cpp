@@ -0,0 +1,149 @@
+#include "SpawnScheduler.hpp"
+#include "Game.hpp"
+#include "Trace.hpp"
+#include "Utils/Constants.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+	constexpr std::uint64_t no_tick = std::numeric_limits<std::uint64_t>::max();
+} // namespace
+
+SpawnScheduler::SpawnScheduler() :
+	head_(0),
+	per_tick_(0),
+	budget_ms_(0.0),
+	last_run_tick_(no_tick),
+	built_(0),
+	deferred_(0),
+	max_pending_(0),
+	worst_tick_ms_(0.0),
+	worst_tick_count_(0)
+{
+}
+
+void SpawnScheduler::Configure(std::size_t per_tick, double budget_us)
+{
+	per_tick_ = per_tick;
+	budget_ms_ = budget_us / 1000.0;
+}
+
+void SpawnScheduler::Push(AsteroidType type, double x, double y, double vx, double vy, std::uint64_t tick)
+{
+	// Queued after this tick's asteroid pass, it would have been moved first by the next one.
+	const std::uint64_t due = last_run_tick_ == tick ? tick + 1 : tick;
+
+	queue_.push_back({ type, x, y, vx, vy, due });
+	max_pending_ = std::max(max_pending_, Pending());
+}
+
+std::size_t SpawnScheduler::Build(Game* game, std::uint64_t tick, std::size_t per_tick, double budget_ms)
+{
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+	const double counter_ms = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+	std::size_t built = 0;
+
+	while (head_ < queue_.size())
+	{
+		if (per_tick != 0 && built >= per_tick)
+		{
+			break;
+		}
+
+		// At least one spawn is built every tick, so the queue drains however small the time budget.
+		if (budget_ms > 0.0 && built != 0 && static_cast<double>(SDL_GetPerformanceCounter() - start) * counter_ms >= budget_ms)
+		{
+			break;
+		}
+
+		const Spawn& spawn = queue_[head_++];
+		std::unique_ptr<Asteroid> asteroid = std::make_unique<Asteroid>(game, spawn.type, spawn.x, spawn.y, spawn.vx, spawn.vy);
+
+		if (tick > spawn.due)
+		{
+			const double missed_seconds = static_cast<double>(tick - spawn.due) * game->tick_seconds_;
+
+			asteroid->MoveGeometry(spawn.vx * missed_seconds, spawn.vy * missed_seconds);
+			asteroid->RotateGeometry(constants::asteroid_spin * missed_seconds);
+		}
+
+		game->AddAsteroid(std::move(asteroid));
+		++built;
+	}
+
+	if (head_ == queue_.size())
+	{
+		queue_.clear();
+		head_ = 0;
+	}
+
+	built_ += built;
+
+	return built;
+}
+
+void SpawnScheduler::Run(Game* game, std::uint64_t tick)
+{
+	last_run_tick_ = tick;
+
+	if (Idle())
+	{
+		return;
+	}
+
+	trace::Zone zone("SpawnScheduler::Run");
+
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+	const std::size_t built = Build(game, tick, per_tick_, budget_ms_);
+	const double elapsed_ms = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	deferred_ += Pending();
+
+	if (elapsed_ms > worst_tick_ms_)
+	{
+		worst_tick_ms_ = elapsed_ms;
+		worst_tick_count_ = built;
+	}
+}
+
+void SpawnScheduler::Flush(Game* game, std::uint64_t tick)
+{
+	Build(game, tick, 0, 0.0);
+}
+
+void SpawnScheduler::Clear()
+{
+	queue_.clear();
+	head_ = 0;
+	last_run_tick_ = no_tick;
+}
+
+bool SpawnScheduler::Idle() const
+{
+	return head_ == queue_.size();
+}
+
+std::size_t SpawnScheduler::Pending() const
+{
+	return queue_.size() - head_;
+}
+
+const SpawnScheduler::Spawn& SpawnScheduler::PendingAt(std::size_t index) const
+{
+	return queue_[head_ + index];
+}
+
+void SpawnScheduler::Restore(const Spawn& spawn)
+{
+	queue_.push_back(spawn);
+}
+
+void SpawnScheduler::PrintStats() const
+{
+	printf("Spawns: %zu built, %zu spawn-ticks deferred, at most %zu queued, worst tick %.3f ms for %zu asteroids\n", built_, deferred_, max_pending_, worst_tick_ms_, worst_tick_count_);
+}
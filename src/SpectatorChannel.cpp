@@ -0,0 +1,402 @@
+#include "SpectatorChannel.hpp"
+#include "Game.hpp"
+#include "Trace.hpp"
+#include "Utils/Constants.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace spectator
+{
+	namespace
+	{
+		constexpr std::size_t MappingSize()
+		{
+			return sizeof(Header) + slot_count * sizeof(Frame);
+		}
+	} // namespace
+
+	Publisher::Publisher() : descriptor_(-1), mapping_(nullptr), size_(0), header_(nullptr), frames_(nullptr), published_(0), ticks_published_(0), publish_ns_total_(0.0), publish_ns_max_(0.0)
+	{
+	}
+
+	Publisher::~Publisher()
+	{
+		Close();
+	}
+
+	bool Publisher::Create(const char* name)
+	{
+		Close();
+
+		descriptor_ = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+
+		if (descriptor_ < 0)
+		{
+			printf("Unable to create spectator channel %s: %s\n", name, std::strerror(errno));
+			return false;
+		}
+
+		size_ = MappingSize();
+
+		if (ftruncate(descriptor_, static_cast<off_t>(size_)) != 0 || (mapping_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0)) == MAP_FAILED)
+		{
+			printf("Unable to map spectator channel %s: %s\n", name, std::strerror(errno));
+			mapping_ = nullptr;
+			close(descriptor_);
+			descriptor_ = -1;
+			shm_unlink(name);
+			return false;
+		}
+
+		name_ = name;
+
+		// Touch every page now so the first ticks do not pay for the page faults; zero is every frame's initial state.
+		std::memset(mapping_, 0, size_);
+
+		header_ = static_cast<Header*>(mapping_);
+		frames_ = reinterpret_cast<Frame*>(static_cast<std::uint8_t*>(mapping_) + sizeof(Header));
+
+		std::memcpy(header_->magic, magic, sizeof(magic));
+		header_->slot_count = slot_count;
+		header_->frame_size = sizeof(Frame);
+		header_->screen_width = constants::screen_width;
+		header_->screen_height = constants::screen_height;
+		header_->closed.store(0, std::memory_order_relaxed);
+		header_->latest.store(0, std::memory_order_release);
+
+		published_ = 0;
+
+		return true;
+	}
+
+	void Publisher::Close()
+	{
+		if (mapping_ == nullptr)
+		{
+			return;
+		}
+
+		header_->closed.store(1, std::memory_order_release);
+
+		if (ticks_published_ > 0)
+		{
+			printf("Spectator channel %s: %zu ticks published, %.0f ns per tick, %.0f ns max\n", name_.c_str(), ticks_published_, publish_ns_total_ / ticks_published_, publish_ns_max_);
+		}
+
+		munmap(mapping_, size_);
+		close(descriptor_);
+		shm_unlink(name_.c_str());
+
+		mapping_ = nullptr;
+		header_ = nullptr;
+		frames_ = nullptr;
+		descriptor_ = -1;
+	}
+
+	void Publisher::Publish(const Game& game)
+	{
+		if (header_ == nullptr)
+		{
+			return;
+		}
+
+		trace::Zone zone("spectator::Publish");
+
+		const std::uint64_t start = SDL_GetPerformanceCounter();
+		Frame& frame = frames_[published_ % slot_count];
+		const std::uint64_t sequence = frame.sequence.load(std::memory_order_relaxed);
+
+		frame.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		std::uint32_t polygon_count = 0;
+		std::uint32_t point_count = 0;
+		std::uint32_t bullet_count = 0;
+		bool truncated = false;
+
+		auto add_polygon = [&](const LinePolygon& polygon, float offset_x, float offset_y)
+		{
+			const std::vector<SDL_FPoint>& geometry = polygon.Geometry();
+
+			if (geometry.empty() || polygon_count == max_polygons || point_count + geometry.size() + 1 > max_points)
+			{
+				truncated = truncated || !geometry.empty();
+				return;
+			}
+
+			for (const SDL_FPoint& point : geometry)
+			{
+				frame.points[point_count++] = { point.x + offset_x, point.y + offset_y };
+			}
+
+			frame.points[point_count++] = { geometry[0].x + offset_x, geometry[0].y + offset_y };
+			frame.polygon_sizes[polygon_count++] = static_cast<std::uint16_t>(geometry.size() + 1);
+		};
+
+		game.ForEachVisibleAsteroid(add_polygon);
+
+		const SDL_FPoint& camera = game.Camera();
+
+		for (const std::unique_ptr<Player>& remote_player : game.RemotePlayers())
+		{
+			add_polygon(*remote_player, -camera.x, -camera.y);
+		}
+
+		if (game.local_player_ && !game.game_over_)
+		{
+			add_polygon(game.GetPlayer(), -camera.x, -camera.y);
+		}
+
+		game.ForEachVisibleBullet([&](const Bullet& bullet, float offset_x, float offset_y)
+		{
+			if (bullet_count == max_bullets)
+			{
+				truncated = true;
+				return;
+			}
+
+			frame.bullets[bullet_count++] = { bullet.geometry_.x + offset_x, bullet.geometry_.y + offset_y };
+		});
+
+		frame.tick = game.ticks_;
+		frame.score = game.score_;
+		frame.lives = game.GetPlayer().lives_;
+		frame.game_over = game.game_over_ ? 1 : 0;
+		frame.truncated = truncated ? 1 : 0;
+		frame.polygon_count = polygon_count;
+		frame.point_count = point_count;
+		frame.bullet_count = bullet_count;
+
+		frame.sequence.store(sequence + 2, std::memory_order_release);
+		header_->latest.store(++published_, std::memory_order_release);
+
+		const double elapsed_ns = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1e9 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+		++ticks_published_;
+		publish_ns_total_ += elapsed_ns;
+		publish_ns_max_ = std::max(publish_ns_max_, elapsed_ns);
+	}
+
+	Reader::Reader() : descriptor_(-1), mapping_(nullptr), size_(0), header_(nullptr), frames_(nullptr)
+	{
+	}
+
+	Reader::~Reader()
+	{
+		Close();
+	}
+
+	bool Reader::Open(const char* name)
+	{
+		Close();
+
+		descriptor_ = shm_open(name, O_RDONLY, 0);
+
+		if (descriptor_ < 0)
+		{
+			printf("Unable to open spectator channel %s: %s\n", name, std::strerror(errno));
+			return false;
+		}
+
+		struct stat status;
+
+		if (fstat(descriptor_, &status) != 0 || static_cast<std::size_t>(status.st_size) != MappingSize())
+		{
+			printf("Spectator channel %s has an unexpected size; is it from another version of the game?\n", name);
+			Close();
+			return false;
+		}
+
+		size_ = MappingSize();
+		void* mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, descriptor_, 0);
+
+		if (mapping == MAP_FAILED)
+		{
+			printf("Unable to map spectator channel %s: %s\n", name, std::strerror(errno));
+			Close();
+			return false;
+		}
+
+		mapping_ = mapping;
+		header_ = static_cast<const Header*>(mapping_);
+		frames_ = reinterpret_cast<const Frame*>(static_cast<const std::uint8_t*>(mapping_) + sizeof(Header));
+
+		if (std::memcmp(header_->magic, magic, sizeof(magic)) != 0 || header_->slot_count != slot_count || header_->frame_size != sizeof(Frame))
+		{
+			printf("Spectator channel %s has an unknown format\n", name);
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void Reader::Close()
+	{
+		if (mapping_ != nullptr)
+		{
+			munmap(const_cast<void*>(mapping_), size_);
+		}
+
+		if (descriptor_ >= 0)
+		{
+			close(descriptor_);
+		}
+
+		mapping_ = nullptr;
+		header_ = nullptr;
+		frames_ = nullptr;
+		descriptor_ = -1;
+	}
+
+	const Header& Reader::GetHeader() const
+	{
+		return *header_;
+	}
+
+	const Frame& Reader::Latest() const
+	{
+		const std::uint64_t latest = header_->latest.load(std::memory_order_acquire);
+
+		return frames_[(latest == 0 ? 0 : latest - 1) % slot_count];
+	}
+
+	bool Reader::Begin(const Frame& frame, std::uint64_t* sequence)
+	{
+		*sequence = frame.sequence.load(std::memory_order_acquire);
+
+		return (*sequence & 1) == 0;
+	}
+
+	bool Reader::Validate(const Frame& frame, std::uint64_t sequence)
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		return frame.sequence.load(std::memory_order_relaxed) == sequence;
+	}
+
+	int RunViewer(const Options& options)
+	{
+		Reader reader;
+
+		if (!reader.Open(options.spectator_channel.c_str()))
+		{
+			printf("Start the game with --broadcast first\n");
+			return 1;
+		}
+
+		if (SDL_Init(SDL_INIT_VIDEO) < 0)
+		{
+			printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+			return 1;
+		}
+
+		const Header& header = reader.GetHeader();
+		SDL_Window* window = SDL_CreateWindow("Asteroids - spectator", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, static_cast<int>(header.screen_width), static_cast<int>(header.screen_height), SDL_WINDOW_SHOWN);
+		SDL_Renderer* renderer = window == nullptr ? nullptr : SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+		if (renderer == nullptr)
+		{
+			printf("Window or renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+			SDL_DestroyWindow(window);
+			SDL_Quit();
+			return 1;
+		}
+
+		std::uint64_t last_tick = 0;
+		std::uint64_t last_title = 0;
+		std::size_t shown = 0;
+		std::size_t torn = 0;
+		std::size_t skipped = 0;
+		bool running = true;
+
+		while (running && header.closed.load(std::memory_order_acquire) == 0)
+		{
+			SDL_Event e;
+
+			while (SDL_PollEvent(&e) != 0)
+			{
+				running = running && e.type != SDL_QUIT && !(e.type == SDL_KEYUP && e.key.keysym.sym == SDLK_ESCAPE);
+			}
+
+			const Frame& frame = reader.Latest();
+			std::uint64_t sequence;
+
+			if (!Reader::Begin(frame, &sequence) || frame.tick == last_tick)
+			{
+				SDL_Delay(1);
+				continue;
+			}
+
+			const std::uint64_t tick = frame.tick;
+
+			SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+			SDL_RenderClear(renderer);
+			SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+
+			// Drawn straight from the mapping. Counts from a torn read are bounded here and the frame is discarded below.
+			const std::uint32_t polygon_count = std::min<std::uint32_t>(frame.polygon_count, max_polygons);
+			std::size_t offset = 0;
+
+			for (std::uint32_t i = 0; i < polygon_count; ++i)
+			{
+				const std::size_t size = frame.polygon_sizes[i];
+
+				if (offset + size > max_points)
+				{
+					break;
+				}
+
+				SDL_RenderDrawLinesF(renderer, &frame.points[offset], static_cast<int>(size));
+				offset += size;
+			}
+
+			const std::uint32_t bullet_count = std::min<std::uint32_t>(frame.bullet_count, max_bullets);
+
+			for (std::uint32_t i = 0; i < bullet_count; ++i)
+			{
+				const SDL_FRect rect = { frame.bullets[i].x, frame.bullets[i].y, 4.0f, 4.0f };
+				SDL_RenderFillRectF(renderer, &rect);
+			}
+
+			const int score = frame.score;
+			const int lives = frame.lives;
+
+			if (!Reader::Validate(frame, sequence))
+			{
+				++torn;
+				continue;
+			}
+
+			if (tick / constants::ticks_per_second != last_title)
+			{
+				char title[96];
+				snprintf(title, sizeof(title), "Asteroids - spectator - score %d, lives %d", score, lives);
+				SDL_SetWindowTitle(window, title);
+				last_title = tick / constants::ticks_per_second;
+			}
+
+			SDL_RenderPresent(renderer);
+
+			skipped += last_tick != 0 && tick > last_tick + 1 ? tick - last_tick - 1 : 0;
+			last_tick = tick;
+			++shown;
+		}
+
+		printf("Spectator: %zu frames shown, %zu ticks skipped, %zu torn reads discarded\n", shown, skipped, torn);
+
+		SDL_DestroyRenderer(renderer);
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+
+		return 0;
+	}
+} // namespace spectator
@@ -0,0 +1,171 @@
+#include "SpriteCache.hpp"
+#include "LinePolygon.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+SpriteCache::SpriteCache(int angle_steps, std::size_t max_bytes) : angle_steps_(angle_steps), max_bytes_(max_bytes), bytes_(0), uses_(0), hits_(0), misses_(0), evictions_(0)
+{
+}
+
+SpriteCache::~SpriteCache()
+{
+	Clear();
+}
+
+void SpriteCache::Configure(int angle_steps, std::size_t max_bytes)
+{
+	Clear();
+	angle_steps_ = std::max(angle_steps, 1);
+	max_bytes_ = max_bytes;
+}
+
+void SpriteCache::Clear()
+{
+	for (const auto& [key, entry] : entries_)
+	{
+		SDL_DestroyTexture(entry.texture);
+	}
+
+	entries_.clear();
+	bytes_ = 0;
+}
+
+bool SpriteCache::Render(SDL_Renderer* renderer, const LinePolygon& polygon, float offset_x, float offset_y)
+{
+	if (polygon.mesh_id_ < 0)
+	{
+		return false;
+	}
+
+	const int bucket = static_cast<int>(std::lround(polygon.angle_ * angle_steps_ / 360.0)) % angle_steps_;
+	const std::uint32_t key = (static_cast<std::uint32_t>(polygon.mesh_id_) << 16) | static_cast<std::uint32_t>(bucket);
+
+	auto entry_it = entries_.find(key);
+
+	if (entry_it == entries_.end())
+	{
+		++misses_;
+
+		Entry entry;
+
+		if (!Rasterize(renderer, polygon, bucket * 360.0 / angle_steps_, &entry))
+		{
+			return false;
+		}
+
+		const std::size_t entry_bytes = static_cast<std::size_t>(entry.size) * static_cast<std::size_t>(entry.size) * 4;
+
+		while (!entries_.empty() && bytes_ + entry_bytes > max_bytes_)
+		{
+			EvictLeastRecentlyUsed();
+		}
+
+		bytes_ += entry_bytes;
+		entry_it = entries_.emplace(key, entry).first;
+	}
+	else
+	{
+		++hits_;
+	}
+
+	Entry& entry = entry_it->second;
+	entry.last_used = ++uses_;
+
+	const float half_size = entry.size / 2.0f;
+	const SDL_FRect render_rect = { polygon.center_.x + offset_x - half_size, polygon.center_.y + offset_y - half_size, static_cast<float>(entry.size), static_cast<float>(entry.size) };
+
+	return SDL_RenderCopyF(renderer, entry.texture, nullptr, &render_rect) == 0;
+}
+
+std::size_t SpriteCache::Bytes() const
+{
+	return bytes_;
+}
+
+bool SpriteCache::Rasterize(SDL_Renderer* renderer, const LinePolygon& polygon, double angle, Entry* entry)
+{
+	if (!SDL_RenderTargetSupported(renderer))
+	{
+		return false;
+	}
+
+	const std::vector<SDL_FPoint>& geometry = polygon.Geometry();
+
+	if (geometry.empty())
+	{
+		return false;
+	}
+
+	// Rotate the current outline onto the bucket angle, so every sprite in a bucket looks the same.
+	const double pi = std::acos(-1);
+	const double rotation = (angle - polygon.angle_) * pi / 180.0;
+	const double sin_rotation = std::sin(rotation);
+	const double cos_rotation = std::cos(rotation);
+
+	std::vector<SDL_FPoint> outline(geometry.size() + 1);
+	double radius = 0.0;
+
+	for (std::size_t i = 0; i < geometry.size(); ++i)
+	{
+		const double x = geometry[i].x - polygon.center_.x;
+		const double y = geometry[i].y - polygon.center_.y;
+
+		outline[i].x = x * cos_rotation - y * sin_rotation;
+		outline[i].y = x * sin_rotation + y * cos_rotation;
+		radius = std::max(radius, std::sqrt(x * x + y * y));
+	}
+
+	const int size = 2 * static_cast<int>(std::ceil(radius)) + 3;
+	const float half_size = size / 2.0f;
+
+	for (std::size_t i = 0; i < geometry.size(); ++i)
+	{
+		outline[i].x += half_size;
+		outline[i].y += half_size;
+	}
+
+	outline.back() = outline.front();
+
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
+
+	if (texture == nullptr)
+	{
+		printf("Unable to create sprite texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+	SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, texture);
+
+	SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0x00);
+	SDL_RenderClear(renderer);
+	SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+	SDL_RenderDrawLinesF(renderer, outline.data(), static_cast<int>(outline.size()));
+
+	SDL_SetRenderTarget(renderer, previous_target);
+
+	entry->texture = texture;
+	entry->size = size;
+	entry->last_used = 0;
+
+	return true;
+}
+
+void SpriteCache::EvictLeastRecentlyUsed()
+{
+	auto oldest_it = std::min_element(entries_.begin(), entries_.end(), [](const auto& a, const auto& b)
+	{
+		return a.second.last_used < b.second.last_used;
+	});
+
+	SDL_DestroyTexture(oldest_it->second.texture);
+	bytes_ -= static_cast<std::size_t>(oldest_it->second.size) * static_cast<std::size_t>(oldest_it->second.size) * 4;
+	entries_.erase(oldest_it);
+	++evictions_;
+}
@@ -0,0 +1,327 @@
+#include "StateHash.hpp"
+#include "Game.hpp"
+#include "Trace.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cinttypes>
+#include <cstring>
+
+namespace
+{
+	constexpr char header_line[] = "# asteroids state hash v1";
+
+	std::uint64_t Mix(std::uint64_t hash, std::uint64_t value)
+	{
+		// splitmix64 finalizer over the running hash, so each value changes every output bit.
+		hash += value + 0x9E3779B97F4A7C15ull;
+		hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+		hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+		return hash ^ (hash >> 31);
+	}
+
+	std::uint64_t Bits(float value)
+	{
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	std::uint64_t Bits(double value)
+	{
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	std::uint64_t HashPoint(std::uint64_t hash, const SDL_FPoint& point)
+	{
+		return Mix(hash, (Bits(point.x) << 32) | Bits(point.y));
+	}
+
+	std::uint64_t HashVertices(std::uint64_t hash, const LinePolygon& polygon)
+	{
+		for (const SDL_FPoint& point : polygon.Geometry())
+		{
+			hash = HashPoint(hash, point);
+		}
+
+		return hash;
+	}
+
+	bool ReadDigest(std::FILE* file, std::uint64_t* tick, StateHash::Digest* digest)
+	{
+		if (std::fscanf(file, "%" SCNu64, tick) != 1)
+		{
+			return false;
+		}
+
+		for (std::uint64_t& hash : *digest)
+		{
+			if (std::fscanf(file, "%" SCNx64, &hash) != 1)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::FILE* OpenHashFile(const char* path)
+	{
+		std::FILE* file = std::fopen(path, "r");
+		char line[sizeof(header_line)];
+
+		if (file == nullptr)
+		{
+			printf("Unable to open state hash file %s!\n", path);
+			return nullptr;
+		}
+
+		if (std::fgets(line, sizeof(line), file) == nullptr || std::strncmp(line, header_line, sizeof(header_line) - 1) != 0)
+		{
+			printf("%s is not a state hash file\n", path);
+			std::fclose(file);
+			return nullptr;
+		}
+
+		// Skip the field list after the version.
+		int c = 0;
+
+		while ((c = std::fgetc(file)) != EOF && c != '\n')
+		{
+		}
+
+		return file;
+	}
+} // namespace
+
+StateHash::StateHash() : file_(nullptr), hash_counter_(0), ticks_hashed_(0)
+{
+}
+
+StateHash::~StateHash()
+{
+	Close();
+}
+
+const char* StateHash::FieldName(int field)
+{
+	static const char* const names[FIELD_COUNT] = { "player", "asteroid centers", "asteroid vertices", "asteroid velocities", "bullet positions", "bullet velocities", "bullet lifetimes", "counters", "random engine" };
+
+	return field >= 0 && field < FIELD_COUNT ? names[field] : "unknown";
+}
+
+StateHash::Digest StateHash::Compute(const Game& game)
+{
+	Digest digest = {};
+
+	const Player& player = game.GetPlayer();
+	std::uint64_t player_hash = HashVertices(HashPoint(HashPoint(0, player.center_), player.velocity_vector_), player);
+	player_hash = Mix(player_hash, (static_cast<std::uint64_t>(player.removed_) << 32) | static_cast<std::uint32_t>(player.rotating_degrees_));
+	digest[PLAYER] = player_hash;
+
+	for (const std::unique_ptr<Player>& remote_player : game.RemotePlayers())
+	{
+		std::uint64_t remote_hash = HashVertices(HashPoint(HashPoint(1, remote_player->center_), remote_player->velocity_vector_), *remote_player);
+		remote_hash = Mix(remote_hash, (static_cast<std::uint64_t>(remote_player->lives_) << 32) | remote_player->buttons_);
+		digest[PLAYER] += remote_hash;
+	}
+
+	for (const std::unique_ptr<Asteroid>& asteroid : game.Asteroids())
+	{
+		const std::uint64_t seed = Mix((static_cast<std::uint64_t>(asteroid->id_) << 8) | static_cast<std::uint64_t>(asteroid->type_), asteroid->removed_);
+
+		digest[ASTEROID_CENTERS] += HashPoint(seed, asteroid->center_);
+		digest[ASTEROID_VERTICES] += HashVertices(seed, *asteroid);
+		digest[ASTEROID_VELOCITIES] += HashPoint(seed, asteroid->velocity_vector_);
+	}
+
+	for (const std::unique_ptr<Bullet>& bullet : game.Bullets())
+	{
+		const std::uint64_t seed = Mix(0, bullet->removed_);
+
+		digest[BULLET_POSITIONS] += HashPoint(seed, { bullet->geometry_.x, bullet->geometry_.y });
+		digest[BULLET_VELOCITIES] += HashPoint(seed, bullet->velocity_vector_);
+		digest[BULLET_LIFETIMES] += Mix(seed, static_cast<std::uint32_t>(bullet->lifetime_));
+	}
+
+	std::uint64_t counters = Mix(0, static_cast<std::uint32_t>(game.score_));
+	counters = Mix(counters, static_cast<std::uint32_t>(player.lives_));
+	counters = Mix(counters, static_cast<std::uint32_t>(game.number_of_asteroids_));
+	counters = Mix(counters, (static_cast<std::uint64_t>(game.game_over_) << 1) | game.reset_game_);
+	counters = Mix(counters, (game.Asteroids().size() << 32) | game.Bullets().size());
+	counters = Mix(counters, Bits(game.world_width_) ^ (Bits(game.world_height_) << 1));
+	digest[COUNTERS] = counters;
+
+	// The engine is trivially copyable (see Snapshot.hpp), so its state words are hashed directly.
+	static_assert(sizeof(std::mt19937_64) % sizeof(std::uint64_t) == 0, "the random engine is hashed as 64-bit words");
+	std::uint64_t engine_words[sizeof(std::mt19937_64) / sizeof(std::uint64_t)];
+	std::memcpy(engine_words, &game.mt_, sizeof(engine_words));
+
+	std::uint64_t engine_hash = 0;
+
+	for (const std::uint64_t word : engine_words)
+	{
+		engine_hash = Mix(engine_hash, word);
+	}
+
+	digest[RANDOM_ENGINE] = engine_hash;
+
+	return digest;
+}
+
+bool StateHash::Open(const char* path)
+{
+	Close();
+
+	file_ = std::fopen(path, "w");
+
+	if (file_ == nullptr)
+	{
+		printf("Unable to open state hash file %s!\n", path);
+		return false;
+	}
+
+	std::fprintf(file_, "%s, fields:", header_line);
+
+	for (int field = 0; field < FIELD_COUNT; ++field)
+	{
+		std::fprintf(file_, "%s%s", field == 0 ? " " : ", ", FieldName(field));
+	}
+
+	std::fprintf(file_, "\n");
+
+	ticks_hashed_ = 0;
+	hash_counter_ = 0;
+
+	return true;
+}
+
+void StateHash::Record(std::uint64_t tick, const Game& game)
+{
+	if (file_ == nullptr)
+	{
+		return;
+	}
+
+	trace::Zone zone("StateHash::Record");
+	const std::uint64_t start = SDL_GetPerformanceCounter();
+	const Digest digest = Compute(game);
+
+	hash_counter_ += SDL_GetPerformanceCounter() - start;
+	++ticks_hashed_;
+
+	std::fprintf(file_, "%" PRIu64, tick);
+
+	for (const std::uint64_t hash : digest)
+	{
+		std::fprintf(file_, " %016" PRIx64, hash);
+	}
+
+	std::fputc('\n', file_);
+}
+
+void StateHash::Close()
+{
+	if (file_ == nullptr)
+	{
+		return;
+	}
+
+	std::fclose(file_);
+	file_ = nullptr;
+}
+
+double StateHash::MicrosecondsPerTick() const
+{
+	if (ticks_hashed_ == 0)
+	{
+		return 0.0;
+	}
+
+	return static_cast<double>(hash_counter_) * 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency()) / static_cast<double>(ticks_hashed_);
+}
+
+int StateHash::Compare(const char* first_path, const char* second_path)
+{
+	std::FILE* first = OpenHashFile(first_path);
+	std::FILE* second = OpenHashFile(second_path);
+
+	if (first == nullptr || second == nullptr)
+	{
+		if (first != nullptr)
+		{
+			std::fclose(first);
+		}
+
+		if (second != nullptr)
+		{
+			std::fclose(second);
+		}
+
+		return 2;
+	}
+
+	std::uint64_t compared = 0;
+	int result = 0;
+
+	while (true)
+	{
+		std::uint64_t first_tick = 0;
+		std::uint64_t second_tick = 0;
+		Digest first_digest;
+		Digest second_digest;
+
+		const bool first_read = ReadDigest(first, &first_tick, &first_digest);
+		const bool second_read = ReadDigest(second, &second_tick, &second_digest);
+
+		if (!first_read || !second_read)
+		{
+			if (first_read != second_read)
+			{
+				printf("Runs agree for %" PRIu64 " ticks, then %s ends\n", compared, first_read ? second_path : first_path);
+				result = 1;
+			}
+			else
+			{
+				printf("Runs agree for all %" PRIu64 " ticks\n", compared);
+			}
+
+			break;
+		}
+
+		if (first_tick != second_tick)
+		{
+			printf("Tick numbers differ after %" PRIu64 " ticks: %" PRIu64 " and %" PRIu64 "\n", compared, first_tick, second_tick);
+			result = 1;
+			break;
+		}
+
+		if (first_digest != second_digest)
+		{
+			printf("First divergence at tick %" PRIu64 " in", first_tick);
+			const char* separator = " ";
+
+			for (int field = 0; field < FIELD_COUNT; ++field)
+			{
+				if (first_digest[field] != second_digest[field])
+				{
+					printf("%s%s", separator, FieldName(field));
+					separator = ", ";
+				}
+			}
+
+			printf("\n");
+			result = 1;
+			break;
+		}
+
+		++compared;
+	}
+
+	std::fclose(first);
+	std::fclose(second);
+
+	return result;
+}
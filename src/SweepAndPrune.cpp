@@ -0,0 +1,215 @@
+#include "SweepAndPrune.hpp"
+#include "Asteroid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SweepAndPrune::SweepAndPrune(double world_width, double world_height) : world_width_(world_width), world_height_(world_height), max_extent_(0.0f), swaps_(0), candidates_(0)
+{
+}
+
+void SweepAndPrune::SetWorldSize(double world_width, double world_height)
+{
+	world_width_ = world_width;
+	world_height_ = world_height;
+}
+
+void SweepAndPrune::Clear()
+{
+	for (const Proxy& proxy : proxies_)
+	{
+		proxy.asteroid->broadphase_tracked_ = false;
+	}
+
+	proxies_.clear();
+	pairs_.clear();
+	max_extent_ = 0.0f;
+}
+
+void SweepAndPrune::Update(const std::list<std::unique_ptr<Asteroid>>& asteroids)
+{
+	// Removed asteroids are still alive until the next pass over the asteroid list, so their proxies can be dropped safely here.
+	std::size_t live = 0;
+	max_extent_ = 0.0f;
+
+	for (std::size_t i = 0; i < proxies_.size(); ++i)
+	{
+		Proxy proxy = proxies_[i];
+
+		if (proxy.asteroid->removed_)
+		{
+			proxy.asteroid->broadphase_tracked_ = false;
+			continue;
+		}
+
+		proxy.min_x = proxy.asteroid->center_.x - proxy.radius;
+		proxy.max_x = proxy.asteroid->center_.x + proxy.radius;
+		max_extent_ = std::max(max_extent_, proxy.max_x - proxy.min_x);
+		proxies_[live++] = proxy;
+	}
+
+	proxies_.resize(live);
+
+	for (const std::unique_ptr<Asteroid>& asteroid : asteroids)
+	{
+		if (asteroid->removed_ || asteroid->broadphase_tracked_)
+		{
+			continue;
+		}
+
+		const float radius = static_cast<float>(std::sqrt(asteroid->furthest_distance_squared_));
+
+		proxies_.push_back({ asteroid.get(), asteroid->center_.x - radius, asteroid->center_.x + radius, radius });
+		max_extent_ = std::max(max_extent_, 2.0f * radius);
+		asteroid->broadphase_tracked_ = true;
+	}
+
+	// The order from the previous tick is almost sorted already, so insertion sort stays close to linear.
+	swaps_ = 0;
+
+	for (std::size_t i = 1; i < proxies_.size(); ++i)
+	{
+		const Proxy proxy = proxies_[i];
+		std::size_t j = i;
+
+		while (j > 0 && proxies_[j - 1].min_x > proxy.min_x)
+		{
+			proxies_[j] = proxies_[j - 1];
+			--j;
+			++swaps_;
+		}
+
+		proxies_[j] = proxy;
+	}
+
+	pairs_.clear();
+	candidates_ = 0;
+
+	const std::size_t count = proxies_.size();
+	const float width = static_cast<float>(world_width_);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		for (std::size_t j = i + 1; j < count && proxies_[j].min_x <= proxies_[i].max_x; ++j)
+		{
+			AddCandidate(proxies_[i], proxies_[j]);
+		}
+	}
+
+	// Intervals sticking out past the right edge overlap the start of the list shifted by one world width.
+	for (std::size_t i = count; i-- > 0 && proxies_[i].min_x >= width - max_extent_;)
+	{
+		if (proxies_[i].max_x <= width)
+		{
+			continue;
+		}
+
+		const float shifted_min = proxies_[i].min_x - width;
+		const float shifted_max = proxies_[i].max_x - width;
+
+		for (std::size_t j = 0; j < count && proxies_[j].min_x <= shifted_max; ++j)
+		{
+			const bool direct_overlap = proxies_[j].min_x <= proxies_[i].max_x && proxies_[i].min_x <= proxies_[j].max_x;
+
+			if (j != i && proxies_[j].max_x >= shifted_min && !direct_overlap)
+			{
+				AddCandidate(proxies_[i], proxies_[j]);
+			}
+		}
+	}
+
+	// Intervals sticking out past the left edge; pairs whose other end crosses the right edge were found above.
+	for (std::size_t i = 0; i < count && proxies_[i].min_x < 0.0f; ++i)
+	{
+		const float shifted_min = proxies_[i].min_x + width;
+		const float shifted_max = proxies_[i].max_x + width;
+
+		for (std::size_t j = count; j-- > 0 && proxies_[j].min_x >= shifted_min - max_extent_;)
+		{
+			const bool direct_overlap = proxies_[j].min_x <= proxies_[i].max_x && proxies_[i].min_x <= proxies_[j].max_x;
+
+			if (j != i && proxies_[j].max_x <= width && proxies_[j].max_x >= shifted_min && proxies_[j].min_x <= shifted_max && !direct_overlap)
+			{
+				AddCandidate(proxies_[i], proxies_[j]);
+			}
+		}
+	}
+}
+
+void SweepAndPrune::AddCandidate(const Proxy& a, const Proxy& b)
+{
+	++candidates_;
+
+	double dx = b.asteroid->center_.x - a.asteroid->center_.x;
+	double dy = b.asteroid->center_.y - a.asteroid->center_.y;
+
+	dx -= world_width_ * std::round(dx / world_width_);
+	dy -= world_height_ * std::round(dy / world_height_);
+
+	const double radii = a.radius + b.radius;
+
+	if ((dx * dx) + (dy * dy) < radii * radii)
+	{
+		pairs_.emplace_back(a.asteroid, b.asteroid);
+	}
+}
+
+void SweepAndPrune::ResolveCollisions()
+{
+	for (const std::pair<Asteroid*, Asteroid*>& pair : pairs_)
+	{
+		Asteroid* a = pair.first;
+		Asteroid* b = pair.second;
+
+		double dx = b->center_.x - a->center_.x;
+		double dy = b->center_.y - a->center_.y;
+
+		dx -= world_width_ * std::round(dx / world_width_);
+		dy -= world_height_ * std::round(dy / world_height_);
+
+		const double distance = std::sqrt((dx * dx) + (dy * dy));
+
+		// Freshly split fragments share a center; their own velocities pull them apart.
+		if (distance < 1e-3)
+		{
+			continue;
+		}
+
+		const double nx = dx / distance;
+		const double ny = dy / distance;
+
+		const double mass_a = a->furthest_distance_squared_;
+		const double mass_b = b->furthest_distance_squared_;
+
+		const double approach = ((b->velocity_vector_.x - a->velocity_vector_.x) * nx) + ((b->velocity_vector_.y - a->velocity_vector_.y) * ny);
+
+		if (approach < 0.0)
+		{
+			const double impulse = -2.0 * approach / ((1.0 / mass_a) + (1.0 / mass_b));
+
+			a->velocity_vector_.x -= impulse / mass_a * nx;
+			a->velocity_vector_.y -= impulse / mass_a * ny;
+			b->velocity_vector_.x += impulse / mass_b * nx;
+			b->velocity_vector_.y += impulse / mass_b * ny;
+		}
+
+		// Push overlapping bodies apart a little each tick instead of all at once, so dense clusters do not jitter.
+		const double penetration = std::sqrt(mass_a) + std::sqrt(mass_b) - distance;
+		const double correction = std::min(penetration, 2.0);
+		const double share_a = mass_b / (mass_a + mass_b);
+		const double share_b = mass_a / (mass_a + mass_b);
+
+		a->TranslateGeometry(-nx * correction * share_a, -ny * correction * share_a);
+		b->TranslateGeometry(nx * correction * share_b, ny * correction * share_b);
+	}
+}
+
+const std::vector<std::pair<Asteroid*, Asteroid*>>& SweepAndPrune::Pairs() const
+{
+	return pairs_;
+}
+
+std::size_t SweepAndPrune::Size() const
+{
+	return proxies_.size();
+}
@@ -1,4 +1,5 @@
 #include "Texture.hpp"
+#include "Trace.hpp"
 
 Texture::Texture() : texture_(nullptr), width_(0), height_(0)
 {
@@ -19,6 +20,8 @@ void Texture::FreeTexture()
 
 bool Texture::LoadFromText(SDL_Renderer* renderer, TTF_Font* font, const char* text, const SDL_Color& text_color, int text_length)
 {
+	trace::Zone zone("Texture::LoadFromText");
+
 	FreeTexture();
 
 	SDL_Surface* text_surface = text_length == -1 ? TTF_RenderText_Blended(font, text, text_color) : TTF_RenderText_Blended_Wrapped(font, text, text_color, text_length);
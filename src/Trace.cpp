@@ -0,0 +1,172 @@
+#include "Trace.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trace
+{
+	std::atomic<bool> enabled{ false };
+
+	namespace
+	{
+		struct Event
+		{
+			const char* name;
+			std::uint64_t start;
+			std::uint64_t end;
+		};
+
+		struct ThreadBuffer
+		{
+			std::unique_ptr<Event[]> events;
+			std::atomic<std::uint64_t> written;
+			std::atomic<const char*> name;
+			int id;
+		};
+
+		// Buffers are never freed, so a thread that exits mid-session still has its events written out.
+		std::mutex registry_mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> registry;
+		std::string output_path;
+		std::uint64_t origin = 0;
+
+		thread_local ThreadBuffer* thread_buffer = nullptr;
+
+		// Waiting for the thread that Reserve was called for.
+		std::atomic<ThreadBuffer*> reserved{ nullptr };
+
+		ThreadBuffer* NewBuffer()
+		{
+			std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+			buffer->events = std::make_unique<Event[]>(events_per_thread);
+			buffer->written.store(0, std::memory_order_relaxed);
+			buffer->name.store(nullptr, std::memory_order_relaxed);
+
+			std::lock_guard<std::mutex> lock(registry_mutex);
+			buffer->id = static_cast<int>(registry.size()) + 1;
+			registry.push_back(std::move(buffer));
+
+			return registry.back().get();
+		}
+
+		ThreadBuffer* CurrentBuffer()
+		{
+			if (thread_buffer == nullptr)
+			{
+				thread_buffer = NewBuffer();
+			}
+
+			return thread_buffer;
+		}
+	} // namespace
+
+	bool Start(const char* path)
+	{
+		// Opened now so a bad path fails before the session rather than after it.
+		std::FILE* file = std::fopen(path, "w");
+
+		if (file == nullptr)
+		{
+			printf("Unable to open trace file %s\n", path);
+			return false;
+		}
+
+		std::fclose(file);
+
+		output_path = path;
+		origin = SDL_GetPerformanceCounter();
+		NameThread("main");
+		enabled.store(true, std::memory_order_release);
+
+		return true;
+	}
+
+	void Stop()
+	{
+		if (!enabled.exchange(false))
+		{
+			return;
+		}
+
+		std::FILE* file = std::fopen(output_path.c_str(), "w");
+
+		if (file == nullptr)
+		{
+			printf("Unable to write trace file %s\n", output_path.c_str());
+			return;
+		}
+
+		const double microseconds = 1e6 / static_cast<double>(SDL_GetPerformanceFrequency());
+		std::size_t events = 0;
+		std::size_t overwritten = 0;
+		bool first = true;
+
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+		for (const std::unique_ptr<ThreadBuffer>& buffer : registry)
+		{
+			const char* name = buffer->name.load(std::memory_order_acquire);
+
+			std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", buffer->id, name != nullptr ? name : "thread");
+			first = false;
+
+			const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+			const std::uint64_t oldest = written > events_per_thread ? written - events_per_thread : 0;
+
+			for (std::uint64_t i = oldest; i < written; ++i)
+			{
+				const Event& event = buffer->events[i % events_per_thread];
+
+				std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.name, buffer->id, static_cast<double>(event.start - origin) * microseconds, static_cast<double>(event.end - event.start) * microseconds);
+			}
+
+			events += static_cast<std::size_t>(written - oldest);
+			overwritten += static_cast<std::size_t>(oldest);
+		}
+
+		std::fprintf(file, "\n]}\n");
+		std::fclose(file);
+
+		printf("Trace: %zu events from %zu threads written to %s, %zu older events overwritten\n", events, registry.size(), output_path.c_str(), overwritten);
+	}
+
+	void Record(const char* name, std::uint64_t start, std::uint64_t end)
+	{
+		ThreadBuffer* buffer = CurrentBuffer();
+		const std::uint64_t index = buffer->written.load(std::memory_order_relaxed);
+
+		buffer->events[index % events_per_thread] = { name, start, end };
+		buffer->written.store(index + 1, std::memory_order_release);
+	}
+
+	void NameThread(const char* name)
+	{
+		CurrentBuffer()->name.store(name, std::memory_order_release);
+	}
+
+	void Reserve(const char* name)
+	{
+		if (!enabled.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		ThreadBuffer* buffer = NewBuffer();
+		buffer->name.store(name, std::memory_order_release);
+		reserved.store(buffer, std::memory_order_release);
+	}
+
+	bool AdoptReserved()
+	{
+		if (thread_buffer == nullptr)
+		{
+			thread_buffer = reserved.exchange(nullptr, std::memory_order_acq_rel);
+		}
+
+		return thread_buffer != nullptr;
+	}
+} // namespace trace
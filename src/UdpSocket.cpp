@@ -0,0 +1,100 @@
+#include "UdpSocket.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+UdpSocket::UdpSocket() : descriptor_(-1)
+{
+}
+
+UdpSocket::~UdpSocket()
+{
+	Close();
+}
+
+bool UdpSocket::Open(std::uint16_t port)
+{
+	Close();
+
+	descriptor_ = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (descriptor_ < 0)
+	{
+		printf("Unable to create UDP socket: %s\n", std::strerror(errno));
+		return false;
+	}
+
+	// A server with many clients receives bursts of input; a larger buffer keeps them from being dropped between ticks.
+	const int buffer_size = 1024 * 1024;
+	setsockopt(descriptor_, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+
+	if (bind(descriptor_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		printf("Unable to bind UDP port %u: %s\n", port, std::strerror(errno));
+		Close();
+		return false;
+	}
+
+	fcntl(descriptor_, F_SETFL, fcntl(descriptor_, F_GETFL, 0) | O_NONBLOCK);
+
+	return true;
+}
+
+void UdpSocket::Close()
+{
+	if (descriptor_ < 0)
+	{
+		return;
+	}
+
+	close(descriptor_);
+	descriptor_ = -1;
+}
+
+bool UdpSocket::Send(const sockaddr_in& address, const void* data, std::size_t size)
+{
+	return sendto(descriptor_, data, size, 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == static_cast<ssize_t>(size);
+}
+
+int UdpSocket::Receive(void* buffer, std::size_t capacity, sockaddr_in* from)
+{
+	socklen_t from_length = sizeof(*from);
+	const ssize_t received = recvfrom(descriptor_, buffer, capacity, 0, reinterpret_cast<sockaddr*>(from), &from_length);
+
+	return received < 0 ? -1 : static_cast<int>(received);
+}
+
+bool UdpSocket::Resolve(const char* host, std::uint16_t port, sockaddr_in* address)
+{
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	addrinfo* result = nullptr;
+
+	if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr)
+	{
+		printf("Unable to resolve %s\n", host);
+		return false;
+	}
+
+	std::memcpy(address, result->ai_addr, sizeof(*address));
+	address->sin_port = htons(port);
+	freeaddrinfo(result);
+
+	return true;
+}
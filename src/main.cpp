@@ -1,14 +1,119 @@
 #include "Game.hpp"
+#include "Options.hpp"
+#include "Benchmark.hpp"
+#include "AssetBundle.hpp"
+#include "StateHash.hpp"
+#include "NetServer.hpp"
+#include "NetClient.hpp"
+#include "RollbackSession.hpp"
+#include "SpectatorChannel.hpp"
+#include "Trace.hpp"
+#include "Soak.hpp"
+#include "Scenario.hpp"
 
+#include <cstdio>
 #include <memory>
 
+namespace
+{
+	int Run(const Options& options)
+	{
+		if (!options.build_bundle_path.empty())
+		{
+			return AssetBundle::Build(options.build_bundle_path.c_str()) ? 0 : 1;
+		}
+
+		if (!options.hash_compare_first.empty())
+		{
+			return StateHash::Compare(options.hash_compare_first.c_str(), options.hash_compare_second.c_str());
+		}
+
+		if (!options.benchmark.empty())
+		{
+			return benchmark::Run(options);
+		}
+
+		if (options.scenario == "list")
+		{
+			scenario::PrintProfiles();
+			return 0;
+		}
+
+		if (options.soak_hours > 0.0)
+		{
+			return soak::Run(options);
+		}
+
+		if (options.spectate)
+		{
+			return spectator::RunViewer(options);
+		}
+
+		// Peers and the server exchange tick numbers, so every networked game steps at the same fixed rate.
+		if (options.tick_rate != constants::ticks_per_second && (options.server || options.client || options.load_test_clients > 0 || options.rollback_player >= 0))
+		{
+			printf("--tick-rate is only supported in local games; networked games run at %d ticks per second\n", constants::ticks_per_second);
+			return 1;
+		}
+
+		if (options.server)
+		{
+			return net::RunServer(options);
+		}
+
+		if (options.load_test_clients > 0)
+		{
+			return net::RunLoadTest(options);
+		}
+
+		if (options.rollback_player >= 0)
+		{
+			return net::RunRollback(options);
+		}
+
+		if (options.client)
+		{
+			return net::RunClient(options);
+		}
+
+		std::unique_ptr<Game> game = std::make_unique<Game>();
+		game->ApplyOptions(options);
+
+		if (!options.scenario.empty() && !game->LoadScenario(options.scenario))
+		{
+			return 1;
+		}
+
+		if (options.headless)
+		{
+			game->RunHeadless();
+		}
+		else
+		{
+			game->Run();
+		}
+
+		return 0;
+	}
+} // namespace
+
 int main(int argc, char* argv[])
 {
-	(void) argc;
-	(void) argv;
+	Options options;
+
+	if (!ParseOptions(argc, argv, &options))
+	{
+		return 1;
+	}
+
+	if (!options.trace_path.empty() && !trace::Start(options.trace_path.c_str()))
+	{
+		return 1;
+	}
+
+	const int result = Run(options);
 
-	std::unique_ptr<Game> game = std::make_unique<Game>();
-	game->Run();
+	trace::Stop();
 
-	return 0;
+	return result;
 }